@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <corecpp/serialization/json.h>
+#include <corecpp/cli/command_line.h>
+
+struct event
+{
+	std::int64_t id;
+	std::string source;
+	double value;
+	bool acknowledged;
+	std::vector<std::string> tags;
+
+	static const auto& properties()
+	{
+		static auto result = std::make_tuple(
+			corecpp::make_property("id", &event::id),
+			corecpp::make_property("source", &event::source),
+			corecpp::make_property("value", &event::value),
+			corecpp::make_property("acknowledged", &event::acknowledged),
+			corecpp::make_property("tags", &event::tags)
+		);
+		return result;
+	}
+};
+
+/* json lines of events */
+std::string payload(unsigned int number)
+{
+	std::string lines;
+	corecpp::json::basic_lines_writer<corecpp::string_sink> writer { corecpp::string_sink { lines } };
+	for (unsigned int i = 0; i < number; ++i)
+	{
+		event e { i, "sensor-" + std::to_string(i % 97), i * 0.25, i % 2 == 0, { "alpha", "beta" } };
+		writer.write(e);
+	}
+	return lines;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int number = 1000000;
+	unsigned int threads = 0;
+	bool unordered = false;
+	corecpp::command_line args { argc, argv };
+	corecpp::command_line_parser commands { args };
+	commands.add_options(
+		corecpp::program_option { 'n', "number", "number of records", number },
+		corecpp::program_option { 'j', "threads", "number of worker threads, 0 to read the records serially", threads },
+		corecpp::program_option { 'u', "unordered", "deliver the records as soon as they are parsed", unordered }
+	);
+	auto res = commands.parse_options();
+	if (!res)
+	{
+		std::cerr << "Invalid argument: " << res.error().what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	corecpp::diagnostic::manager::default_channel().set_level(corecpp::diagnostic::diagnostic_level::success);
+
+	std::cout << "generating " << number << " records" << std::endl;
+	std::string lines = payload(number);
+
+	std::size_t records = 0;
+	auto start = std::chrono::system_clock::now();
+	if (threads)
+	{
+		corecpp::json::parallel_lines_options options;
+		options.threads = threads;
+		options.ordered = !unordered;
+		corecpp::json::read_lines_parallel<event>(lines,
+			[&records](std::vector<event>& batch) { records += batch.size(); }, options);
+	}
+	else
+	{
+		std::istringstream iss { lines };
+		corecpp::json::lines_reader<event> reader { iss };
+		for (auto iter = reader.begin(); iter != reader.end(); ++iter)
+			++records;
+	}
+	std::chrono::duration<double> diff = std::chrono::system_clock::now() - start;
+	std::cout << "done, reading " << records << " records (" << lines.size() << " bytes) took "
+	          << std::setw(6) << diff.count() << " seconds, "
+	          << (lines.size() / diff.count() / (1024 * 1024)) << " MB/s" << std::endl;
+	return 0;
+}
@@ -0,0 +1,107 @@
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <corecpp/serialization/json.h>
+#include <corecpp/cli/command_line.h>
+
+/* json array of random integers, spread over the whole int64_t range */
+std::string integer_payload(unsigned int number)
+{
+	std::mt19937_64 generator { 42 };
+	std::string json = "[";
+	for (unsigned int i = 0; i < number; ++i)
+	{
+		if (i)
+			json += ',';
+		/* a random number of significant digits, to mix small and large values */
+		auto value = static_cast<std::int64_t>(generator()) >> (generator() % 64);
+		json += std::to_string(value);
+	}
+	json += ']';
+	return json;
+}
+
+/* json array of random doubles, printed with enough digits to round-trip */
+std::string float_payload(unsigned int number)
+{
+	std::mt19937_64 generator { 42 };
+	std::uniform_real_distribution<double> mantissa { -1.0, 1.0 };
+	std::uniform_int_distribution<int> exponent { -30, 30 };
+	std::string json = "[";
+	char buffer[32];
+	for (unsigned int i = 0; i < number; ++i)
+	{
+		if (i)
+			json += ',';
+		std::snprintf(buffer, sizeof(buffer), "%.17g", mantissa(generator) * std::pow(10.0, exponent(generator)));
+		json += buffer;
+	}
+	json += ']';
+	return json;
+}
+
+template <typename ValueT>
+std::chrono::duration<double> bench(const std::string& json, bool stream, std::vector<ValueT>& values)
+{
+	auto start = std::chrono::system_clock::now();
+	if (stream)
+	{
+		std::istringstream iss { json };
+		corecpp::json::deserializer d(iss);
+		d.deserialize(values);
+	}
+	else
+	{
+		corecpp::json::buffer_deserializer d(json);
+		d.deserialize(values);
+	}
+	return std::chrono::system_clock::now() - start;
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int number = 1000000;
+	bool floats = false;
+	bool stream = false;
+	corecpp::command_line args { argc, argv };
+	corecpp::command_line_parser commands { args };
+	commands.add_options(
+		corecpp::program_option { 'n', "number", "number of values to parse", number },
+		corecpp::program_option { 'f', "float", "parse a float-heavy payload instead of an integer-heavy one", floats },
+		corecpp::program_option { 's', "stream", "deserialize from a stream instead of a contiguous buffer", stream }
+	);
+	auto res = commands.parse_options();
+	if (!res)
+	{
+		std::cerr << "Invalid argument: " << res.error().what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	corecpp::diagnostic::manager::default_channel().set_level(corecpp::diagnostic::diagnostic_level::success);
+
+	std::cout << "generating " << number << (floats ? " doubles" : " integers") << std::endl;
+	std::string json = floats ? float_payload(number) : integer_payload(number);
+
+	std::chrono::duration<double> diff;
+	if (floats)
+	{
+		std::vector<double> values;
+		diff = bench(json, stream, values);
+	}
+	else
+	{
+		std::vector<std::int64_t> values;
+		diff = bench(json, stream, values);
+	}
+	std::cout << "done, parsing " << number << " values (" << json.size() << " bytes) took "
+	          << std::setw(6) << diff.count() << " seconds, "
+	          << (json.size() / diff.count() / (1024 * 1024)) << " MB/s" << std::endl;
+	return 0;
+}
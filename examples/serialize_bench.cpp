@@ -16,6 +16,8 @@
 
 #include <corecpp/algorithm.h>
 #include <corecpp/net/mailaddress.h>
+#include <corecpp/serialization/cbor.h>
+#include <corecpp/serialization/compact.h>
 #include <corecpp/serialization/json.h>
 #include <corecpp/serialization/xml.h>
 #include <corecpp/flags.h>
@@ -95,19 +97,53 @@ struct complex_type
 	}
 };
 
+/* serialize the users to a binary format, and read them back if deserialize is set */
+template <template <typename> class SerializerT, typename DeserializerT>
+void bench_binary(const char* format, std::vector<user>& users, bool deserialize)
+{
+	std::string bytes;
+	SerializerT<corecpp::string_sink> s { corecpp::string_sink { bytes } };
+	auto start = std::chrono::system_clock::now();
+	s.serialize(users);
+	auto end = std::chrono::system_clock::now();
+	std::chrono::duration<double> diff = end - start;
+	std::cout << "done, " << format << " serialisation of " << users.size() << " users took "
+	          << std::setw(6) << diff.count() << " seconds, " << bytes.size() << " bytes" << std::endl;
+	if (!deserialize)
+		return;
+
+	std::size_t number = users.size();
+	users.clear();
+	start = std::chrono::system_clock::now();
+	DeserializerT d { bytes };
+	d.deserialize(users);
+	end = std::chrono::system_clock::now();
+	diff = end - start;
+	std::cout << "done, " << format << " deserialisation of " << number << " users took "
+	          << std::setw(6) << diff.count() << " seconds" << std::endl;
+}
+
 int main(int argc, char** argv)
 {
 	unsigned int verbosity = 0;
 	unsigned int number = 1000;
 	bool pretty = false;
 	bool deserialize = false;
+	bool buffer = false;
+	bool cbor = false;
+	bool compact = false;
+	unsigned int threads = 1;
 	corecpp::command_line args { argc, argv };
 	corecpp::command_line_parser commands { args };
 	commands.add_options(
 		corecpp::program_option { 'v', "verbose", "enable verbose", verbosity },
 		corecpp::program_option { 'n', "number", "number of user to serialize", number },
 		corecpp::program_option { 'p', "pretty", "enbale pretty print", pretty },
-		corecpp::program_option { 'd', "deserialize", "also bench deserialisation", deserialize }
+		corecpp::program_option { 'd', "deserialize", "also bench deserialisation", deserialize },
+		corecpp::program_option { 'b', "buffer", "deserialize from a contiguous buffer", buffer },
+		corecpp::program_option { 'c', "cbor", "use the CBOR format instead of json", cbor },
+		corecpp::program_option { 'k', "compact", "use the compact binary format instead of json", compact },
+		corecpp::program_option { 'j', "threads", "number of threads serializing the users", threads }
 	);
 	auto res = commands.parse_options();
 	if (!res)
@@ -138,9 +174,14 @@ int main(int argc, char** argv)
 
 	std::cout << "now serializing" << std::endl;
 	//corecpp::xml::serializer s(std::cout, false, true);
-	if ( !deserialize )
+	if (cbor)
+		bench_binary<corecpp::cbor::basic_serializer, corecpp::cbor::deserializer>("CBOR", users, deserialize);
+	else if (compact)
+		bench_binary<corecpp::compact::basic_serializer, corecpp::compact::deserializer>("compact", users, deserialize);
+	else if ( !deserialize )
 	{
 		corecpp::json::serializer s(std::cout, pretty);
+		s.set_parallelism(threads);
 		auto start = std::chrono::system_clock::now();
 				s.serialize(users);
 		auto end = std::chrono::system_clock::now();
@@ -156,13 +197,26 @@ int main(int argc, char** argv)
 
 		std::cout << "serialisation done, now deserializing" << std::endl;
 		users.clear();
-		std::istringstream iss;
-		iss.str(oss.str());
-		corecpp::json::deserializer d(iss);
-		auto start = std::chrono::system_clock::now();
-		d.deserialize(users);
-		auto end = std::chrono::system_clock::now();
-		std::chrono::duration<double> diff = end - start;
+		std::chrono::duration<double> diff;
+		if (buffer)
+		{
+			std::string json = oss.str();
+			auto start = std::chrono::system_clock::now();
+			corecpp::json::buffer_deserializer d(json);
+			d.deserialize(users);
+			auto end = std::chrono::system_clock::now();
+			diff = end - start;
+		}
+		else
+		{
+			std::istringstream iss;
+			iss.str(oss.str());
+			corecpp::json::deserializer d(iss);
+			auto start = std::chrono::system_clock::now();
+			d.deserialize(users);
+			auto end = std::chrono::system_clock::now();
+			diff = end - start;
+		}
 		std::cout << "done, deserialisation of " << number << " users took "
 		          << std::setw(6) << diff.count() << " seconds" << std::endl;
 	}
@@ -1,6 +1,7 @@
 #ifndef CORE_CPP_EXCEPT_H
 #define CORE_CPP_EXCEPT_H
 
+#include <cstdlib>
 #include <stdexcept>
 #if __cplusplus > 201703L
 #include <source_location>
@@ -141,10 +142,19 @@ namespace corecpp
 		{ };
 	};
 
+	/**
+	 * \brief throw an ExceptionT built from args
+	 * \remark without exception support (-fno-exceptions), it aborts instead, like the standard library does
+	 */
 	template<typename ExceptionT, typename... ArgsT>
 	[[ noreturn ]] void throws (ArgsT&&... args)
 	{
+#if defined(__cpp_exceptions)
 		throw ExceptionT { std::forward<ArgsT>(args)... };
+#else
+		((void)args, ...);
+		std::abort();
+#endif
 	}
 }
 
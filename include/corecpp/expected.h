@@ -1,6 +1,8 @@
 #ifndef CORECPP_EXPECTED_H
 #define CORECPP_EXPECTED_H
 
+#include <cassert>
+#include <optional>
 #include <utility>
 
 #include <corecpp/variant.h>
@@ -56,6 +58,51 @@ namespace corecpp
 		}
 	};
 
+	/**
+	 * \brief result of an operation which returns nothing, but may fail
+	 */
+	template <typename ErrT>
+	class expected<void, ErrT>
+	{
+		std::optional<ErrT> m_error;
+	public:
+		expected() noexcept
+		: m_error()
+		{}
+
+		expected(ErrT&& arg)
+		: m_error { std::move(arg) }
+		{}
+
+		expected(const ErrT& arg)
+		: m_error { arg }
+		{}
+
+		bool operator!() const noexcept
+		{
+			return m_error.has_value();
+		}
+
+		operator bool() const noexcept
+		{
+			return !m_error.has_value();
+		}
+
+		bool has_value() const noexcept
+		{
+			return !m_error.has_value();
+		}
+
+		/**
+		 * \remark must only be called in error state. It does not throw, so that it is usable without exceptions
+		 */
+		const ErrT& error() const noexcept
+		{
+			assert(!has_value());
+			return *m_error;
+		}
+	};
+
 	template <typename T, typename ErrT>
 	std::ostream& operator << (std::ostream& os, const expected<T, ErrT>& e)
 	{
@@ -265,7 +265,7 @@ struct is_tuple_like_impl
 
 template<typename T>
 struct is_tuple_like_impl<T,
-	std::enable_if_t<std::is_integral<decltype(std::tuple_size_v<T>)>::value
+	std::enable_if_t<std::is_integral<decltype(std::tuple_size<T>::value)>::value
 	&& !std::is_void<std::tuple_element_t<0, T>>::value
 	&& !std::is_void<decltype(std::get<0>(*(T*)nullptr))>::value
 	>>
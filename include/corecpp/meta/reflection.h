@@ -10,6 +10,7 @@
 #include <locale>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 namespace corecpp
 {
@@ -289,6 +290,24 @@ public:
 	{
 		return m_name.wstr();
 	}
+	/**
+	 * \brief name of the property, as an utf-8 string
+	 */
+	const std::string& utf8_name() const
+	{
+		return m_name.str();
+	}
+	/**
+	 * \brief compare the name of the property with an utf-8 string, byte-wise
+	 */
+	bool has_name(std::string_view name) const
+	{
+		return name == m_name.str();
+	}
+	bool has_name(const std::wstring& name) const
+	{
+		return name == m_name.wstr();
+	}
 };
 
 template <typename StringT, typename ValueT>
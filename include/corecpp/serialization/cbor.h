@@ -0,0 +1,691 @@
+#ifndef CORECPP_CBOR_H
+#define CORECPP_CBOR_H
+
+#include <chrono>
+#include <cmath>
+#include <codecvt>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <stdexcept>
+
+#include <corecpp/algorithm.h>
+#include <corecpp/except.h>
+#include <corecpp/meta/extensions.h>
+#include <corecpp/serialization/common.h>
+#include <corecpp/serialization/sink.h>
+
+namespace corecpp::cbor
+{
+	/**
+	 * \brief major types of the CBOR data items (RFC 8949, section 3.1)
+	 */
+	enum struct major_type : std::uint8_t
+	{
+		unsigned_integer = 0,
+		negative_integer = 1,
+		byte_string = 2,
+		text_string = 3,
+		array = 4,
+		map = 5,
+		tag = 6,
+		simple = 7
+	};
+
+	/**
+	 * \brief additional information of the major type 7
+	 */
+	namespace simple
+	{
+		constexpr std::uint8_t false_ = 20;
+		constexpr std::uint8_t true_ = 21;
+		constexpr std::uint8_t null = 22;
+		constexpr std::uint8_t undefined = 23;
+		constexpr std::uint8_t half_float = 25;
+		constexpr std::uint8_t single_float = 26;
+		constexpr std::uint8_t double_float = 27;
+	}
+
+	/**
+	 * \brief tag numbers used for the time points
+	 */
+	namespace tags
+	{
+		/* seconds since the epoch, as an integer or a float (RFC 8949) */
+		constexpr std::uint64_t epoch_time = 1;
+		/* map of the seconds (key 1) and of their fraction (keys -3, -6 or -9) since the epoch (RFC 9581) */
+		constexpr std::uint64_t extended_time = 1001;
+	}
+
+	/* additional information of the indefinite length items */
+	constexpr std::uint8_t indefinite_length = 31;
+	/* ends the indefinite length items */
+	constexpr std::uint8_t break_code = 0xff;
+
+	/**
+	 * \brief containers written as CBOR byte strings instead of arrays
+	 */
+	template <typename T>
+	struct is_byte_string : std::false_type
+	{};
+	template <typename AllocT>
+	struct is_byte_string<std::vector<std::byte, AllocT>> : std::true_type
+	{};
+	template <typename AllocT>
+	struct is_byte_string<std::vector<std::uint8_t, AllocT>> : std::true_type
+	{};
+
+	/**
+	 * \brief CBOR (RFC 8949) serializer, writing to any output sink (see corecpp/serialization/sink.h)
+	 * \remark integers, lengths and floats are written in their shortest form. Arrays, associative arrays and the objects
+	 * of the types with properties() have a definite length. The objects whose number of properties is only known at their
+	 * end (custom serialize methods, optional values...) are written with an indefinite length.
+	 * std::vector<std::byte> and std::vector<std::uint8_t> are byte strings. Time points are tagged as epoch based times:
+	 * tag 1 when their precision is the second, tag 1001 with a nanoseconds fraction otherwise.
+	 */
+	template <typename SinkT>
+	class basic_serializer
+	{
+		SinkT m_sink;
+
+		void put(std::uint8_t c)
+		{
+			m_sink.put(static_cast<char>(c));
+		}
+		void write(const char* data, std::size_t size)
+		{
+			m_sink.write(data, size);
+		}
+		/* write initial followed by the big endian bytes of value */
+		template <typename UnsignedT>
+		void write_big_endian(std::uint8_t initial, UnsignedT value)
+		{
+			char buffer[1 + sizeof(UnsignedT)];
+			buffer[0] = static_cast<char>(initial);
+			for (std::size_t i = 0; i < sizeof(UnsignedT); ++i)
+				buffer[1 + i] = static_cast<char>(value >> (8 * (sizeof(UnsignedT) - 1 - i)));
+			write(buffer, sizeof(buffer));
+		}
+		void write_head(major_type major, std::uint64_t argument)
+		{
+			std::uint8_t initial = static_cast<std::uint8_t>(static_cast<std::uint8_t>(major) << 5);
+			if (argument < 24)
+				put(static_cast<std::uint8_t>(initial | argument));
+			else if (argument <= std::numeric_limits<std::uint8_t>::max())
+				write_big_endian(initial | 24, static_cast<std::uint8_t>(argument));
+			else if (argument <= std::numeric_limits<std::uint16_t>::max())
+				write_big_endian(initial | 25, static_cast<std::uint16_t>(argument));
+			else if (argument <= std::numeric_limits<std::uint32_t>::max())
+				write_big_endian(initial | 26, static_cast<std::uint32_t>(argument));
+			else
+				write_big_endian(initial | 27, argument);
+		}
+		void write_simple(std::uint8_t info)
+		{
+			put(static_cast<std::uint8_t>(static_cast<std::uint8_t>(major_type::simple) << 5 | info));
+		}
+		void write_unsigned(std::uint64_t value)
+		{
+			write_head(major_type::unsigned_integer, value);
+		}
+		void write_signed(std::int64_t value)
+		{
+			if (value < 0)
+				write_head(major_type::negative_integer, static_cast<std::uint64_t>(-1 - value));
+			else
+				write_head(major_type::unsigned_integer, static_cast<std::uint64_t>(value));
+		}
+		void write_text(std::string_view value)
+		{
+			write_head(major_type::text_string, value.size());
+			write(value.data(), value.size());
+		}
+		template <typename StringT>
+		void write_key(const StringT& name)
+		{
+			if constexpr (std::is_convertible_v<const StringT&, std::string_view>)
+				write_text(name);
+			else
+				serialize(name);
+		}
+		template <typename ClockT, typename DurationT>
+		void write_time_point(const std::chrono::time_point<ClockT, DurationT>& value)
+		{
+			auto since_epoch = value.time_since_epoch();
+			if constexpr (std::is_integral_v<typename DurationT::rep> && DurationT::period::den == 1)
+			{
+				write_head(major_type::tag, tags::epoch_time);
+				write_signed(std::chrono::duration_cast<std::chrono::seconds>(since_epoch).count());
+			}
+			else
+			{
+				auto seconds = std::chrono::floor<std::chrono::seconds>(since_epoch);
+				auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds);
+				write_head(major_type::tag, tags::extended_time);
+				write_head(major_type::map, 2);
+				write_signed(1);
+				write_signed(seconds.count());
+				write_signed(-9);
+				write_signed(nanoseconds.count());
+			}
+		}
+		/* property names of ValueT, encoded once for all */
+		template <typename ValueT, typename PropertiesT>
+		static const std::vector<std::string>& property_keys(const PropertiesT& properties)
+		{
+			static const std::vector<std::string> keys = [&properties] {
+				std::vector<std::string> result;
+				tuple_foreach([&result](const auto& prop) {
+					std::string key;
+					basic_serializer<string_sink> s { string_sink { key } };
+					s.write_text(prop.utf8_name());
+					result.push_back(std::move(key));
+				}, properties);
+				return result;
+			}();
+			return keys;
+		}
+		template <typename> friend class basic_serializer;
+	public:
+		basic_serializer(SinkT sink)
+		: m_sink { std::move(sink) }
+		{}
+		SinkT& sink()
+		{
+			return m_sink;
+		}
+		/**
+		 * \brief push the bytes buffered by the sink to their final destination
+		 */
+		void flush()
+		{
+			m_sink.flush();
+		}
+		void serialize(bool value)
+		{
+			write_simple(value ? simple::true_ : simple::false_);
+		}
+		void serialize(int8_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int16_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int32_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int64_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(uint8_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(uint16_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(char16_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(uint32_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(uint64_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(char value)
+		{
+			write_signed(value);
+		}
+		void serialize(std::nullptr_t)
+		{
+			write_simple(simple::null);
+		}
+		void serialize(float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write_big_endian(static_cast<std::uint8_t>(0xe0 | simple::single_float), bits);
+		}
+		void serialize(double value)
+		{
+			/* a single precision float is enough when it holds the same value */
+			if (!std::isfinite(value)
+				|| (std::fabs(value) <= std::numeric_limits<float>::max() && static_cast<float>(value) == value))
+				serialize(static_cast<float>(value));
+			else
+			{
+				std::uint64_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				write_big_endian(static_cast<std::uint8_t>(0xe0 | simple::double_float), bits);
+			}
+		}
+		void serialize(const char* value)
+		{
+			write_text(value);
+		}
+		void serialize(const wchar_t* value)
+		{
+			serialize(std::wstring { value });
+		}
+		void serialize(const std::string& value)
+		{
+			write_text(value);
+		}
+		void serialize(std::string_view value)
+		{
+			write_text(value);
+		}
+		void serialize(const std::wstring& value)
+		{
+			write_text(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(value));
+		}
+		void serialize(const std::u16string& value)
+		{
+			write_text(std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>().to_bytes(value));
+		}
+		void serialize(const std::u32string& value)
+		{
+			write_text(std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>().to_bytes(value));
+		}
+		template <typename ValueT, typename Enable = void>
+		void serialize(ValueT&& value)
+		{
+			using value_type = std::decay_t<ValueT>;
+			if constexpr (is_byte_string<value_type>::value)
+			{
+				write_head(major_type::byte_string, value.size());
+				write(reinterpret_cast<const char*>(value.data()), value.size());
+			}
+			else if constexpr (corecpp::is_time_point<value_type>::value)
+				write_time_point(value);
+			else
+			{
+				serialize_impl<basic_serializer, ValueT> impl;
+				impl(*this, std::forward<ValueT>(value));
+			}
+		}
+
+		/* "Low level" methods */
+		/**
+		 * \brief begin an indefinite length map, whose properties are given by write_property
+		 */
+		template <typename ValueT>
+		void begin_object()
+		{
+			put(static_cast<std::uint8_t>(static_cast<std::uint8_t>(major_type::map) << 5 | indefinite_length));
+		}
+		void end_object()
+		{
+			put(break_code);
+		}
+		template <typename StringT, typename ValueT>
+		void write_property(const StringT& name, ValueT&& value)
+		{
+			write_key(name);
+			serialize(std::forward<ValueT>(value));
+		}
+		template <typename StringT, typename FuncT>
+		void write_property_cb(const StringT& name, FuncT func)
+		{
+			write_key(name);
+			func();
+		}
+		template <typename ValueT, typename PropertiesT>
+		void write_object(ValueT&& value, const PropertiesT& properties)
+		{
+			const auto& keys = property_keys<std::decay_t<ValueT>>(properties);
+			auto key = keys.begin();
+			write_head(major_type::map, keys.size());
+			tuple_foreach([&](const auto& prop) {
+				write(key->data(), key->size());
+				++key;
+				this->serialize(prop.cget(value));
+			}, properties);
+		}
+		template <typename ValueT, typename FuncT>
+		void write_object_cb(ValueT&& value, FuncT func)
+		{
+			begin_object<ValueT>();
+			func(std::forward<ValueT>(value));
+			end_object();
+		}
+		template <typename ValueT>
+		void write_array(ValueT&& value)
+		{
+			write_head(major_type::array, std::distance(std::cbegin(value), std::cend(value)));
+			for (const auto& element : value)
+				serialize(element);
+		}
+		template <typename ValueT>
+		void write_associative_array(ValueT&& value)
+		{
+			write_head(major_type::map, value.size());
+			for (const auto& element : value)
+			{
+				serialize(element.first);
+				serialize(element.second);
+			}
+		}
+	};
+	using serializer = basic_serializer<ostream_sink>;
+
+
+	/**
+	* \brief class used to deserialize CBOR held in a contiguous buffer
+	* \remark the buffer is read in place, so it must outlive the deserializer. Definite and indefinite length items are
+	* both accepted, the tags other than the time ones are ignored.
+	* Malformed or truncated input throws corecpp::syntax_error, integers out of the range of their target std::overflow_error.
+	* \implements deserializer concept
+	*/
+	class deserializer
+	{
+		/* initial byte and argument of a data item */
+		struct head
+		{
+			major_type major;
+			std::uint8_t info;
+			std::uint64_t argument;
+			std::size_t offset;
+		};
+		/* number of items of an indefinite length container */
+		static constexpr std::size_t indefinite = std::numeric_limits<std::size_t>::max();
+
+		const char* m_begin;
+		const char* m_current;
+		const char* m_end;
+		std::vector<std::size_t> m_remaining; /* items left in the objects begun with begin_object */
+		std::vector<std::size_t> m_skipped; /* items left in the containers being skipped */
+		std::string m_scratch; /* chunks of the indefinite length strings */
+
+		std::uint8_t read_byte();
+		const char* read_bytes(std::uint64_t size);
+		template <typename UnsignedT>
+		UnsignedT read_big_endian()
+		{
+			const char* bytes = read_bytes(sizeof(UnsignedT));
+			UnsignedT value = 0;
+			for (std::size_t i = 0; i < sizeof(UnsignedT); ++i)
+				value = static_cast<UnsignedT>((value << 8) | static_cast<std::uint8_t>(bytes[i]));
+			return value;
+		}
+		[[ noreturn ]] void unexpected(const char* expected, const head& h) const;
+		head read_raw_head();
+		/* read the head of the next data item, skipping its tags */
+		head read_head();
+		bool at_break() const noexcept;
+		std::optional<std::uint64_t> read_tag();
+		/* true if the integer is an unsigned one, held by unsigned_value, false if held by signed_value */
+		bool to_integer(const head& h, std::int64_t& signed_value, std::uint64_t& unsigned_value) const;
+		double to_float(const head& h) const;
+		bool read_integer(std::int64_t& signed_value, std::uint64_t& unsigned_value);
+		std::string_view read_string(major_type major, const char* expected);
+		std::string_view read_string()
+		{
+			return read_string(major_type::text_string, "text string");
+		}
+		std::size_t read_container_header(major_type major, const char* expected);
+		/* tells if the container, with remaining items left, has another item. Consumes its break code otherwise */
+		bool next_item(std::size_t& remaining);
+		void read_epoch_time(std::int64_t& seconds, std::int64_t& nanoseconds);
+		void skip_value();
+
+		template<typename IntegralT>
+		void deserialize_integral(IntegralT& value)
+		{
+			std::int64_t signed_value;
+			std::uint64_t unsigned_value;
+			if (read_integer(signed_value, unsigned_value))
+			{
+				if (unsigned_value > static_cast<std::make_unsigned_t<IntegralT>>(std::numeric_limits<IntegralT>::max()))
+					corecpp::throws<std::overflow_error>(std::to_string(unsigned_value));
+				value = static_cast<IntegralT>(unsigned_value);
+			}
+			else if constexpr (std::is_signed_v<IntegralT>)
+			{
+				if (signed_value < std::numeric_limits<IntegralT>::lowest())
+					corecpp::throws<std::overflow_error>(std::to_string(signed_value));
+				value = static_cast<IntegralT>(signed_value);
+			}
+			else
+				corecpp::throws<std::overflow_error>(std::to_string(signed_value));
+		}
+		template<typename FloatT>
+		void deserialize_float(FloatT& value)
+		{
+			double result = to_float(read_head());
+			if (std::isfinite(result) && (result > std::numeric_limits<FloatT>::max() || result < std::numeric_limits<FloatT>::lowest()))
+				corecpp::throws<std::overflow_error>(std::to_string(result));
+			value = static_cast<FloatT>(result);
+		}
+		template <typename ClockT, typename DurationT>
+		void read_time_point(std::chrono::time_point<ClockT, DurationT>& value)
+		{
+			using rep = typename DurationT::rep;
+			/* DurationT ticks in a second */
+			using ticks = std::ratio_divide<std::ratio<1>, typename DurationT::period>;
+			std::int64_t seconds, nanoseconds;
+			read_epoch_time(seconds, nanoseconds);
+			/* the seconds and the fraction are converted apart, the seconds alone may not fit in nanoseconds */
+			DurationT whole;
+			if constexpr (ticks::den == 1)
+			{
+				if (seconds > std::numeric_limits<rep>::max() / ticks::num || seconds < std::numeric_limits<rep>::lowest() / ticks::num)
+					corecpp::throws<std::overflow_error>(corecpp::concat<std::string>({ std::to_string(seconds), "s" }));
+				whole = DurationT { static_cast<rep>(static_cast<rep>(seconds) * ticks::num) };
+			}
+			else
+				whole = std::chrono::duration_cast<DurationT>(std::chrono::seconds { seconds });
+			DurationT fraction = std::chrono::duration_cast<DurationT>(std::chrono::nanoseconds { nanoseconds });
+			if ((fraction.count() > 0 && whole.count() > std::numeric_limits<rep>::max() - fraction.count())
+				|| (fraction.count() < 0 && whole.count() < std::numeric_limits<rep>::lowest() - fraction.count()))
+				corecpp::throws<std::overflow_error>(corecpp::concat<std::string>({ std::to_string(seconds), "s ", std::to_string(nanoseconds), "ns" }));
+			value = std::chrono::time_point<ClockT, DurationT> { whole + fraction };
+		}
+		/* call func with the property name, in the first form it accepts */
+		template <typename FuncT>
+		static void invoke_property(FuncT& func, std::string_view name)
+		{
+			if constexpr (std::is_invocable_v<FuncT&, std::string_view>)
+				func(name);
+			else if constexpr (std::is_invocable_v<FuncT&, const std::string&>)
+				func(std::string { name });
+			else
+				func(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(name.data(), name.data() + name.size()));
+		}
+	public:
+		deserializer(std::string_view buffer)
+		: m_begin(buffer.data()), m_current(buffer.data()), m_end(buffer.data() + buffer.size()),
+		m_remaining(), m_skipped(), m_scratch()
+		{}
+		deserializer(const char* data, std::size_t size)
+		: deserializer(std::string_view { data, size })
+		{}
+		/**
+		 * \brief deserialize from another buffer, keeping the scratch buffers
+		 */
+		void reset(std::string_view buffer) noexcept
+		{
+			m_begin = m_current = buffer.data();
+			m_end = buffer.data() + buffer.size();
+			m_remaining.clear();
+		}
+		/**
+		 * \brief offset of the next unread byte, from the begining of the buffer
+		 */
+		std::size_t offset() const noexcept
+		{
+			return m_current - m_begin;
+		}
+		/**
+		 * \brief tells if the whole buffer has been read
+		 */
+		bool at_end() const noexcept
+		{
+			return m_current == m_end;
+		}
+
+		void deserialize(bool& value);
+		void deserialize(int8_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int32_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int64_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint8_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint32_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint64_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(char& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(char16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(std::nullptr_t);
+		void deserialize(float& value)
+		{
+			deserialize_float(value);
+		}
+		void deserialize(double& value)
+		{
+			deserialize_float(value);
+		}
+		void deserialize(std::string& value)
+		{
+			value.assign(read_string());
+		}
+		void deserialize(std::wstring& value);
+		void deserialize(std::u16string& value);
+		void deserialize(std::u32string& value);
+		template <typename ValueT, typename Enable = void>
+		void deserialize(ValueT& value)
+		{
+			if constexpr (is_byte_string<ValueT>::value)
+			{
+				auto bytes = read_string(major_type::byte_string, "byte string");
+				auto data = reinterpret_cast<const typename ValueT::value_type*>(bytes.data());
+				value.assign(data, data + bytes.size());
+			}
+			else if constexpr (corecpp::is_time_point<ValueT>::value)
+				read_time_point(value);
+			else
+			{
+				deserialize_impl<deserializer, ValueT> impl;
+				impl(*this, value);
+			}
+		}
+
+		/* "Low level" methods */
+		template <typename ValueT>
+		void begin_object()
+		{
+			m_remaining.push_back(read_container_header(major_type::map, "map"));
+		}
+		void end_object();
+		template <typename FuncT>
+		void read_property_cb(FuncT func)
+		{
+			if (m_remaining.empty() || !next_item(m_remaining.back()))
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "no more property at offset ", std::to_string(offset()) }));
+			invoke_property(func, read_string());
+		}
+		template <typename ValueT>
+		void read_object(ValueT& value)
+		{
+			for (std::size_t remaining = read_container_header(major_type::map, "map"); next_item(remaining);)
+			{
+				/* give the property name to ValueT in the first form it supports */
+				std::string_view name = read_string();
+				if constexpr (is_property_deserializable<ValueT, deserializer, std::string_view>::value)
+					value.deserialize(*this, name);
+				else if constexpr (is_property_deserializable<ValueT, deserializer, const std::string&>::value)
+					value.deserialize(*this, std::string { name });
+				else
+					value.deserialize(*this, std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(name.data(), name.data() + name.size()));
+			}
+		}
+		/**
+		 * \remark unknown properties are skipped
+		 */
+		template <typename ValueT, typename PropertiesT>
+		void read_object(ValueT& value, const PropertiesT& properties)
+		{
+			for (std::size_t remaining = read_container_header(major_type::map, "map"); next_item(remaining);)
+			{
+				if (!corecpp::details::deserialize_property(*this, value, properties, read_string()))
+					skip_value();
+			}
+		}
+		template <typename ValueT, typename FuncT>
+		void read_object_cb(FuncT func)
+		{
+			for (std::size_t remaining = read_container_header(major_type::map, "map"); next_item(remaining);)
+				invoke_property(func, read_string());
+		}
+		template <typename ValueT>
+		void read_array(ValueT& value)
+		{
+			for (std::size_t remaining = read_container_header(major_type::array, "array"); next_item(remaining);)
+			{
+				value.emplace_back();
+				deserialize(value.back());
+			}
+		}
+		template <typename ValueT>
+		void read_associative_array(ValueT& value)
+		{
+			for (std::size_t remaining = read_container_header(major_type::map, "map"); next_item(remaining);)
+			{
+				typename ValueT::key_type key;
+				typename ValueT::mapped_type mapped;
+				deserialize(key);
+				deserialize(mapped);
+				value.emplace(std::move(key), std::move(mapped));
+			}
+		}
+	};
+}
+
+#endif
@@ -2,11 +2,18 @@
 #define CORECPP_SERIALIZATION_COMMON_H
 
 #include <stdexcept>
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <typeinfo>
 #include <type_traits>
 #include <locale>
 #include <codecvt>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include <corecpp/meta/extensions.h>
 
@@ -27,20 +34,258 @@ namespace corecpp
 	};
 
 
-	template<typename T, typename DeserializerT, typename Enable = void>
-	struct is_deserializable
+	/**
+	 * \brief tells if T has a deserialize(DeserializerT&, PropertyT) method
+	 */
+	template<typename T, typename DeserializerT, typename PropertyT, typename Enable = void>
+	struct is_property_deserializable
 	{
 		static constexpr bool value = false;
 	};
-	template<typename T, typename DeserializerT>
-	struct is_deserializable<T, DeserializerT,
+	template<typename T, typename DeserializerT, typename PropertyT>
+	struct is_property_deserializable<T, DeserializerT, PropertyT,
 							typename std::enable_if<
-								std::is_void<typename std::result_of<decltype(&T::template deserialize<DeserializerT>)(T, DeserializerT&, std::wstring&)>::type
+								std::is_void<decltype(std::declval<T&>().deserialize(std::declval<DeserializerT&>(), std::declval<PropertyT>()))
 							>::value>::type>
 	{
 		static constexpr bool value = true;
 	};
 
+	/**
+	 * \brief tells if T has a deserialize method taking the property name either as an utf-8 string
+	 * (std::string_view or std::string) or as a std::wstring
+	 */
+	template<typename T, typename DeserializerT>
+	struct is_deserializable
+	{
+		static constexpr bool value = is_property_deserializable<T, DeserializerT, std::string_view>::value
+			|| is_property_deserializable<T, DeserializerT, const std::string&>::value
+			|| is_property_deserializable<T, DeserializerT, std::wstring&>::value;
+	};
+
+	namespace details
+	{
+		inline bool property_equals(std::string_view property, std::string_view name)
+		{
+			return property == name;
+		}
+		inline bool property_equals(const std::wstring& property, std::string_view name)
+		{
+			return std::equal(property.begin(), property.end(), name.begin(), name.end(),
+				[](wchar_t wc, char c) { return wc == static_cast<unsigned char>(c); });
+		}
+		inline std::string property_string(std::string_view property)
+		{
+			return std::string { property };
+		}
+		inline std::string property_string(const std::wstring& property)
+		{
+			return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>{}.to_bytes(property);
+		}
+
+		/**
+		 * \brief hash table from the names of a properties() tuple to their position in the tuple
+		 * \remark the seed of the hash is chosen so that the names do not collide, then a lookup costs
+		 * a hash and a single comparison
+		 */
+		class property_table
+		{
+			std::vector<std::string> m_names;
+			std::vector<std::uint16_t> m_slots; /* position + 1, 0 for an empty slot */
+			std::uint32_t m_seed;
+
+			/**
+			 * \brief call f with each byte of the utf-8 encoding of key, as codecvt_utf8 would produce it
+			 */
+			template <typename F>
+			static void utf8_foreach(std::wstring_view key, F f) noexcept
+			{
+				for (wchar_t wc : key)
+				{
+					auto c = static_cast<std::uint32_t>(static_cast<std::make_unsigned_t<wchar_t>>(wc));
+					if (c < 0x80)
+						f(static_cast<unsigned char>(c));
+					else if (c < 0x800)
+					{
+						f(static_cast<unsigned char>(0xC0 | (c >> 6)));
+						f(static_cast<unsigned char>(0x80 | (c & 0x3F)));
+					}
+					else if (c < 0x10000)
+					{
+						f(static_cast<unsigned char>(0xE0 | (c >> 12)));
+						f(static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F)));
+						f(static_cast<unsigned char>(0x80 | (c & 0x3F)));
+					}
+					else
+					{
+						f(static_cast<unsigned char>(0xF0 | (c >> 18)));
+						f(static_cast<unsigned char>(0x80 | ((c >> 12) & 0x3F)));
+						f(static_cast<unsigned char>(0x80 | ((c >> 6) & 0x3F)));
+						f(static_cast<unsigned char>(0x80 | (c & 0x3F)));
+					}
+				}
+			}
+			/* FNV-1a */
+			static std::uint32_t hash(std::string_view name, std::uint32_t seed) noexcept
+			{
+				std::uint32_t h = 2166136261u ^ seed;
+				for (char c : name)
+					h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+				return h ^ (h >> 16);
+			}
+			static std::uint32_t hash(std::wstring_view key, std::uint32_t seed) noexcept
+			{
+				std::uint32_t h = 2166136261u ^ seed;
+				utf8_foreach(key, [&h](unsigned char c) { h = (h ^ c) * 16777619u; });
+				return h ^ (h >> 16);
+			}
+			static bool equals(std::string_view name, std::string_view key) noexcept
+			{
+				return name == key;
+			}
+			static bool equals(std::string_view name, std::wstring_view key) noexcept
+			{
+				std::size_t i = 0;
+				bool equal = true;
+				utf8_foreach(key, [&](unsigned char c) {
+					equal = equal && i < name.size() && static_cast<unsigned char>(name[i++]) == c;
+				});
+				return equal && i == name.size();
+			}
+			template <typename KeyT>
+			std::size_t slot(KeyT key) const noexcept
+			{
+				return hash(key, m_seed) & (m_slots.size() - 1);
+			}
+			bool fill()
+			{
+				std::fill(m_slots.begin(), m_slots.end(), 0);
+				bool perfect = true;
+				for (std::size_t i = 0; i < m_names.size(); ++i)
+				{
+					std::size_t s = slot(std::string_view { m_names[i] });
+					/* duplicated names: the first property wins, as with a linear search */
+					for (; m_slots[s] && m_names[m_slots[s] - 1] != m_names[i]; s = (s + 1) & (m_slots.size() - 1))
+						perfect = false;
+					if (!m_slots[s])
+						m_slots[s] = static_cast<std::uint16_t>(i + 1);
+				}
+				return perfect;
+			}
+			template <typename KeyT>
+			std::size_t lookup(KeyT key) const noexcept
+			{
+				for (std::size_t s = slot(key); m_slots[s]; s = (s + 1) & (m_slots.size() - 1))
+				{
+					if (equals(m_names[m_slots[s] - 1], key))
+						return m_slots[s] - 1;
+				}
+				return npos;
+			}
+		public:
+			static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+			template <typename PropertiesT>
+			explicit property_table(const PropertiesT& properties)
+			: m_names(), m_slots(), m_seed(0)
+			{
+				static_assert(std::tuple_size_v<PropertiesT> < 0xFFFF, "too many properties");
+				tuple_foreach([this](const auto& prop) { m_names.push_back(prop.utf8_name()); }, properties);
+				std::size_t capacity = 4;
+				while (capacity < m_names.size() * 2)
+					capacity *= 2;
+				/* the table grows up to 4 slots per name, 64 seeds are tried for each size */
+				const std::size_t max_capacity = capacity * 2;
+				constexpr std::uint32_t seeds = 64;
+				m_slots.resize(capacity);
+				while (!fill())
+				{
+					if (++m_seed % seeds == 0)
+					{
+						if (capacity == max_capacity)
+						{
+							/* no seed is perfect: the collisions are resolved by linear probing */
+							m_seed = 0;
+							fill();
+							break;
+						}
+						m_slots.resize(capacity *= 2);
+					}
+				}
+			}
+			/**
+			 * \brief position of the property named name, or npos
+			 */
+			std::size_t find(std::string_view name) const noexcept
+			{
+				return lookup(name);
+			}
+			/**
+			 * \brief position of the property whose utf-8 name is the encoding of name, or npos
+			 * \remark name is hashed and compared as utf-8 on the fly, without being converted
+			 */
+			std::size_t find(std::wstring_view name) const noexcept
+			{
+				return lookup(name);
+			}
+		};
+
+		template <typename DeserializerT, typename ValueT, typename PropertiesT, std::size_t... I>
+		constexpr auto property_setters(std::index_sequence<I...>)
+		{
+			using setter = void (*)(DeserializerT&, ValueT&, const PropertiesT&);
+			return std::array<setter, sizeof...(I)> {
+				static_cast<setter>([](DeserializerT& d, ValueT& value, const PropertiesT& properties) {
+					d.deserialize(std::get<I>(properties).get(value));
+				})...
+			};
+		}
+
+		/**
+		 * \brief table of the properties of ValueT, built on the first call
+		 */
+		template <typename ValueT, typename PropertiesT>
+		const property_table& get_property_table(const PropertiesT& properties)
+		{
+			static const property_table table { properties };
+			return table;
+		}
+
+		/**
+		 * \brief deserialize the property at a given position of properties, without any name comparison
+		 */
+		template <typename DeserializerT, typename ValueT, typename PropertiesT>
+		void deserialize_property_at(DeserializerT& d, ValueT& value, const PropertiesT& properties, std::size_t position)
+		{
+			static constexpr auto setters = property_setters<DeserializerT, ValueT, PropertiesT>(
+				std::make_index_sequence<std::tuple_size_v<PropertiesT>> {});
+			setters[position](d, value, properties);
+		}
+
+		/**
+		 * \brief deserialize the property of value named name, if any
+		 * \return false if value has no such property
+		 */
+		template <typename DeserializerT, typename ValueT, typename PropertiesT>
+		bool deserialize_property(DeserializerT& d, ValueT& value, const PropertiesT& properties, std::string_view name)
+		{
+			auto position = get_property_table<ValueT>(properties).find(name);
+			if (position == property_table::npos)
+				return false;
+			deserialize_property_at(d, value, properties, position);
+			return true;
+		}
+		template <typename DeserializerT, typename ValueT, typename PropertiesT>
+		bool deserialize_property(DeserializerT& d, ValueT& value, const PropertiesT& properties, const std::wstring& name)
+		{
+			auto position = get_property_table<ValueT>(properties).find(std::wstring_view { name });
+			if (position == property_table::npos)
+				return false;
+			deserialize_property_at(d, value, properties, position);
+			return true;
+		}
+	}
+
 
 	template <typename SerializerT, typename ValueT, typename Enable = void>
 	struct serialize_impl
@@ -185,14 +430,11 @@ namespace corecpp
 		void operator () (DeserializerT& d, ValueT& value)
 		{
 			value = ValueT {};
-			d.template read_object_cb<ValueT>([&](const std::wstring& property)
+			d.template read_object_cb<ValueT>([&](const auto& property)
 			{
 				using value_type = typename std::remove_reference<decltype(*value)>::type;
-				if (property != L"value")
-				{
-					std::string name = std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>{}.to_bytes(property.data());
-					throw std::runtime_error(corecpp::concat<std::string>({ "invalid property ", name}));
-				}
+				if (!details::property_equals(property, "value"))
+					throw std::runtime_error(corecpp::concat<std::string>({ "invalid property ", details::property_string(property)}));
 				value = ValueT(new value_type());
 				d.deserialize(*value);
 			});
@@ -206,13 +448,10 @@ namespace corecpp
 		void operator () (DeserializerT& d, ValueT& value)
 		{
 			value = ValueT {};
-			d.template read_object_cb<ValueT>([&](const std::wstring& property){
+			d.template read_object_cb<ValueT>([&](const auto& property){
 				using value_type = typename std::remove_reference<decltype(*value)>::type;
-				if (property != L"value")
-				{
-					std::string name = std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>{}.to_bytes(property.data());
-					throw std::runtime_error(corecpp::concat<std::string>({ "invalid property ", name}));
-				}
+				if (!details::property_equals(property, "value"))
+					throw std::runtime_error(corecpp::concat<std::string>({ "invalid property ", details::property_string(property)}));
 				value = value_type();
 				d.deserialize(*value);
 			});
@@ -292,7 +531,7 @@ namespace corecpp
 				[&d](auto&& v)
 				{
 					d.read_property_cb(
-						[&v,&d] (const std::wstring &)
+						[&v,&d] (const auto&)
 						{
 							d.deserialize(v);
 						});
@@ -0,0 +1,650 @@
+#ifndef CORECPP_COMPACT_H
+#define CORECPP_COMPACT_H
+
+#include <algorithm>
+#include <codecvt>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <typeindex>
+#include <typeinfo>
+#include <vector>
+#include <stdexcept>
+
+#include <corecpp/algorithm.h>
+#include <corecpp/except.h>
+#include <corecpp/meta/extensions.h>
+#include <corecpp/serialization/common.h>
+#include <corecpp/serialization/sink.h>
+
+/*
+ * COMPACT BINARY FORMAT
+ * The values are written without any name or type on the wire: both ends are expected to share the declaration of
+ * the types, checked by the schema fingerprint written in front of the messages.
+ *  - booleans are a byte, 0 or 1
+ *  - unsigned integers are LEB128 varints, signed integers zigzag encoded LEB128 varints
+ *  - floats are their IEEE 754 bits, little endian
+ *  - strings are their utf-8 length, as a varint, followed by their utf-8 bytes
+ *  - arrays and associative arrays are their number of elements, as a varint, followed by their elements
+ *  - pointers and optional values are a presence byte, followed by the value if any
+ *  - the objects of the types with properties() are their properties, in the order of the properties() tuple
+ *  - the other objects (custom serialize methods, tuples, variants...) are a sequence of property names and values,
+ *    ended by an empty name
+ */
+namespace corecpp::compact
+{
+	namespace details
+	{
+		template <typename T, typename Enable = void>
+		struct has_properties : std::false_type
+		{};
+		template <typename T>
+		struct has_properties<T, std::void_t<decltype(T::properties())>> : std::true_type
+		{};
+
+		/* smart pointers, whose values are created with new */
+		template <typename T, typename Enable = void>
+		struct is_owning_pointer : std::false_type
+		{};
+		template <typename T>
+		struct is_owning_pointer<T, std::enable_if_t<std::is_constructible_v<T, std::add_pointer_t<typename T::element_type>>>>
+		: std::true_type
+		{};
+
+		template <typename T>
+		struct is_string : std::false_type
+		{};
+		template <typename CharT, typename TraitsT, typename AllocT>
+		struct is_string<std::basic_string<CharT, TraitsT, AllocT>> : std::true_type
+		{};
+		template <typename CharT, typename TraitsT>
+		struct is_string<std::basic_string_view<CharT, TraitsT>> : std::true_type
+		{};
+		template <>
+		struct is_string<const char*> : std::true_type
+		{};
+		template <>
+		struct is_string<const wchar_t*> : std::true_type
+		{};
+
+		/**
+		 * \brief types whose properties are being described, so that a recursive type is described once
+		 */
+		using describing_types = std::vector<std::type_index>;
+
+		/**
+		 * \brief append the description of the wire layout of ValueT to schema
+		 */
+		template <typename ValueT>
+		void describe(std::string& schema, describing_types& describing);
+
+		template <typename ValueT, typename PropertiesT>
+		void describe_properties(std::string& schema, describing_types& describing, const PropertiesT& properties)
+		{
+			/* a recursive type is described once, its inner occurrences are only marked */
+			std::type_index type { typeid(ValueT) };
+			if (std::find(describing.begin(), describing.end(), type) != describing.end())
+			{
+				schema.append("^");
+				return;
+			}
+			describing.push_back(type);
+			schema.append("(");
+			tuple_foreach([&schema, &describing](const auto& prop) {
+				schema.append(prop.utf8_name()).append(":");
+				describe<typename std::decay_t<decltype(prop)>::value_type>(schema, describing);
+				schema.append(";");
+			}, properties);
+			schema.append(")");
+			describing.pop_back();
+		}
+
+		template <typename ValueT>
+		void describe(std::string& schema, describing_types& describing)
+		{
+			using value_type = std::decay_t<ValueT>;
+			if constexpr (std::is_same_v<value_type, bool>)
+				schema.append("b");
+			else if constexpr (std::is_same_v<value_type, char>)
+				schema.append("c");
+			else if constexpr (std::is_integral_v<value_type>)
+				schema.append(std::is_signed_v<value_type> ? "i" : "u").append(std::to_string(8 * sizeof(value_type)));
+			else if constexpr (std::is_floating_point_v<value_type>)
+				schema.append("f").append(std::to_string(8 * sizeof(value_type)));
+			else if constexpr (is_string<value_type>::value)
+				schema.append("s");
+			else if constexpr (std::is_enum_v<value_type>)
+				describe<std::underlying_type_t<value_type>>(schema, describing);
+			else if constexpr (corecpp::is_time_point<value_type>::value)
+			{
+				using period = typename value_type::period;
+				schema.append("t").append(std::to_string(period::num)).append("/").append(std::to_string(period::den));
+				describe<typename value_type::rep>(schema, describing);
+			}
+			else if constexpr (corecpp::is_dereferencable<value_type>::value)
+			{
+				schema.append("?");
+				describe<std::remove_reference_t<decltype(*std::declval<value_type&>())>>(schema, describing);
+			}
+			else if constexpr (has_properties<value_type>::value)
+				describe_properties<value_type>(schema, describing, value_type::properties());
+			else if constexpr (is_associative<value_type>::value)
+			{
+				schema.append("{");
+				describe<typename value_type::key_type>(schema, describing);
+				schema.append(",");
+				describe<typename value_type::mapped_type>(schema, describing);
+				schema.append("}");
+			}
+			else if constexpr (is_iterable<value_type>::value)
+			{
+				schema.append("[");
+				describe<typename value_type::value_type>(schema, describing);
+				schema.append("]");
+			}
+			else /* described by the names written along with the values */
+				schema.append("o");
+		}
+	}
+
+	/**
+	 * \brief fingerprint of the wire layout of ValueT, built from the names and the types of its properties
+	 * \remark the types whose properties are written along with their names (custom serialize methods...) only add
+	 * their kind to the fingerprint
+	 */
+	template <typename ValueT>
+	std::uint64_t fingerprint()
+	{
+		static const std::uint64_t result = [] {
+			std::string schema;
+			details::describing_types describing;
+			details::describe<ValueT>(schema, describing);
+			/* FNV-1a */
+			std::uint64_t hash = 0xcbf29ce484222325ull;
+			for (char c : schema)
+			{
+				hash ^= static_cast<std::uint8_t>(c);
+				hash *= 0x100000001b3ull;
+			}
+			return hash;
+		}();
+		return result;
+	}
+
+	/**
+	 * \brief compact binary serializer, writing to any output sink (see corecpp/serialization/sink.h)
+	 * \remark serialize writes a bare value, serialize_message prefixes it with the fingerprint of its type
+	 */
+	template <typename SinkT>
+	class basic_serializer
+	{
+		SinkT m_sink;
+
+		void put(std::uint8_t c)
+		{
+			m_sink.put(static_cast<char>(c));
+		}
+		void write(const char* data, std::size_t size)
+		{
+			m_sink.write(data, size);
+		}
+		void write_varint(std::uint64_t value)
+		{
+			char buffer[10];
+			std::size_t size = 0;
+			for (; value >= 0x80; value >>= 7)
+				buffer[size++] = static_cast<char>(value | 0x80);
+			buffer[size++] = static_cast<char>(value);
+			write(buffer, size);
+		}
+		void write_signed(std::int64_t value)
+		{
+			write_varint((static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63));
+		}
+		template <typename UnsignedT>
+		void write_little_endian(UnsignedT value)
+		{
+			char buffer[sizeof(UnsignedT)];
+			for (std::size_t i = 0; i < sizeof(UnsignedT); ++i)
+				buffer[i] = static_cast<char>(value >> (8 * i));
+			write(buffer, sizeof(buffer));
+		}
+		void write_string(std::string_view value)
+		{
+			write_varint(value.size());
+			write(value.data(), value.size());
+		}
+		template <typename StringT>
+		void write_key(const StringT& name)
+		{
+			if constexpr (std::is_convertible_v<const StringT&, std::string_view>)
+				write_string(name);
+			else
+				serialize(name);
+		}
+	public:
+		basic_serializer(SinkT sink)
+		: m_sink { std::move(sink) }
+		{}
+		SinkT& sink()
+		{
+			return m_sink;
+		}
+		/**
+		 * \brief push the bytes buffered by the sink to their final destination
+		 */
+		void flush()
+		{
+			m_sink.flush();
+		}
+		/**
+		 * \brief write the fingerprint of ValueT, followed by value
+		 */
+		template <typename ValueT>
+		void serialize_message(const ValueT& value)
+		{
+			write_little_endian(fingerprint<ValueT>());
+			serialize(value);
+		}
+		void serialize(bool value)
+		{
+			put(value ? 1 : 0);
+		}
+		void serialize(int8_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int16_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int32_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int64_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(uint8_t value)
+		{
+			write_varint(value);
+		}
+		void serialize(uint16_t value)
+		{
+			write_varint(value);
+		}
+		void serialize(char16_t value)
+		{
+			write_varint(value);
+		}
+		void serialize(uint32_t value)
+		{
+			write_varint(value);
+		}
+		void serialize(uint64_t value)
+		{
+			write_varint(value);
+		}
+		void serialize(char value)
+		{
+			write_varint(static_cast<unsigned char>(value));
+		}
+		void serialize(float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write_little_endian(bits);
+		}
+		void serialize(double value)
+		{
+			std::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write_little_endian(bits);
+		}
+		void serialize(const char* value)
+		{
+			write_string(value);
+		}
+		void serialize(const wchar_t* value)
+		{
+			serialize(std::wstring { value });
+		}
+		void serialize(const std::string& value)
+		{
+			write_string(value);
+		}
+		void serialize(std::string_view value)
+		{
+			write_string(value);
+		}
+		void serialize(const std::wstring& value)
+		{
+			write_string(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(value));
+		}
+		void serialize(const std::u16string& value)
+		{
+			write_string(std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>().to_bytes(value));
+		}
+		void serialize(const std::u32string& value)
+		{
+			write_string(std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>().to_bytes(value));
+		}
+		template <typename ValueT, typename Enable = void>
+		void serialize(ValueT&& value)
+		{
+			if constexpr (corecpp::is_dereferencable<std::decay_t<ValueT>>::value)
+			{
+				put(value ? 1 : 0);
+				if (value)
+					serialize(*value);
+			}
+			else
+			{
+				serialize_impl<basic_serializer, ValueT> impl;
+				impl(*this, std::forward<ValueT>(value));
+			}
+		}
+
+		/* "Low level" methods */
+		/**
+		 * \brief begin an object whose properties are given, along with their names, by write_property
+		 */
+		template <typename ValueT>
+		void begin_object()
+		{}
+		void end_object()
+		{
+			write_varint(0);
+		}
+		template <typename StringT, typename ValueT>
+		void write_property(const StringT& name, ValueT&& value)
+		{
+			write_key(name);
+			serialize(std::forward<ValueT>(value));
+		}
+		template <typename StringT, typename FuncT>
+		void write_property_cb(const StringT& name, FuncT func)
+		{
+			write_key(name);
+			func();
+		}
+		template <typename ValueT, typename PropertiesT>
+		void write_object(ValueT&& value, const PropertiesT& properties)
+		{
+			tuple_foreach([&](const auto& prop) {
+				this->serialize(prop.cget(value));
+			}, properties);
+		}
+		template <typename ValueT, typename FuncT>
+		void write_object_cb(ValueT&& value, FuncT func)
+		{
+			begin_object<ValueT>();
+			func(std::forward<ValueT>(value));
+			end_object();
+		}
+		template <typename ValueT>
+		void write_array(ValueT&& value)
+		{
+			write_varint(std::distance(std::cbegin(value), std::cend(value)));
+			for (const auto& element : value)
+				serialize(element);
+		}
+		template <typename ValueT>
+		void write_associative_array(ValueT&& value)
+		{
+			write_varint(value.size());
+			for (const auto& element : value)
+			{
+				serialize(element.first);
+				serialize(element.second);
+			}
+		}
+	};
+	using serializer = basic_serializer<ostream_sink>;
+
+
+	/**
+	* \brief class used to deserialize the compact binary format held in a contiguous buffer
+	* \remark the buffer is read in place, so it must outlive the deserializer.
+	* Malformed or truncated input throws corecpp::syntax_error, integers out of the range of their target std::overflow_error,
+	* messages of another type corecpp::semantic_error.
+	* \implements deserializer concept
+	*/
+	class deserializer
+	{
+		const char* m_begin;
+		const char* m_current;
+		const char* m_end;
+
+		std::uint8_t read_byte();
+		const char* read_bytes(std::size_t size);
+		std::uint64_t read_varint();
+		std::int64_t read_signed();
+		/* number of elements of a container, each of them taking a byte at least */
+		std::size_t read_size();
+		std::string_view read_string();
+		template <typename UnsignedT>
+		UnsignedT read_little_endian()
+		{
+			const char* bytes = read_bytes(sizeof(UnsignedT));
+			UnsignedT value = 0;
+			for (std::size_t i = 0; i < sizeof(UnsignedT); ++i)
+				value |= static_cast<UnsignedT>(static_cast<std::uint8_t>(bytes[i])) << (8 * i);
+			return value;
+		}
+		void check_fingerprint(std::uint64_t expected);
+
+		template<typename IntegralT>
+		void deserialize_integral(IntegralT& value)
+		{
+			if constexpr (std::is_signed_v<IntegralT>)
+			{
+				std::int64_t result = read_signed();
+				if (result > std::numeric_limits<IntegralT>::max() || result < std::numeric_limits<IntegralT>::lowest())
+					corecpp::throws<std::overflow_error>(std::to_string(result));
+				value = static_cast<IntegralT>(result);
+			}
+			else
+			{
+				std::uint64_t result = read_varint();
+				if (result > std::numeric_limits<IntegralT>::max())
+					corecpp::throws<std::overflow_error>(std::to_string(result));
+				value = static_cast<IntegralT>(result);
+			}
+		}
+		/* call func with the property name, in the first form it accepts */
+		template <typename FuncT>
+		static void invoke_property(FuncT& func, std::string_view name)
+		{
+			if constexpr (std::is_invocable_v<FuncT&, std::string_view>)
+				func(name);
+			else if constexpr (std::is_invocable_v<FuncT&, const std::string&>)
+				func(std::string { name });
+			else
+				func(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(name.data(), name.data() + name.size()));
+		}
+	public:
+		deserializer(std::string_view buffer)
+		: m_begin(buffer.data()), m_current(buffer.data()), m_end(buffer.data() + buffer.size())
+		{}
+		deserializer(const char* data, std::size_t size)
+		: deserializer(std::string_view { data, size })
+		{}
+		/**
+		 * \brief deserialize from another buffer
+		 */
+		void reset(std::string_view buffer) noexcept
+		{
+			m_begin = m_current = buffer.data();
+			m_end = buffer.data() + buffer.size();
+		}
+		/**
+		 * \brief offset of the next unread byte, from the begining of the buffer
+		 */
+		std::size_t offset() const noexcept
+		{
+			return m_current - m_begin;
+		}
+		/**
+		 * \brief tells if the whole buffer has been read
+		 */
+		bool at_end() const noexcept
+		{
+			return m_current == m_end;
+		}
+		/**
+		 * \brief read a value written by serialize_message, after checking its fingerprint
+		 */
+		template <typename ValueT>
+		void deserialize_message(ValueT& value)
+		{
+			check_fingerprint(fingerprint<ValueT>());
+			deserialize(value);
+		}
+
+		void deserialize(bool& value);
+		void deserialize(int8_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int32_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int64_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint8_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint32_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint64_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(char& value)
+		{
+			unsigned char result;
+			deserialize_integral(result);
+			value = static_cast<char>(result);
+		}
+		void deserialize(char16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(float& value);
+		void deserialize(double& value);
+		void deserialize(std::string& value)
+		{
+			value.assign(read_string());
+		}
+		void deserialize(std::wstring& value);
+		void deserialize(std::u16string& value);
+		void deserialize(std::u32string& value);
+		template <typename ValueT, typename Enable = void>
+		void deserialize(ValueT& value)
+		{
+			if constexpr (corecpp::is_dereferencable<ValueT>::value)
+			{
+				value = ValueT {};
+				if (!read_byte())
+					return;
+				if constexpr (details::is_owning_pointer<ValueT>::value)
+					value = ValueT(new typename ValueT::element_type());
+				else
+					value = typename ValueT::value_type();
+				deserialize(*value);
+			}
+			else
+			{
+				deserialize_impl<deserializer, ValueT> impl;
+				impl(*this, value);
+			}
+		}
+
+		/* "Low level" methods */
+		template <typename ValueT>
+		void begin_object()
+		{}
+		void end_object();
+		template <typename FuncT>
+		void read_property_cb(FuncT func)
+		{
+			std::string_view name = read_string();
+			if (name.empty())
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "no more property at offset ", std::to_string(offset()) }));
+			invoke_property(func, name);
+		}
+		template <typename ValueT>
+		void read_object(ValueT& value)
+		{
+			for (std::string_view name = read_string(); !name.empty(); name = read_string())
+			{
+				/* give the property name to ValueT in the first form it supports */
+				if constexpr (is_property_deserializable<ValueT, deserializer, std::string_view>::value)
+					value.deserialize(*this, name);
+				else if constexpr (is_property_deserializable<ValueT, deserializer, const std::string&>::value)
+					value.deserialize(*this, std::string { name });
+				else
+					value.deserialize(*this, std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(name.data(), name.data() + name.size()));
+			}
+		}
+		template <typename ValueT, typename PropertiesT>
+		void read_object(ValueT& value, const PropertiesT& properties)
+		{
+			tuple_foreach([&](const auto& prop) {
+				this->deserialize(prop.get(value));
+			}, properties);
+		}
+		template <typename ValueT, typename FuncT>
+		void read_object_cb(FuncT func)
+		{
+			for (std::string_view name = read_string(); !name.empty(); name = read_string())
+				invoke_property(func, name);
+		}
+		template <typename ValueT>
+		void read_array(ValueT& value)
+		{
+			for (std::size_t size = read_size(); size; --size)
+			{
+				value.emplace_back();
+				deserialize(value.back());
+			}
+		}
+		template <typename ValueT>
+		void read_associative_array(ValueT& value)
+		{
+			for (std::size_t size = read_size(); size; --size)
+			{
+				typename ValueT::key_type key;
+				typename ValueT::mapped_type mapped;
+				deserialize(key);
+				deserialize(mapped);
+				value.emplace(std::move(key), std::move(mapped));
+			}
+		}
+	};
+}
+
+#endif
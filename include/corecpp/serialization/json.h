@@ -1,15 +1,26 @@
 #ifndef CORECPP_JSON_H
 #define CORECPP_JSON_H
 
+#include <atomic>
+#include <cmath>
 #include <codecvt>
+#include <condition_variable>
+#include <cstdint>
 #include <cwchar>
 #include <functional>
+#include <future>
 #include <iterator>
 #include <iostream>
+#include <limits>
 #include <locale>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
 #include <type_traits>
 #include <vector>
 #include <stdexcept>
@@ -19,93 +30,173 @@
 #include <corecpp/variant.h>
 #include <corecpp/visibility.h>
 #include <corecpp/except.h>
+#include <corecpp/expected.h>
 #include <corecpp/serialization/common.h>
+#include <corecpp/serialization/json_tokenizer.h>
+#include <corecpp/serialization/number_format.h>
+#include <corecpp/serialization/sink.h>
 
 namespace corecpp::json
 {
 	_internal  corecpp::diagnostic::event_producer& json_logger();
-	struct open_brace_token
-	{};
-
-	struct close_brace_token
-	{};
-
-	struct open_bracket_token
-	{};
-
-	struct close_bracket_token
-	{};
-
-	struct comma_token
-	{};
-
-	struct dot_token
-	{};
-
-	struct colon_token
-	{};
-
-	struct string_token
-	{
-		std::wstring value;
-	};
-
-	struct numeric_token
+	/**
+	 * \brief tokenizer fed with successive chunks of input, keeping its state across the chunk boundaries
+	 * \remark it never rewinds: the beginning of an incomplete token is kept in a scratch buffer,
+	 * or in the lexer state, until the next chunks complete it. A chunk only has to live until next returns need_more.
+	 * String literals are returned as string_view_token, valid until the next call to next.
+	 */
+	class chunk_tokenizer
 	{
-		double value;
-	};
+		enum struct lexer_state : std::uint8_t
+		{
+			blank,   /* between two tokens */
+			string,  /* in a string literal */
+			escape,  /* after a backslash */
+			unicode, /* in the hex digits of a \u escape sequence */
+			number,
+			keyword  /* in true, false or null */
+		};
+		const char* m_begin;
+		const char* m_current;
+		const char* m_end;
+		std::size_t m_offset; /* offset of the current chunk in the whole input */
+		lexer_state m_state;
+		bool m_finished;
+		std::string m_literal; /* string literal, or number, spanning several chunks */
+		std::string_view m_keyword;
+		std::size_t m_matched; /* chars of m_keyword already read */
+		char32_t m_code; /* code of the \u escape sequence being read */
+		char32_t m_high; /* utf-16 high surrogate waiting for its low surrogate, 0 if none */
+		int m_digits; /* hex digits of m_code already read */
 
-	struct integral_token
-	{
-		long value;
+		void check_high_surrogate() const;
+		void read_number(const char* begin, const char* end, token& tk);
+	public:
+		chunk_tokenizer() noexcept
+		: m_begin(nullptr), m_current(nullptr), m_end(nullptr), m_offset(0), m_state(lexer_state::blank), m_finished(false),
+		m_literal(), m_keyword(), m_matched(0), m_code(0), m_high(0), m_digits(0)
+		{}
+		/**
+		 * \brief give the next chunk of input
+		 * \remark the previous chunk must have been consumed, i.e. next returned need_more
+		 */
+		void feed(std::string_view chunk) noexcept
+		{
+			m_offset += m_end - m_begin;
+			m_begin = m_current = chunk.data();
+			m_end = chunk.data() + chunk.size();
+		}
+		/**
+		 * \brief tell no chunk follows, so that a trailing number completes
+		 */
+		void finish() noexcept
+		{
+			m_finished = true;
+		}
+		/**
+		 * \brief complete the token pending at the end of the chunks given so far, as if the input ended there
+		 * \remark to be called once next returned need_more. Unlike finish, it lets more chunks be given afterwards:
+		 * only a pending number is completed, any other token waits for them.
+		 * \return token_status::ready if tk holds the pending number, token_status::need_more if another token
+		 * is pending, token_status::end if none
+		 */
+		token_status flush(token& tk);
+		/**
+		 * \brief start a new input, keeping the scratch buffer
+		 */
+		void reset() noexcept
+		{
+			m_begin = m_current = m_end = nullptr;
+			m_offset = 0;
+			m_state = lexer_state::blank;
+			m_finished = false;
+			m_high = 0;
+		}
+		/**
+		 * \brief extract the next token into tk
+		 * \return token_status::ready if tk holds the next token, token_status::need_more once the chunk is consumed,
+		 * token_status::end once the input is finished and consumed
+		 * \throw corecpp::lexical_error or corecpp::syntax_error if the input is not valid json, or ends in the middle of a token
+		 */
+		token_status next(token& tk);
+		/**
+		 * \brief offset of the next unread char, from the begining of the whole input
+		 */
+		std::size_t offset() const noexcept
+		{
+			return m_offset + (m_current - m_begin);
+		}
+		/**
+		 * \brief tells if the input read so far ends in the middle of a token
+		 */
+		bool in_token() const noexcept
+		{
+			return m_state != lexer_state::blank;
+		}
 	};
 
-	struct null_token
-	{};
-
-	struct true_token
-	{};
-
-	struct false_token
-	{};
-
-	using token = corecpp::variant<open_brace_token, close_brace_token, open_bracket_token, close_bracket_token,
-		comma_token, dot_token, colon_token,
-		string_token, numeric_token, integral_token,
-		null_token, true_token, false_token>;
-
-	std::string to_string(const token& tk);
 
+	/**
+	 * \brief tokenizer reading a stream buffer
+	 * \remark the chars are taken from the stream buffer by chunks, as it holds them, and tokenized by a chunk_tokenizer:
+	 * an incomplete token is kept by the tokenizer, never rewound, so that the stream buffer does not need to be seekable.
+	 * The chars following the last token may already have been taken from the stream buffer.
+	 */
 	class tokenizer
 	{
-		using pos_type = std::streambuf::pos_type;
+		static constexpr std::size_t chunk_size = 65536;
 		std::streambuf& m_buffer;
-		std::locale m_locale;
+		encoding m_encoding;
+		chunk_tokenizer m_lexer;
+		std::string m_chunk; /* chars taken from m_buffer, tokenized by m_lexer */
+		std::size_t m_chunk_offset; /* offset of m_chunk in the whole input */
 
-		wchar_t read_escaped_char();
-		unsigned int read_exponential(char c);
-		std::unique_ptr<token> read_string_literal();
-		std::unique_ptr<token> read_numeric_literal(char c);
+		/* give the lexer the next chars of the stream buffer, waiting for them if needed. false at end of stream */
+		bool fill();
 	public:
-		tokenizer(std::streambuf& buffer)
-		: m_buffer(buffer), m_locale(m_buffer.getloc())
+		tokenizer(std::streambuf& buffer, encoding enc = encoding::wide)
+		: m_buffer(buffer), m_encoding(enc), m_lexer(), m_chunk(), m_chunk_offset(0)
 		{}
+		/**
+		 * \brief tells if the value of a string_view_token stays valid once the next token is read
+		 */
+		bool is_persistent(std::string_view) const noexcept
+		{
+			return false;
+		}
+		/**
+		 * \brief extract the next token into tk
+		 * \return token_status::ready if tk holds the next token. Otherwise tk is left untouched and the status tells
+		 * whether the stream ends with an incomplete token or has no more token.
+		 * \remark an incomplete token is completed by the next call, if the stream has received more chars in between
+		 */
+		token_status next(token& tk);
 		/**
 		 * \brief extract the next token
 		 * \return a pointer to the next token, or an empty unique_ptr if no more token to read.
-		 * \remark if the next token read doesn't require to read all the parameter, the unread characters are still
-		 * reachable through the reminder method
-		 * TODO: Use optional once they are available
+		 * \deprecated allocates each token, use next(token&) instead
 		 */
 		std::unique_ptr<token> next();
+		/**
+		 * \brief offset of the next unread char, from the begining of the stream
+		 */
+		std::size_t offset() const noexcept
+		{
+			return m_lexer.offset();
+		}
 		/**
 			* \brief get the unread chars
 			*/
 		std::string reminder() const
 		{
-			std::string res;
-			res.resize(m_buffer.in_avail());
-			m_buffer.sgetn(res.data(), m_buffer.in_avail());
+			std::string res = m_chunk.substr(std::min(m_lexer.offset() - m_chunk_offset, m_chunk.size()));
+			auto available = m_buffer.in_avail();
+			if (available > 0)
+			{
+				std::size_t size = res.size();
+				res.resize(size + available);
+				m_buffer.sgetn(res.data() + size, available);
+			}
 			return res;
 		}
 	};
@@ -116,9 +207,22 @@ namespace corecpp::json
 		std::wstring value;
 	};
 
+	/**
+	 * \brief string value of a DOM parsed with encoding::utf8, kept as utf-8 bytes
+	 */
+	struct utf8_string_node
+	{
+		std::string value;
+	};
+
 	struct integral_node
 	{
-		long value;
+		std::int64_t value;
+	};
+
+	struct unsigned_node
+	{
+		std::uint64_t value;
 	};
 
 	struct numeric_node
@@ -152,12 +256,55 @@ namespace corecpp::json
 	static inline auto end(array_node& a) { return std::end(a.values); }
 	static inline auto end(const array_node& a) { return std::end(a.values); }
 
+	/**
+	 * \brief hash index over the member names of a large object
+	 * \remark it is built by the parser and by object_node::emplace once the object has key_index::threshold members,
+	 * and update() indexes the members appended since. The members are left in insertion order.
+	 * A hit on a renamed member is detected, and answered by a linear search (const lookups) or a rebuild,
+	 * but a renamed member can be missed until reset() and update() are called.
+	 */
+	class key_index
+	{
+		struct slot
+		{
+			std::uint32_t position; /* position of the member + 1, 0 for an empty slot */
+			std::uint32_t hash;
+		};
+		std::vector<slot> m_slots;
+		std::size_t m_count = 0; /* number of indexed members */
+		void insert(const std::vector<pair_node>& members, std::size_t position, std::uint32_t hash);
+		std::size_t lookup(const std::vector<pair_node>& members, std::wstring_view key, bool& stale) const;
+	public:
+		static constexpr std::size_t threshold = 16;
+		static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+		/**
+		 * \brief index the members appended since the last update, or rebuild the index if the object shrank
+		 */
+		void update(const std::vector<pair_node>& members);
+		/**
+		 * \brief position of the first member named key, or npos, rebuilding the index if it is stale
+		 */
+		std::size_t find(const std::vector<pair_node>& members, std::wstring_view key);
+		/**
+		 * \brief position of the first member named key, or npos, without updating the index
+		 */
+		std::size_t find(const std::vector<pair_node>& members, std::wstring_view key) const;
+		void reset() noexcept
+		{
+			m_slots.clear();
+			m_count = 0;
+		}
+	};
+
 	struct object_node
 	{
 		std::vector<pair_node> members;
+		key_index index = {};
 
 		template <typename StringT, typename ValueT>
 		value_node& emplace(StringT&& key, ValueT&& value);
+		value_node& at (std::string_view key);
+		const value_node& at (std::string_view key) const;
 		value_node& at (const std::wstring& key);
 		const value_node& at (const std::wstring& key) const;
 	};
@@ -168,10 +315,10 @@ namespace corecpp::json
 
 	struct value_node
 	: public corecpp::variant<object_node, array_node, string_node,
-		integral_node, numeric_node, char_node, boolean_node, null_node>
+		integral_node, unsigned_node, numeric_node, char_node, boolean_node, null_node, utf8_string_node>
 	{
 		using parent_type = corecpp::variant<object_node, array_node, string_node,
-			integral_node, numeric_node, char_node, boolean_node, null_node>;
+			integral_node, unsigned_node, numeric_node, char_node, boolean_node, null_node, utf8_string_node>;
 		template <typename T>
 		value_node(T&& value)
 		noexcept(std::is_nothrow_constructible<parent_type, T&&>::value)
@@ -192,16 +339,26 @@ namespace corecpp::json
 	template <typename StringT, typename ValueT>
 	value_node& object_node::emplace(StringT&& key, ValueT&& value)
 	{
-		for (auto& member : members)
+		if constexpr (!std::is_convertible<StringT, std::wstring_view>::value)
+		{
+			/* utf-8 encoded key */
+			std::string_view str { key };
+			return emplace(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(str.data(), str.data() + str.size()),
+				std::forward<ValueT>(value));
+		}
+		else
 		{
-			if (member.name.value == key)
-				return (member.value = std::forward<ValueT>(value));
+			std::wstring_view name { key };
+			auto position = index.find(members, name);
+			if (position != key_index::npos)
+				return (members[position].value = std::forward<ValueT>(value));
+			members.push_back(pair_node { string_node { std::wstring { name } }, value_node { std::forward<ValueT>(value) } });
+			index.update(members);
+			return members.back().value;
 		}
-		members.emplace_back(key, std::forward<ValueT>(value));
-		return members.back().value;
 	}
 
-	using node = corecpp::variant<object_node, pair_node, array_node, string_node, integral_node, numeric_node, char_node, boolean_node, null_node>;
+	using node = corecpp::variant<object_node, pair_node, array_node, string_node, integral_node, unsigned_node, numeric_node, char_node, boolean_node, null_node, utf8_string_node>;
 
 
 	/* PARSING RULES */
@@ -218,8 +375,10 @@ namespace corecpp::json
 		enum struct status
 		{
 			start = 0,
-			members = 1,
-			end = 2
+			first = 1,     /* after the opening brace */
+			members = 2,   /* after a comma */
+			separator = 3, /* after a member */
+			end = 4
 		};
 		status m_status;
 		std::vector<pair_node> m_members;
@@ -266,8 +425,10 @@ namespace corecpp::json
 		enum struct status
 		{
 			start = 0,
-			members = 1,
-			end = 2
+			first = 1,     /* after the opening bracket */
+			members = 2,   /* after a comma */
+			separator = 3, /* after a value */
+			end = 4
 		};
 		status m_status;
 		std::vector<value_node> m_values;
@@ -302,10 +463,21 @@ namespace corecpp::json
 	};
 
 
+	/**
+	 * \brief DOM builder
+	 * \remark string values are string_node by default, and utf8_string_node with encoding::utf8, whatever the tokenizer.
+	 * Member names are always wide.
+	 */
 	class parser
 	{
 		std::vector<rule> m_stack;
+		encoding m_encoding = encoding::wide;
+		std::string m_literal; /* utf-8 copy of the last wide literal, with encoding::utf8 */
 	public:
+		parser() = default;
+		explicit parser(encoding enc) noexcept
+		: m_stack(), m_encoding(enc), m_literal()
+		{}
 		template <typename RuleT>
 		void start(void)
 		{
@@ -314,178 +486,734 @@ namespace corecpp::json
 			m_stack.emplace_back(RuleT{});
 		}
 		void push(token&& tk);
+		/**
+		 * \brief push all the tokens available from the tokenizer
+		 * \return the status of the last attempt to read a token (need_more or end)
+		 */
+		template <typename TokenizerT>
+		token_status push(TokenizerT& tokenizer)
+		{
+			token tk;
+			token_status status;
+			while ((status = tokenizer.next(tk)) == token_status::ready)
+				push(std::move(tk));
+			return status;
+		}
 		node end();
 	};
 
-	class serializer
+
+	/* TAPE DOCUMENT */
+
+	/**
+	 * \brief type of a value held by a document
+	 */
+	enum struct tape_type : std::uint8_t
 	{
-		std::ostream& m_stream;
-		bool m_pretty;
-		bool m_first;
-		unsigned int m_indent_level;
-		void convert_and_escape(const std::string& value);
-		void convert_and_escape(const std::wstring& value);
-		void convert_and_escape(const std::u16string& value);
-		void convert_and_escape(const std::u32string& value);
-		void indent()
-		{
-			for (int i = 0; i < m_indent_level; ++i)
-				m_stream << "\t";
-		}
+		null = 0,
+		boolean = 1,
+		integral = 2,
+		unsigned_integral = 3,
+		numeric = 4,
+		string = 5,
+		array = 6,
+		object = 7
+	};
+
+	/**
+	 * \brief 16-byte entry of a document tape
+	 * \remark a container is followed by its content: values for an array, key/value pairs for an object.
+	 * Its length is its number of elements or members, and its payload is the index of the entry following
+	 * its content. A string holds its size and its offset in the string arena of the document.
+	 */
+	struct tape_value
+	{
+		tape_type type;
+		std::uint32_t length;
+		union
+		{
+			std::int64_t integral;
+			std::uint64_t unsigned_integral;
+			double numeric;
+			std::uint64_t offset;
+			std::uint64_t end;
+		};
+	};
+	static_assert(sizeof(tape_value) == 16, "tape values must be 16 bytes long");
+
+	class document;
+
+	/**
+	 * \brief lightweight view of a value of a document
+	 * \remark it is only valid as long as the document is neither modified nor destroyed
+	 */
+	class element
+	{
+		const document* m_document;
+		std::size_t m_index;
+		const tape_value& get() const;
+		const tape_value& get(tape_type type) const;
 	public:
-		serializer(std::ostream& s, bool pretty = false)
-		: m_stream { s }, m_pretty { pretty }, m_first { true }, m_indent_level { 0 }
+		element(const document& doc, std::size_t index) noexcept
+		: m_document(&doc), m_index(index)
 		{}
-		void serialize(bool value)
+		tape_type type() const
 		{
-			m_stream << (value ? "true" : "false");
+			return get().type;
 		}
-		void serialize(int8_t value)
+		bool is_null() const
 		{
-			m_stream << std::to_string(value);
+			return type() == tape_type::null;
 		}
-		void serialize(int16_t value)
+		bool as_bool() const
 		{
-			m_stream << std::to_string(value);
+			return get(tape_type::boolean).unsigned_integral != 0;
 		}
-		void serialize(int32_t value)
+		std::int64_t as_integral() const;
+		std::uint64_t as_unsigned() const;
+		double as_double() const;
+		std::string_view as_string() const;
+		/**
+		 * \brief number of elements of an array or of members of an object
+		 */
+		std::size_t size() const
 		{
-			m_stream << std::to_string(value);
+			const auto& value = get();
+			if (value.type != tape_type::array && value.type != tape_type::object)
+				corecpp::throws<std::runtime_error>("json value is not a container");
+			return value.length;
 		}
-		void serialize(int64_t value)
+		/**
+		 * \brief element of an array
+		 */
+		element operator[](std::size_t index) const;
+		/**
+		 * \brief member of an object
+		 */
+		std::optional<element> find(std::string_view key) const;
+		element at(std::string_view key) const;
+		/**
+		 * \brief call func(element) for every element of an array, or func(key, element) for every member of an object
+		 */
+		template <typename FuncT>
+		void for_each(FuncT func) const;
+		/**
+		 * \brief index of the entry following this value and its content
+		 */
+		std::size_t next() const
 		{
-			m_stream << std::to_string(value);
+			const auto& value = get();
+			if (value.type == tape_type::array || value.type == tape_type::object)
+				return value.end;
+			return m_index + 1;
 		}
-		void serialize(uint8_t value)
+	};
+
+	/**
+	 * \brief json document stored as a flat tape of 16-byte values, with all the strings in a single arena
+	 * \remark building it is not recursive, and it is released (or reused by the next parse) at once
+	 */
+	class document
+	{
+		friend class element;
+		std::vector<tape_value> m_tape;
+		std::string m_strings;
+		std::vector<std::size_t> m_stack; /* indices of the containers being built */
+
+		template <typename NextT>
+		void build(NextT next);
+		tape_value& push(tape_type type)
+		{
+			tape_value value;
+			value.type = type;
+			value.length = 0;
+			value.unsigned_integral = 0;
+			return m_tape.emplace_back(value);
+		}
+		void push_string(std::string_view str);
+		void push_scalar(token& tk);
+	public:
+		document() = default;
+		/**
+		 * \brief parse a whole json value held in a buffer
+		 */
+		void parse(std::string_view buffer);
+		/**
+		 * \brief parse the next json value of a stream
+		 */
+		void parse(std::istream& stream);
+		void clear() noexcept
 		{
-			m_stream << std::to_string(value);
+			m_tape.clear();
+			m_strings.clear();
 		}
-		void serialize(uint16_t value)
+		bool empty() const noexcept
 		{
-			m_stream << std::to_string(value);
+			return m_tape.empty();
 		}
-		void serialize(char value)
+		element root() const
 		{
-			m_stream << std::to_string(value);
+			if (m_tape.empty())
+				corecpp::throws<std::runtime_error>("empty json document");
+			return element { *this, 0 };
 		}
-		void serialize(char16_t value)
+		/**
+		 * \brief size of the tape and of the string arena, in bytes
+		 */
+		std::size_t memory_usage() const noexcept
 		{
-			m_stream << std::to_string(value);
+			return m_tape.capacity() * sizeof(tape_value) + m_strings.capacity();
 		}
-		void serialize(uint32_t value)
+	};
+
+	inline const tape_value& element::get() const
+	{
+		return m_document->m_tape[m_index];
+	}
+	inline const tape_value& element::get(tape_type type) const
+	{
+		const auto& value = get();
+		if (value.type != type)
+			corecpp::throws<std::runtime_error>(corecpp::concat<std::string>({ "unexpected json value type ", std::to_string(static_cast<int>(value.type)) }));
+		return value;
+	}
+	inline std::string_view element::as_string() const
+	{
+		const auto& value = get(tape_type::string);
+		return std::string_view { m_document->m_strings.data() + value.offset, value.length };
+	}
+	template <typename FuncT>
+	void element::for_each(FuncT func) const
+	{
+		std::size_t index = m_index + 1;
+		if constexpr (std::is_invocable<FuncT, element>::value)
 		{
-			m_stream << std::to_string(value);
+			const auto& value = get(tape_type::array);
+			while (index != value.end)
+			{
+				element item { *m_document, index };
+				index = item.next();
+				func(item);
+			}
 		}
-		void serialize(uint64_t value)
+		else
 		{
-			m_stream << std::to_string(value);
+			const auto& value = get(tape_type::object);
+			while (index != value.end)
+			{
+				element key { *m_document, index };
+				element item { *m_document, index + 1 };
+				index = item.next();
+				func(key.as_string(), item);
+			}
 		}
-		void serialize(std::nullptr_t)
-		{
-			m_stream << "null";
+	}
+
+	namespace details
+	{
+		/**
+		 * \brief length of the leading part of value which is written as is in a json string,
+		 * that is up to the first quote, backslash or control character (below 0x20)
+		 */
+		std::size_t unescaped_length(std::string_view value) noexcept;
+		/**
+		 * \brief check that value is valid utf-8
+		 * \throw std::range_error at the first invalid byte
+		 */
+		void check_utf8(std::string_view value);
+
+		template <typename T, typename = void>
+		struct has_clear : std::false_type
+		{};
+		template <typename T>
+		struct has_clear<T, std::void_t<decltype(std::declval<T&>().clear())>> : std::true_type
+		{};
+		template <typename T, typename = void>
+		struct has_properties : std::false_type
+		{};
+		template <typename T>
+		struct has_properties<T, std::void_t<decltype(T::properties())>> : std::true_type
+		{};
+		/**
+		 * \brief tells if the json of T is entirely produced by the library, whatever the serializer writing it
+		 * \remark it is the case of numbers, enumerations, strings, and of the containers and the types providing
+		 * properties() made of them. A serialize method might depend on the type of the serializer.
+		 */
+		template <typename T, typename SerializerT>
+		constexpr bool is_plain_serializable();
+		template <typename SerializerT, typename... PropertiesT>
+		constexpr bool are_plain_properties(const std::tuple<PropertiesT...>*)
+		{
+			return (is_plain_serializable<typename PropertiesT::value_type, SerializerT>() && ...);
+		}
+		template <typename T, typename SerializerT>
+		constexpr bool is_plain_serializable()
+		{
+			using ValueT = std::decay_t<T>;
+			if constexpr (std::is_arithmetic_v<ValueT> || std::is_enum_v<ValueT>)
+				return true;
+			else if constexpr (is_serializable<ValueT, SerializerT>::value)
+				return false;
+			else if constexpr (has_properties<ValueT>::value)
+				return are_plain_properties<SerializerT>(static_cast<const std::decay_t<decltype(ValueT::properties())>*>(nullptr));
+			else if constexpr (is_associative<ValueT>::value)
+				return is_plain_serializable<typename ValueT::key_type, SerializerT>()
+					&& is_plain_serializable<typename ValueT::mapped_type, SerializerT>();
+			else if constexpr (is_iterable<ValueT>::value)
+				return is_plain_serializable<typename ValueT::value_type, SerializerT>();
+			else
+				return false;
 		}
-		void serialize(float value)
+
+		/**
+		 * \brief threads kept alive to run the tasks of a serializer
+		 * \remark a task is run by every worker at once, and must not throw
+		 */
+		class worker_pool
+		{
+			std::vector<std::thread> m_threads;
+			std::mutex m_mutex;
+			std::condition_variable m_wake;
+			std::condition_variable m_idle;
+			std::function<void()> m_task;
+			std::size_t m_generation;
+			std::size_t m_running;
+			bool m_stopped;
+			void work();
+			void stop() noexcept;
+		public:
+			explicit worker_pool(unsigned int threads);
+			worker_pool(const worker_pool&) = delete;
+			worker_pool& operator=(const worker_pool&) = delete;
+			~worker_pool();
+			std::size_t size() const noexcept
+			{
+				return m_threads.size();
+			}
+			/**
+			 * \brief start running task on every worker, the previous task being finished
+			 */
+			void start(std::function<void()> task);
+			/**
+			 * \brief wait until every worker has finished the current task
+			 */
+			void wait();
+		};
+
+		/**
+		 * \brief reset value before it is deserialized again, keeping the storage it owns
+		 * \remark strings and containers are cleared, the properties of objects are reset one by one,
+		 * and the other values are value-initialized
+		 */
+		template <typename ValueT>
+		void reset_value(ValueT& value)
 		{
-			/* TODO: set the precision? */
-			m_stream << std::to_string(value);
+			if constexpr (has_properties<ValueT>::value)
+				corecpp::tuple_foreach([&value](const auto& property) { reset_value(property.get(value)); }, ValueT::properties());
+			else if constexpr (has_clear<ValueT>::value)
+				value.clear();
+			else
+				value = ValueT {};
 		}
-		void serialize(double value)
+	}
+
+	/**
+	 * \brief json serializer, writing to any output sink (see corecpp/serialization/sink.h)
+	 */
+	template <typename SinkT>
+	class basic_serializer
+	{
+		template <typename> friend class basic_serializer;
+		SinkT m_sink;
+		bool m_pretty;
+		bool m_first;
+		bool m_validate_utf8;
+		unsigned int m_indent_level;
+		unsigned int m_threads;
+		std::size_t m_chunk_size;
+		std::unique_ptr<details::worker_pool> m_workers; /* started by the first parallel serialization */
+		template <std::size_t N>
+		void write_literal(const char (&str)[N])
 		{
-			m_stream << std::to_string(value);
+			m_sink.write(str, N - 1);
 		}
-		void serialize(const char *value)
+		void write_escaped_char(char32_t c)
 		{
-			m_stream << '"';
-			convert_and_escape(value);
-			m_stream << '"';
+			static const char hex_chars[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
+			char escaped[6] = { '\\', 'u', '0', '0', hex_chars[(c & 0xF0) >> 4], hex_chars[c & 0x0F] };
+			m_sink.write(escaped, sizeof(escaped));
 		}
-		void serialize(const wchar_t *value)
+		void convert_and_escape(std::string_view value)
 		{
-			m_stream << '"';
-			convert_and_escape(value);
-			m_stream << '"';
+			if (m_validate_utf8)
+				details::check_utf8(value);
+			/* utf-8 is written as is: only quotes, backslashes and control chars are escaped */
+			for (;;)
+			{
+				std::size_t length = details::unescaped_length(value);
+				m_sink.write(value.data(), length);
+				if (length == value.size())
+					return;
+				char stop = value[length];
+				if (stop == '\\' || stop == '"')
+				{
+					const char escaped[2] = { '\\', stop };
+					m_sink.write(escaped, sizeof(escaped));
+				}
+				else
+					write_escaped_char(static_cast<unsigned char>(stop));
+				value.remove_prefix(length + 1);
+			}
 		}
-		/* TODO: Allows string to be r-value references
-			*/
-		void serialize(const std::string& value)
+		template <typename CharT>
+		void convert_and_escape(std::basic_string_view<CharT> value)
 		{
-			m_stream << '"';
-			convert_and_escape(value);
-			m_stream << '"';
+			/* TODO: support not only UTF8 */
+			for (CharT wc : value)
+			{
+				char32_t c = static_cast<std::make_unsigned_t<CharT>>(wc);
+				if (c >= 0x20 && c < 0x7F)
+				{
+					if (c == '\\' || c == '\"')
+						m_sink.put('\\');
+					m_sink.put(static_cast<char>(c));
+				}
+				else if (c < 0x100)
+					write_escaped_char(c);
+				else if (c <= 0x7FF)
+				{
+					m_sink.put(static_cast<char>((c >> 6) + 0xC0));
+					m_sink.put(static_cast<char>((c & 0x3F) + 0x80));
+				}
+				else if (c <= 0xFFFF)
+				{
+					m_sink.put(static_cast<char>((c >> 12) + 0xE0));
+					m_sink.put(static_cast<char>(((c >> 6) & 0x3F) + 0x80));
+					m_sink.put(static_cast<char>((c & 0x3F) + 0x80));
+				}
+				else if (c <= 0x10FFFF)
+				{
+					m_sink.put(static_cast<char>((c >> 18) + 0xF0));
+					m_sink.put(static_cast<char>(((c >> 12) & 0x3F) + 0x80));
+					m_sink.put(static_cast<char>(((c >> 6) & 0x3F) + 0x80));
+					m_sink.put(static_cast<char>((c & 0x3F) + 0x80));
+				}
+				else
+					corecpp::throws<std::range_error>(corecpp::concat<std::string>({ "Unable to convert charcode ", std::to_string((uint32_t)c) }));
+			}
 		}
-		void serialize(const std::wstring& value)
+		template <typename CharT>
+		void write_string(std::basic_string_view<CharT> value)
 		{
-			m_stream << '"';
+			m_sink.put('"');
 			convert_and_escape(value);
-			m_stream << '"';
+			m_sink.put('"');
 		}
-		void serialize(const std::u16string& value)
+		void indent()
 		{
-			m_stream << '"';
-			convert_and_escape(value);
-			m_stream << '"';
+			for (int i = 0; i < m_indent_level; ++i)
+				m_sink.put('\t');
 		}
-		void serialize(const std::u32string& value)
+		template <typename NumberT>
+		void write_number(NumberT value)
 		{
-			m_stream << '"';
-			convert_and_escape(value);
-			m_stream << '"';
+			char buffer[number_buffer_size];
+			m_sink.write(buffer, format_number(buffer, value) - buffer);
 		}
-		template <typename ValueT, typename Enable = void>
-		void serialize(ValueT&& value)
+		template <typename FloatT>
+		void write_float(FloatT value)
 		{
-			serialize_impl<serializer, ValueT> impl;
-			impl(*this, std::forward<ValueT>(value));
+			/* json has no representation for infinity and NaN */
+			if (!std::isfinite(value))
+				write_literal("null");
+			else
+				write_number(value);
 		}
+		/**
+		 * \brief escaped and quoted names of the properties of ValueT, followed by a colon, built on the first call
+		 */
+		template <typename ValueT, typename PropertiesT>
+		static const std::vector<std::string>& property_keys(const PropertiesT& properties)
+		{
+			static const std::vector<std::string> keys = [&properties] {
+				std::vector<std::string> result;
+				tuple_foreach([&result](const auto& prop) {
+					std::string key;
+					basic_serializer<string_sink> s { string_sink { key } };
+					s.serialize(prop.name());
+					key.push_back(':');
+					result.push_back(std::move(key));
+				}, properties);
+				return result;
+			}();
+			return keys;
+		}
+		/* serialize chunks of [first, last) into strings on worker threads, and write them in order */
+		template <typename ValueT, typename IteratorT>
+		void write_array_parallel(IteratorT first, IteratorT last)
+		{
+			std::size_t size = last - first;
+			std::size_t chunks = (size + m_chunk_size - 1) / m_chunk_size;
+			std::vector<std::string> outputs(chunks);
+			std::vector<std::promise<void>> done(chunks);
+			std::vector<std::future<void>> ready;
+			for (auto& promise : done)
+				ready.push_back(promise.get_future());
+			std::atomic<std::size_t> next { 0 };
 
-		/* "Low level" methods */
-		template <typename ValueT>
-		void begin_object()
-		{
-//				abi::__cxa_demangle
-			json_logger().trace("begin object", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
-			m_first = true;
-			if (m_pretty)
+			if (!m_workers || m_workers->size() != m_threads)
 			{
-				m_stream << '\n';
-				indent();
+				m_workers.reset();
+				m_workers = std::make_unique<details::worker_pool>(m_threads);
 			}
-			m_stream << '{';
-			if (m_pretty)
+			m_workers->start([&] {
+				for (std::size_t chunk; (chunk = next++) < chunks; )
+				{
+					try
+					{
+						basic_serializer<string_sink> s { string_sink { outputs[chunk] }, m_pretty };
+						s.m_validate_utf8 = m_validate_utf8;
+						s.m_indent_level = m_indent_level;
+						auto end = first + std::min(size, (chunk + 1) * m_chunk_size);
+						for (auto iter = first + chunk * m_chunk_size; iter != end; ++iter)
+							s.write_element(*iter);
+						done[chunk].set_value();
+					}
+					catch (...)
+					{
+						done[chunk].set_exception(std::current_exception());
+					}
+				}
+			});
+			/* on exit, the remaining chunks are abandoned and the workers waited for */
+			struct task_guard
 			{
-				m_stream << '\n';
-				m_indent_level++;
-				indent();
-			}
+				details::worker_pool& workers;
+				std::atomic<std::size_t>& next;
+				std::size_t chunks;
+				~task_guard()
+				{
+					next = chunks;
+					workers.wait();
+				}
+			} guard { *m_workers, next, chunks };
+
+			begin_array<ValueT>();
+			for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+			{
+				ready[chunk].get();
+				if (chunk)
+				{
+					if (m_pretty)
+						write_literal(", ");
+					else
+						m_sink.put(',');
+				}
+				m_sink.write(outputs[chunk].data(), outputs[chunk].size());
+				std::string {}.swap(outputs[chunk]);
+			}
+			m_first = false;
+			end_array();
+		}
+		template <typename ValueT>
+		void write_encoded_property(const std::string& key, const ValueT& value)
+		{
+			if (!m_first)
+			{
+				m_sink.put(',');
+				if (m_pretty)
+				{
+					m_sink.put('\n');
+					indent();
+				}
+			}
+			m_sink.write(key.data(), key.size());
+			serialize(value);
+			m_first = false;
+		}
+	public:
+		basic_serializer(SinkT sink, bool pretty = false)
+		: m_sink { std::move(sink) }, m_pretty { pretty }, m_first { true }, m_validate_utf8 { false }, m_indent_level { 0 },
+		  m_threads { 1 }, m_chunk_size { 0 }, m_workers {}
+		{}
+		/**
+		 * \brief check that the utf-8 strings are valid before writing them, throwing std::range_error otherwise
+		 * \remark disabled by default: the strings are then written as they are
+		 */
+		void validate_utf8(bool enable) noexcept
+		{
+			m_validate_utf8 = enable;
+		}
+		/**
+		 * \brief serialize the arrays of more than chunk_size elements with several threads
+		 * \param threads number of worker threads, 1 to serialize everything on the calling thread
+		 * \param chunk_size number of consecutive elements serialized at once by a worker
+		 * \remark only the containers with random access iterators, whose elements do not have their own serialize
+		 * method (see details::is_plain_serializable), are concerned. The output is the same as the one of a serial
+		 * serialization, and the sink is only used by the calling thread. The workers are started by the first
+		 * parallel serialization, and kept until the serializer is destroyed.
+		 */
+		void set_parallelism(unsigned int threads, std::size_t chunk_size = 4096) noexcept
+		{
+			m_threads = std::max(threads, 1u);
+			m_chunk_size = std::max(chunk_size, std::size_t { 1 });
+		}
+		SinkT& sink()
+		{
+			return m_sink;
+		}
+		/**
+		 * \brief push the chars buffered by the sink to their final destination
+		 */
+		void flush()
+		{
+			m_sink.flush();
+		}
+		void serialize(bool value)
+		{
+			if (value)
+				write_literal("true");
+			else
+				write_literal("false");
+		}
+		void serialize(int8_t value)
+		{
+			write_number(value);
+		}
+		void serialize(int16_t value)
+		{
+			write_number(value);
+		}
+		void serialize(int32_t value)
+		{
+			write_number(value);
+		}
+		void serialize(int64_t value)
+		{
+			write_number(value);
+		}
+		void serialize(uint8_t value)
+		{
+			write_number(value);
+		}
+		void serialize(uint16_t value)
+		{
+			write_number(value);
+		}
+		void serialize(char value)
+		{
+			write_number(value);
+		}
+		void serialize(char16_t value)
+		{
+			write_number(static_cast<std::uint_least16_t>(value));
+		}
+		void serialize(uint32_t value)
+		{
+			write_number(value);
+		}
+		void serialize(uint64_t value)
+		{
+			write_number(value);
+		}
+		void serialize(std::nullptr_t)
+		{
+			write_literal("null");
+		}
+		void serialize(float value)
+		{
+			write_float(value);
+		}
+		void serialize(double value)
+		{
+			write_float(value);
+		}
+		void serialize(const char *value)
+		{
+			write_string(std::string_view { value });
+		}
+		void serialize(const wchar_t *value)
+		{
+			write_string(std::wstring_view { value });
+		}
+		/* TODO: Allows string to be r-value references
+			*/
+		void serialize(const std::string& value)
+		{
+			write_string(std::string_view { value });
+		}
+		void serialize(const std::wstring& value)
+		{
+			write_string(std::wstring_view { value });
+		}
+		void serialize(const std::u16string& value)
+		{
+			write_string(std::u16string_view { value });
+		}
+		void serialize(const std::u32string& value)
+		{
+			write_string(std::u32string_view { value });
+		}
+		template <typename ValueT, typename Enable = void>
+		void serialize(ValueT&& value)
+		{
+			serialize_impl<basic_serializer, ValueT> impl;
+			impl(*this, std::forward<ValueT>(value));
+		}
+
+		/* "Low level" methods */
+		template <typename ValueT>
+		void begin_object()
+		{
+//				abi::__cxa_demangle
+			json_logger().trace("begin object", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
+			m_first = true;
+			if (m_pretty)
+			{
+				m_sink.put('\n');
+				indent();
+			}
+			m_sink.put('{');
+			if (m_pretty)
+			{
+				m_sink.put('\n');
+				m_indent_level++;
+				indent();
+			}
 		}
 		void end_object()
 		{
 			json_logger().trace("end object", __FILE__, __LINE__);
 			if (m_pretty)
 			{
-				m_stream << '\n';
+				m_sink.put('\n');
 				m_indent_level--;
 				indent();
 			}
-			m_stream << '}';
+			m_sink.put('}');
 		}
 
 		template <typename ValueT>
 		void begin_array()
 		{
 			m_first = true;
-			m_stream << '[';
+			m_sink.put('[');
 		}
 		void end_array()
 		{
-			m_stream << ']';
+			m_sink.put(']');
 		}
 
 		template <typename ValueT>
 		void write_element(ValueT&& value)
 		{
 			if (!m_first)
-				m_stream << (m_pretty ? ", " : ",");
+			{
+				if (m_pretty)
+					write_literal(", ");
+				else
+					m_sink.put(',');
+			}
 			serialize(std::forward<ValueT>(value));
 			m_first = false;
 		}
@@ -493,7 +1221,12 @@ namespace corecpp::json
 		void write_element(const ValueT& value)
 		{
 			if (!m_first)
-				m_stream << (m_pretty ? ", " : ",");
+			{
+				if (m_pretty)
+					write_literal(", ");
+				else
+					m_sink.put(',');
+			}
 			serialize(value);
 			m_first = false;
 		}
@@ -503,15 +1236,15 @@ namespace corecpp::json
 		{
 			if (!m_first)
 			{
-				m_stream << ',';
+				m_sink.put(',');
 				if (m_pretty)
 				{
-					m_stream << '\n';
+					m_sink.put('\n');
 					indent();
 				}
 			}
 			serialize(name);
-			m_stream << ':';
+			m_sink.put(':');
 			serialize(std::forward<ValueT>(value));
 			m_first = false;
 		}
@@ -520,15 +1253,15 @@ namespace corecpp::json
 		{
 			if (!m_first)
 			{
-				m_stream << ',';
+				m_sink.put(',');
 				if (m_pretty)
 				{
-					m_stream << '\n';
+					m_sink.put('\n');
 					indent();
 				}
 			}
 			serialize(name);
-			m_stream << ':';
+			m_sink.put(':');
 			serialize(value);
 			m_first = false;
 		}
@@ -537,14 +1270,14 @@ namespace corecpp::json
 		{
 			if (!m_first)
 			{
-				m_stream << ',';
+				m_sink.put(',');
 				{
-					m_stream << '\n';
+					m_sink.put('\n');
 					indent();
 				}
 			}
 			serialize(name);
-			m_stream << ':';
+			m_sink.put(':');
 			func();
 			m_first = false;
 		}
@@ -552,9 +1285,11 @@ namespace corecpp::json
 		template <typename ValueT, typename PropertiesT>
 		void write_object(ValueT&& value, const PropertiesT& properties)
 		{
+			const auto& keys = property_keys<std::decay_t<ValueT>>(properties);
+			auto key = keys.begin();
 			begin_object<ValueT>();
 			tuple_foreach([&](const auto& prop) {
-				this->write_property(prop.name(), prop.cget(value));
+				this->write_encoded_property(*key++, prop.cget(value));
 			}, properties);
 			end_object();
 		}
@@ -569,6 +1304,16 @@ namespace corecpp::json
 		template <typename ValueT>
 		void write_array(ValueT&& value)
 		{
+			using iterator = typename std::decay_t<ValueT>::const_iterator;
+			if constexpr (std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<iterator>::iterator_category>
+				&& details::is_plain_serializable<typename std::iterator_traits<iterator>::value_type, basic_serializer>())
+			{
+				if (m_threads > 1 && static_cast<std::size_t>(std::cend(value) - std::cbegin(value)) > m_chunk_size)
+				{
+					write_array_parallel<ValueT>(std::cbegin(value), std::cend(value));
+					return;
+				}
+			}
 			begin_array<ValueT>();
 			for (typename std::decay_t<ValueT>::const_iterator iter = std::cbegin(value);
 				iter != std::cend(value);
@@ -587,10 +1332,10 @@ namespace corecpp::json
 			{
 				if (!m_first)
 				{
-					m_stream << ',';
+					m_sink.put(',');
 					if (m_pretty)
 					{
-						m_stream << '\n';
+						m_sink.put('\n');
 						indent();
 					}
 				}
@@ -603,59 +1348,125 @@ namespace corecpp::json
 			json_logger().trace("end associative_array", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
 		}
 	};
+	using serializer = basic_serializer<ostream_sink>;
+
 
 
+	void read_string(const string_token& wstr, std::string& value);
+	void read_string(const string_token& wstr, std::wstring& value);
+	void read_string(const string_token& wstr, std::u16string& value);
+	void read_string(const string_token& wstr, std::u32string& value);
+	void read_string(const string_view_token& str, std::string& value);
+	void read_string(const string_view_token& str, std::wstring& value);
+	void read_string(const string_view_token& str, std::u16string& value);
+	void read_string(const string_view_token& str, std::u32string& value);
 
 	/**
-	* \brief class used to deserialize a stream formatted into json
+	* \brief common part of the json deserializers
+	* \remark DeserializerT must provide a read_token() method, loading the next token into m_current
 	* \implements deserializer concept
 	*/
-	class deserializer
+	template <typename DeserializerT>
+	class basic_deserializer
 	{
-		std::istream& m_stream;
-		tokenizer m_tokenizer;
+	protected:
 		token m_current;
 		bool m_first;
+		bool m_in_place; /* reuse the storage of the values, see deserialize_into */
 
-		void read();
+		basic_deserializer()
+		: m_current(), m_first(true), m_in_place(false)
+		{}
+		void read()
+		{
+			static_cast<DeserializerT*>(this)->read_token();
+		}
+		void read_colon()
+		{
+			read();
+			if (m_current.index() != token::index_of<colon_token>::value)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "colon token expected, got ", to_string(m_current) }));
+			read();
+		}
+		/* call func with the property name, converted to the first form func accepts */
+		template <typename FuncT>
+		static void invoke_property(FuncT& func, std::string_view name)
+		{
+			if constexpr (std::is_invocable_v<FuncT&, std::string_view>)
+				func(name);
+			else if constexpr (std::is_invocable_v<FuncT&, const std::string&>)
+				func(std::string { name });
+			else
+			{
+				std::wstring wname;
+				json::read_string(string_view_token { name }, wname);
+				func(wname);
+			}
+		}
+		template <typename FuncT>
+		static void invoke_property(FuncT& func, const std::wstring& name)
+		{
+			if constexpr (std::is_invocable_v<FuncT&, const std::wstring&>)
+				func(name);
+			else
+			{
+				std::string u8name = std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(name);
+				func(u8name);
+			}
+		}
+		template <typename StringT>
+		void read_string(StringT& value)
+		{
+			if (m_current.index() == token::index_of<string_view_token>::value)
+				json::read_string(m_current.get<string_view_token>(), value);
+			else if (m_current.index() == token::index_of<string_token>::value)
+				json::read_string(m_current.get<string_token>(), value);
+			else
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(m_current) }));
+		}
 		template<typename IntegralT, typename = std::enable_if<std::is_integral<IntegralT>::value, IntegralT>>
 		void deserialize_integral(IntegralT& value)
 		{
-			if (m_current.index() != token::index_of<integral_token>::value)
+			if (m_current.index() == token::index_of<integral_token>::value)
+			{
+				auto result = m_current.get<integral_token>().value;
+				bool overflow;
+				if constexpr (std::is_signed_v<IntegralT>)
+					overflow = result > std::numeric_limits<IntegralT>::max() || result < std::numeric_limits<IntegralT>::lowest();
+				else
+					overflow = result < 0 || static_cast<std::uint64_t>(result) > std::numeric_limits<IntegralT>::max();
+				if (overflow)
+					corecpp::throws<std::overflow_error>(std::to_string(result));
+				value = static_cast<IntegralT>(result);
+			}
+			else if (m_current.index() == token::index_of<unsigned_token>::value)
+			{
+				auto result = m_current.get<unsigned_token>().value;
+				if (result > static_cast<std::make_unsigned_t<IntegralT>>(std::numeric_limits<IntegralT>::max()))
+					corecpp::throws<std::overflow_error>(std::to_string(result));
+				value = static_cast<IntegralT>(result);
+			}
+			else
 				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "integral token expected, got ", to_string(m_current) }));
-			auto result = m_current.get<integral_token>().value;
-			if (result > std::numeric_limits<IntegralT>::max()
-				|| result < std::numeric_limits<IntegralT>::lowest())
-				corecpp::throws<std::overflow_error>(std::to_string(result));
-			value = result;
 		}
 		template<typename FloatT, typename = std::enable_if<std::is_integral<FloatT>::value, FloatT>>
 		void deserialize_float(FloatT& value)
 		{
-			if (m_current.index() != token::index_of<numeric_token>::value
-				&& m_current.index() != token::index_of<integral_token>::value)
-				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "numeric or integral token expected, got ", to_string(m_current) }));
-
 			double result;
 			if (m_current.index() == token::index_of<numeric_token>::value)
 				result = m_current.get<numeric_token>().value;
+			else if (m_current.index() == token::index_of<integral_token>::value)
+				result = m_current.get<integral_token>().as_double();
+			else if (m_current.index() == token::index_of<unsigned_token>::value)
+				result = m_current.get<unsigned_token>().value;
 			else
-				result = m_current.get<integral_token>().value;
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "numeric or integral token expected, got ", to_string(m_current) }));
 			if (result > std::numeric_limits<FloatT>::max()
 				|| result < std::numeric_limits<FloatT>::lowest())
 				corecpp::throws<std::overflow_error>(std::to_string(result));
 			value = result;
 		}
-		void read_string(const string_token& wstr, std::string& value);
-		void read_string(const string_token& wstr, std::u16string& value);
-		void read_string(const string_token& wstr, std::u32string& value);
 	public:
-		deserializer(std::istream& s)
-		: m_stream(s), m_tokenizer(*s.rdbuf()), m_first(true)
-		{
-			/* TODO: allow to not read in the ctor */
-			read();
-		}
 		void deserialize(bool& value)
 		{
 			if (m_current.index() == token::index_of<true_token>::value)
@@ -720,33 +1531,63 @@ namespace corecpp::json
 		}
 		void deserialize(std::string& value)
 		{
-			if (m_current.index() != token::index_of<string_token>::value)
-				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(m_current) }));
-			read_string(m_current.get<string_token>(), value);
+			read_string(value);
 		}
 		void deserialize(std::wstring& value)
 		{
-			if (m_current.index() != token::index_of<string_token>::value)
-				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(m_current) }));
-			value = std::move(m_current.get<string_token>().value);
+			if (m_current.index() == token::index_of<string_token>::value)
+				value = std::move(m_current.get<string_token>().value);
+			else
+				read_string(value);
 		}
 		void deserialize(std::u16string& value)
 		{
-			if (m_current.index() != token::index_of<string_token>::value)
-				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(m_current) }));
-			read_string(m_current.get<string_token>(), value);
+			read_string(value);
 		}
 		void deserialize(std::u32string& value)
 		{
-			if (m_current.index() != token::index_of<string_token>::value)
-				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(m_current) }));
-			read_string(m_current.get<string_token>(), value);
+			read_string(value);
 		}
 		template <typename ValueT, typename Enable = void>
 		void deserialize(ValueT& value)
 		{
-			deserialize_impl<deserializer, ValueT> impl;
-			impl(*this, value);
+			deserialize_impl<DeserializerT, ValueT> impl;
+			impl(*static_cast<DeserializerT*>(this), value);
+		}
+		/**
+		 * \brief deserialize the next top-level value of the input, for inputs holding several documents
+		 * \return false at a clean end of input, when nothing but blanks follows the previous document
+		 * \throw corecpp::syntax_error if the input ends in the middle of a document
+		 */
+		template <typename ValueT>
+		bool read_document(ValueT& value)
+		{
+			if (!static_cast<DeserializerT*>(this)->next_document())
+				return false;
+			deserialize(value);
+			return true;
+		}
+		/**
+		 * \brief deserialize into an existing value, reusing the storage it already owns
+		 * \remark strings are assigned in place, array elements are overwritten and the arrays resized to the number of
+		 * elements read, associative arrays are cleared before being filled. The properties missing from the input are reset:
+		 * strings and containers are cleared, keeping their capacity, and the other values are value-initialized.
+		 * Types with their own deserialize method have to reset their members themselves.
+		 */
+		template <typename ValueT>
+		void deserialize_into(ValueT& value)
+		{
+			struct in_place_guard
+			{
+				bool& in_place;
+				bool previous;
+				~in_place_guard()
+				{
+					in_place = previous;
+				}
+			} guard { m_in_place, m_in_place };
+			m_in_place = true;
+			deserialize(value);
 		}
 
 		/* "Low level" methods */
@@ -815,15 +1656,27 @@ namespace corecpp::json
 			else
 				m_first = false;
 
-			if (m_current.index() != token::index_of<string_token>::value)
+			if (m_current.index() == token::index_of<string_view_token>::value)
+			{
+				/* utf-8 names are kept as is, they only need to be copied when the tokenizer is about to reuse them */
+				std::string_view pname = m_current.get<string_view_token>().value;
+				std::string buffer;
+				if (!static_cast<DeserializerT*>(this)->m_tokenizer.is_persistent(pname))
+				{
+					buffer.assign(pname);
+					pname = buffer;
+				}
+				read_colon();
+				invoke_property(func, pname);
+			}
+			else if (m_current.index() == token::index_of<string_token>::value)
+			{
+				std::wstring pname = std::move(m_current.get<string_token>().value);
+				read_colon();
+				invoke_property(func, pname);
+			}
+			else
 				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(m_current) }));
-			std::wstring pname = std::move(m_current.get<string_token>().value);
-
-			read();
-			if (m_current.index() != token::index_of<colon_token>::value)
-				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "colon token expected, got ", to_string(m_current) }));
-			read();
-			func(pname);
 			read();
 		}
 		template <typename ValueT>
@@ -833,16 +1686,17 @@ namespace corecpp::json
 			if (m_current.index() != token::index_of<open_brace_token>::value)
 				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "open brace token expected, got ", to_string(m_current) }));
 
+			auto& self = *static_cast<DeserializerT*>(this);
 			begin_object<ValueT>();
 			while (m_current.index() != token::index_of<close_brace_token>::value)
 			{
-				read_property_cb(
-					[this, &value] (const std::wstring &pname)
-					{
-						json_logger().trace("reading property", __FILE__, __LINE__);
-						value.deserialize(*this, pname);
-						json_logger().trace("property read", __FILE__, __LINE__);
-					});
+				/* give the property name to ValueT in the first form it supports */
+				if constexpr (is_property_deserializable<ValueT, DeserializerT, std::string_view>::value)
+					read_property_cb([&self, &value] (std::string_view pname) { value.deserialize(self, pname); });
+				else if constexpr (is_property_deserializable<ValueT, DeserializerT, const std::string&>::value)
+					read_property_cb([&self, &value] (const std::string& pname) { value.deserialize(self, pname); });
+				else
+					read_property_cb([&self, &value] (const std::wstring& pname) { value.deserialize(self, pname); });
 			};
 			end_object();
 			json_logger().trace("object read", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
@@ -851,25 +1705,24 @@ namespace corecpp::json
 		void read_object(ValueT& value, const PropertiesT& properties)
 		{
 			json_logger().trace("reading object", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
+			auto& self = *static_cast<DeserializerT*>(this);
 			begin_object<ValueT>();
+			/* in place, the properties missing from the input must not keep the value of the previous document */
+			if (m_in_place)
+				corecpp::tuple_foreach([&value](const auto& property) { details::reset_value(property.get(value)); }, properties);
 			while (m_current.index() != token::index_of<close_brace_token>::value)
 			{
 				read_property_cb(
-					[&](const std::wstring &pname)
+					[&](const auto& pname)
 					{
-						tuple_foreach(
-							[&](const auto& prop)
-							{
-								if (prop.name() == pname)
-									this->deserialize(prop.get(value));
-							}, properties);
+						corecpp::details::deserialize_property(self, value, properties, pname);
 					});
 			};
 			end_object();
 			json_logger().trace("object read", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
 		}
-		template <typename ValueT>
-		void read_object_cb(std::function<void(const std::wstring&)> func)
+		template <typename ValueT, typename FuncT>
+		void read_object_cb(FuncT func)
 		{
 			json_logger().trace("reading object", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
 			begin_object<ValueT>();
@@ -887,39 +1740,104 @@ namespace corecpp::json
 			if (m_current.index() != token::index_of<open_bracket_token>::value)
 				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "open bracket token expected, got ", to_string(m_current) }));
 			read();
-			if (m_current.index() == token::index_of<close_bracket_token>::value)
-				return; /* empty array */
-			do
+			/* in place, the existing elements are overwritten first, and the extra ones erased */
+			auto iter = value.begin();
+			bool overwrite = m_in_place && iter != value.end();
+			if (m_current.index() != token::index_of<close_bracket_token>::value)
 			{
-				value.emplace_back();
-				deserialize(value.back());
+				do
+				{
+					if (overwrite)
+					{
+						deserialize(*iter);
+						overwrite = ++iter != value.end();
+					}
+					else
+					{
+						value.emplace_back();
+						deserialize(value.back());
+					}
 
-				read();
-				if (m_current.index() != token::index_of<comma_token>::value)
-					break;
-				read();
-			} while (true);
-			if (m_current.index() != token::index_of<close_bracket_token>::value)
-				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "close bracket token expected, got ", to_string(m_current) }));
+					read();
+					if (m_current.index() != token::index_of<comma_token>::value)
+						break;
+					read();
+				} while (true);
+				if (m_current.index() != token::index_of<close_bracket_token>::value)
+					corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "close bracket token expected, got ", to_string(m_current) }));
+			}
+			if (overwrite)
+				value.erase(iter, value.end());
 			json_logger().trace("array read", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
 		}
-		template <typename ValueT>
-		void read_associative_array(ValueT& value)
+		/**
+		 * \brief check the current token opens an array, and move to its first element
+		 * \return false if the array is empty
+		 * \remark with next_element, reads an array one element at a time, without storing it
+		 */
+		bool enter_array()
 		{
-			json_logger().trace("reading associative_array", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
 			if (m_current.index() != token::index_of<open_bracket_token>::value)
 				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "open bracket token expected, got ", to_string(m_current) }));
 			read();
-			if (m_current.index() == token::index_of<close_bracket_token>::value)
-				return; /* empty associative array */
-			do
+			return m_current.index() != token::index_of<close_bracket_token>::value;
+		}
+		/**
+		 * \brief deserialize the current element of an array, and move to the next one
+		 * \return false once the last element is read
+		 */
+		template <typename ValueT>
+		bool next_element(ValueT& value)
+		{
+			deserialize(value);
+			read();
+			if (m_current.index() == token::index_of<comma_token>::value)
 			{
-				using KeyT = typename ValueT::key_type;
-				using MappedT = typename ValueT::mapped_type;
-				KeyT key;
-				MappedT mapped;
-
-				begin_object<typename ValueT::value_type>();
+				read();
+				return true;
+			}
+			if (m_current.index() != token::index_of<close_bracket_token>::value)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "close bracket token expected, got ", to_string(m_current) }));
+			return false;
+		}
+		/**
+		 * \brief deserialize the elements of an array one at a time into the same ValueT, calling func on each of them
+		 * \return the number of elements read
+		 * \remark the memory used does not depend on the length of the array
+		 */
+		template <typename ValueT, typename FuncT>
+		std::size_t for_each_element(FuncT func)
+		{
+			std::size_t count = 0;
+			ValueT value {};
+			for (bool more = enter_array(); more; ++count)
+			{
+				more = next_element(value);
+				func(value);
+				/* elements are independent: containers must not accumulate the content of the previous ones */
+				details::reset_value(value);
+			}
+			return count;
+		}
+		template <typename ValueT>
+		void read_associative_array(ValueT& value)
+		{
+			json_logger().trace("reading associative_array", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
+			if (m_current.index() != token::index_of<open_bracket_token>::value)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "open bracket token expected, got ", to_string(m_current) }));
+			read();
+			if (m_in_place)
+				value.clear();
+			if (m_current.index() == token::index_of<close_bracket_token>::value)
+				return; /* empty associative array */
+			do
+			{
+				using KeyT = typename ValueT::key_type;
+				using MappedT = typename ValueT::mapped_type;
+				KeyT key;
+				MappedT mapped;
+
+				begin_object<typename ValueT::value_type>();
 				read_element<KeyT>(key);
 				read();
 				read_element<MappedT>(mapped);
@@ -936,6 +1854,1286 @@ namespace corecpp::json
 			json_logger().trace("associative_array read", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
 		}
 	};
+
+
+	/**
+	 * \brief tag building a deserializer which does not read the first token of its input
+	 * \remark such a deserializer reads its documents with read_document
+	 */
+	struct deferred_t
+	{};
+	inline constexpr deferred_t deferred {};
+
+	/**
+	* \brief class used to deserialize a stream formatted into json
+	* \implements deserializer concept
+	*/
+	class deserializer : public basic_deserializer<deserializer>
+	{
+		friend class basic_deserializer<deserializer>;
+		tokenizer m_tokenizer;
+
+		void read_token();
+	public:
+		/**
+		 * \param enc encoding of the string tokens. Using encoding::utf8 avoids widening every string and property name.
+		 */
+		deserializer(std::istream& s, encoding enc = encoding::wide)
+		: deserializer(s, deferred, enc)
+		{
+			read();
+		}
+		/**
+		 * \brief build a deserializer reading successive documents from s (a pipe, a socket, concatenated files...)
+		 * \remark the tokenizer and its buffers are kept from one document to the next
+		 */
+		deserializer(std::istream& s, deferred_t, encoding enc = encoding::wide)
+		: basic_deserializer<deserializer>(), m_tokenizer(*s.rdbuf(), enc)
+		{}
+		/**
+		 * \brief move to the first token of the next document, waiting for it if needed
+		 * \return false at a clean end of stream
+		 * \throw corecpp::syntax_error if the stream ends in the middle of a token
+		 */
+		bool next_document();
+	};
+
+
+	/**
+	* \brief class used to deserialize json held in a contiguous buffer
+	* \remark the buffer is read in place, so it must outlive the deserializer
+	* \implements deserializer concept
+	*/
+	class buffer_deserializer : public basic_deserializer<buffer_deserializer>
+	{
+		friend class basic_deserializer<buffer_deserializer>;
+		buffer_tokenizer m_tokenizer;
+
+		void read_token();
+	public:
+		buffer_deserializer(std::string_view buffer)
+		: buffer_deserializer(buffer, deferred)
+		{
+			read();
+		}
+		/**
+		 * \brief build a deserializer reading successive documents from buffer
+		 */
+		buffer_deserializer(std::string_view buffer, deferred_t)
+		: basic_deserializer<buffer_deserializer>(), m_tokenizer(buffer)
+		{}
+		buffer_deserializer(const char* data, std::size_t size)
+		: buffer_deserializer(std::string_view { data, size })
+		{}
+		/**
+		 * \brief deserialize from another buffer, keeping the scratch buffers
+		 */
+		void reset(std::string_view buffer)
+		{
+			m_tokenizer.reset(buffer);
+			m_first = true;
+			read();
+		}
+		/**
+		 * \brief tells if nothing but blanks follows the last token read
+		 */
+		bool at_end()
+		{
+			token tk;
+			return m_tokenizer.next(tk) == token_status::end;
+		}
+		/**
+		 * \brief move to the first token of the next document
+		 * \return false if nothing but blanks follows the previous document
+		 * \throw corecpp::syntax_error if the buffer ends in the middle of a token
+		 */
+		bool next_document();
+	};
+
+
+	/**
+	 * \brief input range deserializing the elements of a json array one at a time
+	 * \remark every element is read into the same ValueT, which is reset between elements,
+	 * so that the memory used does not depend on the length of the array
+	 */
+	template <typename ValueT, typename DeserializerT>
+	class array_reader
+	{
+		DeserializerT& m_deserializer;
+		ValueT m_value;
+		bool m_started;
+		bool m_more;
+
+		bool read_next()
+		{
+			if (!m_started)
+			{
+				m_started = true;
+				m_more = m_deserializer.enter_array();
+			}
+			if (!m_more)
+				return false;
+			details::reset_value(m_value);
+			m_more = m_deserializer.next_element(m_value);
+			return true;
+		}
+	public:
+		explicit array_reader(DeserializerT& deserializer)
+		: m_deserializer(deserializer), m_value(), m_started(false), m_more(false)
+		{}
+
+		class iterator
+		{
+			array_reader* m_reader;
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = ValueT;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const ValueT*;
+			using reference = const ValueT&;
+
+			explicit iterator(array_reader* reader = nullptr)
+			: m_reader(reader)
+			{
+				if (m_reader)
+					++*this;
+			}
+			reference operator*() const
+			{
+				return m_reader->m_value;
+			}
+			pointer operator->() const
+			{
+				return &m_reader->m_value;
+			}
+			iterator& operator++()
+			{
+				if (!m_reader->read_next())
+					m_reader = nullptr;
+				return *this;
+			}
+			bool operator==(const iterator& other) const noexcept
+			{
+				return m_reader == other.m_reader;
+			}
+			bool operator!=(const iterator& other) const noexcept
+			{
+				return m_reader != other.m_reader;
+			}
+		};
+		/**
+		 * \remark the range can only be iterated once
+		 */
+		iterator begin()
+		{
+			return iterator { this };
+		}
+		iterator end()
+		{
+			return iterator {};
+		}
+	};
+
+	/**
+	 * \brief read the json array at the current position of deserializer one element at a time
+	 */
+	template <typename ValueT, typename DeserializerT>
+	array_reader<ValueT, DeserializerT> read_elements(DeserializerT& deserializer)
+	{
+		return array_reader<ValueT, DeserializerT> { deserializer };
+	}
+
+
+	/* JSON LINES */
+
+	/**
+	 * \brief writer of json lines (ndjson): one compact json value per line
+	 */
+	template <typename SinkT>
+	class basic_lines_writer
+	{
+		basic_serializer<SinkT> m_serializer;
+	public:
+		explicit basic_lines_writer(SinkT sink)
+		: m_serializer { std::move(sink), false }
+		{}
+		template <typename ValueT>
+		void write(const ValueT& value)
+		{
+			m_serializer.serialize(value);
+			m_serializer.sink().put('\n');
+		}
+		void flush()
+		{
+			m_serializer.flush();
+		}
+		basic_serializer<SinkT>& serializer() noexcept
+		{
+			return m_serializer;
+		}
+	};
+	using lines_writer = basic_lines_writer<ostream_sink>;
+
+	/**
+	 * \brief what a json lines reader does with a malformed record
+	 */
+	enum struct record_errors
+	{
+		raise, /* throw, the next read resumes at the next line */
+		skip /* skip the line, and count it */
+	};
+
+	namespace details
+	{
+		/* deserialize a whole record, reusing the deserializer of the previous one if any */
+		template <typename ValueT>
+		void read_record(std::optional<buffer_deserializer>& deserializer, std::string_view record, ValueT& value)
+		{
+			if (deserializer)
+				deserializer->reset(record);
+			else
+				deserializer.emplace(record);
+			/* the errors of a malformed record are all reported as syntax errors */
+			try
+			{
+				deserializer->deserialize(value);
+			}
+			catch (const corecpp::lexical_error& e)
+			{
+				corecpp::throws<corecpp::syntax_error>(e.what());
+			}
+			catch (const std::overflow_error& e)
+			{
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "number out of range: ", e.what() }));
+			}
+			if (!deserializer->at_end())
+				corecpp::throws<corecpp::syntax_error>("unexpected data after the record");
+		}
+		inline bool is_blank_line(std::string_view line) noexcept
+		{
+			return line.find_first_not_of(" \t\r") == std::string_view::npos;
+		}
+	}
+
+	/**
+	 * \brief reader of json lines (ndjson), deserializing one ValueT per non-blank line
+	 * \remark the line buffer and the deserializer are reused from one record to the next.
+	 * It is an input range: iterating over it reads the records.
+	 */
+	template <typename ValueT>
+	class lines_reader
+	{
+		std::istream& m_stream;
+		record_errors m_policy;
+		std::string m_line;
+		std::optional<buffer_deserializer> m_deserializer;
+		std::size_t m_line_number;
+		std::size_t m_errors;
+		ValueT m_value;
+
+	public:
+		explicit lines_reader(std::istream& stream, record_errors policy = record_errors::raise)
+		: m_stream(stream), m_policy(policy), m_line(), m_deserializer(), m_line_number(0), m_errors(0), m_value()
+		{}
+		/**
+		 * \brief deserialize the next record into value
+		 * \return false at the end of the stream
+		 * \remark a malformed record throws corecpp::syntax_error, giving its line number, or is skipped,
+		 * depending on the error policy
+		 */
+		bool read(ValueT& value)
+		{
+			while (std::getline(m_stream, m_line))
+			{
+				++m_line_number;
+				if (details::is_blank_line(m_line))
+					continue;
+				try
+				{
+					details::read_record(m_deserializer, m_line, value);
+					return true;
+				}
+				catch (const corecpp::syntax_error& e)
+				{
+					++m_errors;
+					if (m_policy == record_errors::raise)
+						corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "malformed record at line ",
+							std::to_string(m_line_number), ": ", e.what() }));
+				}
+			}
+			return false;
+		}
+		/**
+		 * \brief number of the line of the last record read
+		 */
+		std::size_t line_number() const noexcept
+		{
+			return m_line_number;
+		}
+		/**
+		 * \brief number of malformed records met so far
+		 */
+		std::size_t errors() const noexcept
+		{
+			return m_errors;
+		}
+
+		class iterator
+		{
+			lines_reader* m_reader;
+		public:
+			using iterator_category = std::input_iterator_tag;
+			using value_type = ValueT;
+			using difference_type = std::ptrdiff_t;
+			using pointer = const ValueT*;
+			using reference = const ValueT&;
+
+			explicit iterator(lines_reader* reader = nullptr)
+			: m_reader(reader)
+			{
+				if (m_reader)
+					++*this;
+			}
+			reference operator*() const
+			{
+				return m_reader->m_value;
+			}
+			pointer operator->() const
+			{
+				return &m_reader->m_value;
+			}
+			iterator& operator++()
+			{
+				/* records are independent: containers must not accumulate the elements of the previous ones */
+				details::reset_value(m_reader->m_value);
+				if (!m_reader->read(m_reader->m_value))
+					m_reader = nullptr;
+				return *this;
+			}
+			bool operator==(const iterator& other) const noexcept
+			{
+				return m_reader == other.m_reader;
+			}
+			bool operator!=(const iterator& other) const noexcept
+			{
+				return m_reader != other.m_reader;
+			}
+		};
+		iterator begin()
+		{
+			return iterator { this };
+		}
+		iterator end()
+		{
+			return iterator {};
+		}
+	};
+
+
+	/**
+	 * \brief options of read_lines_parallel
+	 */
+	struct parallel_lines_options
+	{
+		/* number of worker threads */
+		unsigned int threads = std::max(std::thread::hardware_concurrency(), 1u);
+		/* approximate size of the splits of the input parsed by a worker at once, in bytes */
+		std::size_t split_size = 1 << 20;
+		/* deliver the batches in the order of the input, or as soon as they are parsed */
+		bool ordered = true;
+		record_errors errors = record_errors::raise;
+	};
+
+	/**
+	 * \brief deserialize the json lines of a buffer with several threads
+	 * \param consumer called with a std::vector<ValueT>& batch holding the records of a split of the input,
+	 * always on the calling thread
+	 * \return the number of malformed records skipped
+	 * \remark the buffer is split at line boundaries, and each split is parsed by a worker with its own
+	 * deserializer. The number of splits parsed ahead of the consumer is bounded. With record_errors::raise,
+	 * a malformed record throws a syntax_error giving its offset, once the workers are stopped.
+	 */
+	template <typename ValueT, typename ConsumerT>
+	std::size_t read_lines_parallel(std::string_view buffer, ConsumerT consumer, const parallel_lines_options& options = {})
+	{
+		struct batch
+		{
+			std::vector<ValueT> values;
+			std::size_t errors = 0;
+			std::exception_ptr error;
+		};
+
+		/* split boundaries, right after a newline */
+		std::vector<std::size_t> bounds { 0 };
+		while (bounds.back() < buffer.size())
+		{
+			auto pos = buffer.find('\n', std::min(bounds.back() + std::max(options.split_size, std::size_t { 1 }), buffer.size()) - 1);
+			bounds.push_back(pos == std::string_view::npos ? buffer.size() : pos + 1);
+		}
+		std::size_t splits = bounds.size() - 1;
+		unsigned int threads = static_cast<unsigned int>(std::min<std::size_t>(std::max(options.threads, 1u), splits));
+		std::size_t window = 2 * std::size_t { threads } + 2;
+
+		std::mutex mutex;
+		std::condition_variable parsed, consumed;
+		std::vector<std::optional<batch>> results(splits);
+		std::vector<std::size_t> completed; /* unordered mode: splits parsed but not delivered */
+		std::size_t next = 0, delivered = 0;
+		bool stopped = false;
+
+		auto parse = [&](std::size_t split) {
+			batch result;
+			std::optional<buffer_deserializer> deserializer;
+			std::size_t begin = bounds[split];
+			while (begin < bounds[split + 1])
+			{
+				std::size_t end = std::min(buffer.find('\n', begin), bounds[split + 1]);
+				auto line = buffer.substr(begin, end - begin);
+				if (!details::is_blank_line(line))
+				{
+					ValueT value {};
+					try
+					{
+						details::read_record(deserializer, line, value);
+						result.values.push_back(std::move(value));
+					}
+					catch (const corecpp::syntax_error& e)
+					{
+						++result.errors;
+						if (options.errors == record_errors::raise)
+						{
+							result.error = std::make_exception_ptr(corecpp::syntax_error(corecpp::concat<std::string>({
+								"malformed record at offset ", std::to_string(begin), ": ", e.what() })));
+							break;
+						}
+					}
+				}
+				begin = end + 1;
+			}
+			return result;
+		};
+		auto work = [&] {
+			std::unique_lock<std::mutex> lock { mutex };
+			for (;;)
+			{
+				/* do not get too far ahead of the consumer */
+				consumed.wait(lock, [&] { return stopped || next == splits || next < delivered + window; });
+				if (stopped || next == splits)
+					return;
+				std::size_t split = next++;
+				lock.unlock();
+				batch result;
+				try
+				{
+					result = parse(split);
+				}
+				catch (...)
+				{
+					result.error = std::current_exception();
+				}
+				lock.lock();
+				results[split] = std::move(result);
+				if (!options.ordered)
+					completed.push_back(split);
+				parsed.notify_one();
+			}
+		};
+
+		struct worker_pool
+		{
+			std::vector<std::thread> threads;
+			std::mutex& mutex;
+			std::condition_variable& consumed;
+			bool& stopped;
+			~worker_pool()
+			{
+				{
+					std::lock_guard<std::mutex> lock { mutex };
+					stopped = true;
+				}
+				consumed.notify_all();
+				for (auto& thread : threads)
+					thread.join();
+			}
+		} workers { {}, mutex, consumed, stopped };
+		for (unsigned int i = 0; i < threads; ++i)
+			workers.threads.emplace_back(work);
+
+		std::size_t errors = 0;
+		while (delivered < splits)
+		{
+			batch result;
+			{
+				std::unique_lock<std::mutex> lock { mutex };
+				std::size_t split;
+				if (options.ordered)
+				{
+					/* reorder buffer: wait for the next split in input order */
+					parsed.wait(lock, [&] { return results[delivered].has_value(); });
+					split = delivered;
+				}
+				else
+				{
+					parsed.wait(lock, [&] { return !completed.empty(); });
+					split = completed.back();
+					completed.pop_back();
+				}
+				result = std::move(*results[split]);
+				results[split].reset();
+				++delivered;
+			}
+			consumed.notify_all();
+			if (result.error)
+				std::rethrow_exception(result.error);
+			errors += result.errors;
+			consumer(result.values);
+		}
+		return errors;
+	}
+
+
+	/* ON-DEMAND ACCESS */
+
+	class cursor;
+
+	/**
+	 * \brief offsets of the structural chars of a json text held in a buffer
+	 * \remark it is built by a single vectorized pass over the buffer, and lets cursors jump over the values they
+	 * do not visit. The buffer is not copied, so it must outlive the index and its cursors.
+	 */
+	class structural_index
+	{
+		std::string_view m_buffer;
+		std::vector<std::uint32_t> m_positions; /* ends with the size of the buffer, as a sentinel */
+	public:
+		explicit structural_index(std::string_view buffer);
+		std::string_view buffer() const noexcept
+		{
+			return m_buffer;
+		}
+		/**
+		 * \brief number of structural chars
+		 */
+		std::size_t size() const noexcept
+		{
+			return m_positions.size() - 1;
+		}
+		std::size_t position(std::size_t entry) const noexcept
+		{
+			return m_positions[entry];
+		}
+		/**
+		 * \brief structural char of an entry, or '\0' for the sentinel
+		 */
+		char at(std::size_t entry) const noexcept
+		{
+			return entry < size() ? m_buffer[m_positions[entry]] : '\0';
+		}
+		/**
+		 * \brief first entry at or after an offset of the buffer
+		 */
+		std::size_t entry(std::size_t offset) const noexcept;
+		cursor root() const;
+	};
+
+	/**
+	 * \brief lightweight view of a value of a structural_index, parsed only when accessed
+	 * \remark the values which are never accessed are skipped without being parsed nor validated
+	 */
+	class cursor
+	{
+		const structural_index* m_index;
+		std::size_t m_offset; /* first char of the value */
+		std::size_t m_entry; /* first entry at or after m_offset */
+		void read_scalar(buffer_tokenizer& tokenizer, token& tk) const;
+		[[noreturn]] void unexpected(const char* expected, std::size_t offset) const;
+		/* key of the member starting at entry, unescaped into buffer if needed */
+		std::string_view read_key(std::size_t entry, std::string& buffer) const;
+		/* whether the container starting at m_offset is closed right away. Scalars are not indexed : the buffer tells */
+		bool is_empty_container(char close) const noexcept;
+		/* call func on the elements or members until it returns false */
+		template <typename FuncT>
+		void iterate(FuncT func) const;
+	public:
+		/**
+		 * \param offset offset of the value, or of the blanks preceding it
+		 * \param entry first entry at or after offset
+		 */
+		cursor(const structural_index& index, std::size_t offset, std::size_t entry) noexcept;
+		std::size_t offset() const noexcept
+		{
+			return m_offset;
+		}
+		tape_type type() const;
+		bool is_null() const
+		{
+			return type() == tape_type::null;
+		}
+		bool as_bool() const;
+		std::int64_t as_integral() const;
+		std::uint64_t as_unsigned() const;
+		double as_double() const;
+		std::string as_string() const;
+		/**
+		 * \brief number of elements of an array or of members of an object
+		 */
+		std::size_t size() const;
+		/**
+		 * \brief element of an array
+		 */
+		cursor operator[](std::size_t index) const;
+		/**
+		 * \brief member of an object
+		 */
+		std::optional<cursor> find(std::string_view key) const;
+		cursor at(std::string_view key) const;
+		/**
+		 * \brief call func(cursor) for every element of an array, or func(key, cursor) for every member of an object
+		 * \remark the elements are skipped through the index, whatever func does with them
+		 */
+		template <typename FuncT>
+		void for_each(FuncT func) const;
+		/**
+		 * \brief entry following this value and its content
+		 */
+		std::size_t next() const;
+		/**
+		 * \brief deserialize this value into value, see cursor_deserializer
+		 */
+		template <typename ValueT>
+		void deserialize(ValueT& value) const;
+	};
+
+	inline cursor structural_index::root() const
+	{
+		return cursor { *this, 0, 0 };
+	}
+
+	template <typename FuncT>
+	void cursor::iterate(FuncT func) const
+	{
+		constexpr bool is_array = std::is_invocable<FuncT, cursor>::value;
+		char open = is_array ? '[' : '{';
+		char close = is_array ? ']' : '}';
+		if (m_offset >= m_index->buffer().size() || m_index->buffer()[m_offset] != open)
+			unexpected(is_array ? "array" : "object", m_offset);
+		if (is_empty_container(close))
+			return;
+		std::string buffer;
+		for (std::size_t entry = m_entry; ; )
+		{
+			std::size_t next;
+			if constexpr (is_array)
+			{
+				cursor item { *m_index, m_index->position(entry) + 1, entry + 1 };
+				next = item.next();
+				if (!func(item))
+					return;
+			}
+			else
+			{
+				auto key = read_key(entry + 1, buffer);
+				if (m_index->at(entry + 3) != ':')
+					unexpected("colon", m_index->position(entry + 2) + 1);
+				cursor item { *m_index, m_index->position(entry + 3) + 1, entry + 4 };
+				next = item.next();
+				if (!func(key, item))
+					return;
+			}
+			if (m_index->at(next) == close)
+				return;
+			if (m_index->at(next) != ',')
+				unexpected("comma or end of container", next < m_index->size() ? m_index->position(next) : m_index->buffer().size());
+			entry = next;
+		}
+	}
+
+	template <typename FuncT>
+	void cursor::for_each(FuncT func) const
+	{
+		if constexpr (std::is_invocable<FuncT, cursor>::value)
+			iterate([&func](const cursor& item) { func(item); return true; });
+		else
+			iterate([&func](std::string_view key, const cursor& item) { func(key, item); return true; });
+	}
+
+	/**
+	* \brief deserializer reading a value through a cursor
+	* \remark the members of an object which are not properties of the deserialized type are jumped over, without
+	* being parsed
+	* \implements deserializer concept
+	*/
+	class cursor_deserializer : public basic_deserializer<cursor_deserializer>
+	{
+		friend class basic_deserializer<cursor_deserializer>;
+		const structural_index& m_index;
+		buffer_tokenizer m_tokenizer;
+
+		void read_token();
+	public:
+		cursor_deserializer(const cursor& c, const structural_index& index)
+		: basic_deserializer<cursor_deserializer>(), m_index(index), m_tokenizer(index.buffer())
+		{
+			m_tokenizer.seek(c.offset());
+			read();
+		}
+		explicit cursor_deserializer(const structural_index& index)
+		: cursor_deserializer(index.root(), index)
+		{}
+		using basic_deserializer<cursor_deserializer>::read_object;
+		template <typename ValueT, typename PropertiesT>
+		void read_object(ValueT& value, const PropertiesT& properties)
+		{
+			json_logger().trace("reading object", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
+			if (m_current.index() != token::index_of<open_brace_token>::value)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "open brace token expected, got ", to_string(m_current) }));
+			std::size_t start = m_tokenizer.offset() - 1;
+			cursor object { m_index, start, m_index.entry(start) };
+			object.for_each([&](std::string_view pname, const cursor& member)
+			{
+				/* only the members which are properties are tokenized */
+				auto position = corecpp::details::get_property_table<ValueT>(properties).find(pname);
+				if (position == corecpp::details::property_table::npos)
+					return;
+				m_tokenizer.seek(member.offset());
+				read();
+				corecpp::details::deserialize_property_at(*this, value, properties, position);
+			});
+			/* leave the closing brace as the current token, as the other deserializers do */
+			m_tokenizer.seek(m_index.position(object.next() - 1) + 1);
+			m_current = close_brace_token {};
+			m_first = false;
+			json_logger().trace("object read", typeid(std::decay_t<ValueT>).name(), __FILE__, __LINE__);
+		}
+	};
+
+	template <typename ValueT>
+	void cursor::deserialize(ValueT& value) const
+	{
+		cursor_deserializer d { *this, *m_index };
+		d.deserialize(value);
+	}
+
+
+	/* SAX READER */
+
+	/**
+	 * \brief what a sax handler asks the reader to do after an event
+	 */
+	enum struct sax_action
+	{
+		proceed = 0, /* go on with the next event */
+		skip = 1,    /* skip the current subtree: the content of the object or array just begun, or the value of the key just read */
+		stop = 2     /* stop reading */
+	};
+
+	/**
+	 * \brief base class for sax handlers, ignoring every event
+	 * \remark the reader calls the methods of the actual handler type, there is nothing virtual here: a handler only
+	 * needs to redefine the events it is interested in. An event method can return void (same as sax_action::proceed)
+	 * or a sax_action.
+	 * Integers above the range of int64_t are given to on_unsigned(std::uint64_t) if the handler defines it,
+	 * and to on_double otherwise.
+	 * When a subtree is skipped, its end event is not sent.
+	 */
+	struct sax_handler
+	{
+		sax_action on_object_begin() { return sax_action::proceed; }
+		sax_action on_key(std::string_view) { return sax_action::proceed; }
+		sax_action on_object_end() { return sax_action::proceed; }
+		sax_action on_array_begin() { return sax_action::proceed; }
+		sax_action on_array_end() { return sax_action::proceed; }
+		sax_action on_string(std::string_view) { return sax_action::proceed; }
+		sax_action on_integer(std::int64_t) { return sax_action::proceed; }
+		sax_action on_double(double) { return sax_action::proceed; }
+		sax_action on_bool(bool) { return sax_action::proceed; }
+		sax_action on_null() { return sax_action::proceed; }
+	};
+
+	template <typename HandlerT, typename Enable = void>
+	struct has_unsigned_event : std::false_type
+	{};
+	template <typename HandlerT>
+	struct has_unsigned_event<HandlerT, std::void_t<decltype(std::declval<HandlerT&>().on_unsigned(std::uint64_t {}))>> : std::true_type
+	{};
+
+	namespace details
+	{
+		/* call a handler event, void events meaning sax_action::proceed */
+		template <typename FuncT>
+		sax_action invoke_event(FuncT func)
+		{
+			if constexpr (std::is_void_v<decltype(func())>)
+			{
+				func();
+				return sax_action::proceed;
+			}
+			else
+				return func();
+		}
+	}
+
+	/**
+	 * \brief event-driven json reader, calling a handler for every value, without building anything
+	 * \remark string values and keys are given as utf-8 views, valid only during the call.
+	 * The reader is not recursive, and allocates nothing per event.
+	 */
+	template <typename ReaderT>
+	class basic_reader
+	{
+	protected:
+		token m_current;
+		std::string m_scratch; /* utf-8 conversion of the wide string tokens */
+		std::vector<char> m_stack; /* opening chars of the containers being read */
+
+		void read()
+		{
+			static_cast<ReaderT*>(this)->read_token();
+		}
+		std::string_view current_string()
+		{
+			if (m_current.index() == token::index_of<string_view_token>::value)
+				return m_current.get<string_view_token>().value;
+			if (m_current.index() != token::index_of<string_token>::value)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(m_current) }));
+			m_scratch = std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(m_current.get<string_token>().value);
+			return m_scratch;
+		}
+		/* skip the value starting at the current token, up to its last token */
+		void skip_value()
+		{
+			/* the skipped containers are pushed on top of the ones being read, to check the pairing of the brackets */
+			std::size_t base = m_stack.size();
+			do
+			{
+				switch (m_current.index())
+				{
+					case token::index_of<open_brace_token>::value:
+						m_stack.push_back('{');
+						break;
+					case token::index_of<open_bracket_token>::value:
+						m_stack.push_back('[');
+						break;
+					case token::index_of<close_brace_token>::value:
+					case token::index_of<close_bracket_token>::value:
+					{
+						char open = m_current.index() == token::index_of<close_brace_token>::value ? '{' : '[';
+						if (m_stack.size() == base)
+							corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "value expected, got ", to_string(m_current) }));
+						if (m_stack.back() != open)
+							corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "mismatched ", to_string(m_current) }));
+						m_stack.pop_back();
+						break;
+					}
+					default:
+						break;
+				}
+				if (m_stack.size() > base)
+					read();
+			} while (m_stack.size() > base);
+		}
+		/* read a key and the colon, then stand on the value, or on its last token if it has been skipped */
+		template <typename HandlerT>
+		sax_action read_key(HandlerT& handler)
+		{
+			sax_action action = details::invoke_event([&] { return handler.on_key(current_string()); });
+			if (action == sax_action::stop)
+				return action;
+			read();
+			if (m_current.index() != token::index_of<colon_token>::value)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "colon token expected, got ", to_string(m_current) }));
+			read();
+			if (action == sax_action::skip)
+				skip_value();
+			return action;
+		}
+		/* send the event for the scalar value held by the current token */
+		template <typename HandlerT>
+		sax_action read_scalar(HandlerT& handler)
+		{
+			switch (m_current.index())
+			{
+				case token::index_of<string_token>::value:
+				case token::index_of<string_view_token>::value:
+					return details::invoke_event([&] { return handler.on_string(current_string()); });
+				case token::index_of<integral_token>::value:
+					return details::invoke_event([&] { return handler.on_integer(m_current.get<integral_token>().value); });
+				case token::index_of<unsigned_token>::value:
+					if constexpr (has_unsigned_event<HandlerT>::value)
+						return details::invoke_event([&] { return handler.on_unsigned(m_current.get<unsigned_token>().value); });
+					else
+						return details::invoke_event([&] { return handler.on_double(static_cast<double>(m_current.get<unsigned_token>().value)); });
+				case token::index_of<numeric_token>::value:
+					return details::invoke_event([&] { return handler.on_double(m_current.get<numeric_token>().value); });
+				case token::index_of<true_token>::value:
+					return details::invoke_event([&] { return handler.on_bool(true); });
+				case token::index_of<false_token>::value:
+					return details::invoke_event([&] { return handler.on_bool(false); });
+				case token::index_of<null_token>::value:
+					return details::invoke_event([&] { return handler.on_null(); });
+				default:
+					corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "value expected, got ", to_string(m_current) }));
+			}
+		}
+	public:
+		basic_reader()
+		: m_current(), m_scratch(), m_stack()
+		{}
+		/**
+		 * \brief read the next json value, calling handler for every event
+		 * \return false if the handler stopped the reading
+		 */
+		template <typename HandlerT>
+		bool parse(HandlerT& handler)
+		{
+			sax_action action;
+			m_stack.clear();
+			read();
+			for (;;)
+			{
+				/* the current token starts a value */
+				switch (m_current.index())
+				{
+					case token::index_of<open_brace_token>::value:
+						action = details::invoke_event([&] { return handler.on_object_begin(); });
+						if (action == sax_action::skip)
+						{
+							skip_value();
+							action = sax_action::proceed;
+							break;
+						}
+						if (action == sax_action::stop)
+							return false;
+						m_stack.push_back('{');
+						read();
+						if (m_current.index() == token::index_of<close_brace_token>::value)
+						{
+							m_stack.pop_back();
+							action = details::invoke_event([&] { return handler.on_object_end(); });
+						}
+						else
+						{
+							action = read_key(handler);
+							if (action == sax_action::proceed)
+								continue;
+							if (action == sax_action::skip)
+								action = sax_action::proceed;
+						}
+						break;
+					case token::index_of<open_bracket_token>::value:
+						action = details::invoke_event([&] { return handler.on_array_begin(); });
+						if (action == sax_action::skip)
+						{
+							skip_value();
+							action = sax_action::proceed;
+							break;
+						}
+						if (action == sax_action::stop)
+							return false;
+						m_stack.push_back('[');
+						read();
+						if (m_current.index() == token::index_of<close_bracket_token>::value)
+						{
+							m_stack.pop_back();
+							action = details::invoke_event([&] { return handler.on_array_end(); });
+							break;
+						}
+						continue;
+					default:
+						action = read_scalar(handler);
+						break;
+				}
+
+				/* the value is over, find where the next one starts */
+				for (;;)
+				{
+					if (action == sax_action::stop)
+						return false;
+					if (m_stack.empty())
+						return true;
+					read();
+					if (m_current.index() == token::index_of<comma_token>::value)
+					{
+						read();
+						if (m_stack.back() == '[')
+							break;
+						action = read_key(handler);
+						if (action == sax_action::proceed)
+							break;
+						if (action == sax_action::skip)
+							action = sax_action::proceed;
+					}
+					else if (m_stack.back() == '{' && m_current.index() == token::index_of<close_brace_token>::value)
+					{
+						m_stack.pop_back();
+						action = details::invoke_event([&] { return handler.on_object_end(); });
+					}
+					else if (m_stack.back() == '[' && m_current.index() == token::index_of<close_bracket_token>::value)
+					{
+						m_stack.pop_back();
+						action = details::invoke_event([&] { return handler.on_array_end(); });
+					}
+					else
+						corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "comma or end of container expected, got ", to_string(m_current) }));
+				}
+			}
+		}
+	};
+
+	/**
+	* \brief sax reader for json held in a stream
+	* \remark the stream is tokenized in utf-8 mode, so that strings are not converted
+	*/
+	class reader : public basic_reader<reader>
+	{
+		friend class basic_reader<reader>;
+		tokenizer m_tokenizer;
+
+		void read_token();
+	public:
+		reader(std::istream& s)
+		: basic_reader<reader>(), m_tokenizer(*s.rdbuf(), encoding::utf8)
+		{}
+	};
+
+	/**
+	* \brief sax reader for json held in a contiguous buffer
+	* \remark the buffer is read in place, so it must outlive the reader
+	*/
+	class buffer_reader : public basic_reader<buffer_reader>
+	{
+		friend class basic_reader<buffer_reader>;
+		buffer_tokenizer m_tokenizer;
+
+		void read_token();
+	public:
+		buffer_reader(std::string_view buffer)
+		: basic_reader<buffer_reader>(), m_tokenizer(buffer)
+		{}
+		buffer_reader(const char* data, std::size_t size)
+		: buffer_reader(std::string_view { data, size })
+		{}
+	};
+
+	/**
+	 * \brief push-driven sax reader, parsing the input chunk by chunk as it arrives (from a pipe, a socket...)
+	 * \remark the lexer and the nesting state are kept across the chunk boundaries, so that a chunk can end anywhere,
+	 * even in the middle of a string, an escape sequence or a number. Events are sent as soon as their token completes.
+	 * The input can hold several top-level values, one after another.
+	 * The events and the actions of the handler are the same as with the other sax readers.
+	 */
+	template <typename HandlerT>
+	class push_reader
+	{
+		enum struct expectation : std::uint8_t
+		{
+			value,
+			value_or_end, /* after [ */
+			key,
+			key_or_end,   /* after { */
+			colon,
+			separator     /* comma or end of container */
+		};
+		HandlerT& m_handler;
+		chunk_tokenizer m_tokenizer;
+		token m_current;
+		std::vector<char> m_stack; /* opening chars of the containers being read */
+		expectation m_expected;
+		std::size_t m_skipped; /* size of the stack when the skipped container has been opened, 0 if none */
+		bool m_skip_value; /* the handler asked to skip the value of the key just read */
+		bool m_stopped;
+
+		[[ noreturn ]] void unexpected(const char* expected) const
+		{
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ expected, " expected, got ", to_string(m_current),
+				" at offset ", std::to_string(m_tokenizer.offset()) }));
+		}
+		bool is(std::size_t index) const noexcept
+		{
+			return m_current.index() == static_cast<int>(index);
+		}
+		template <typename FuncT>
+		sax_action send(FuncT func)
+		{
+			if (m_skipped)
+				return sax_action::proceed;
+			auto action = details::invoke_event(func);
+			if (action == sax_action::stop)
+				m_stopped = true;
+			return action;
+		}
+		void value_read()
+		{
+			m_expected = m_stack.empty() ? expectation::value : expectation::separator;
+		}
+		void close()
+		{
+			bool object = m_stack.back() == '{';
+			m_stack.pop_back();
+			if (m_skipped > m_stack.size())
+				m_skipped = 0; /* the end event of a skipped container is not sent */
+			else if (object)
+				send([&] { return m_handler.on_object_end(); });
+			else
+				send([&] { return m_handler.on_array_end(); });
+			value_read();
+		}
+		void begin_value()
+		{
+			bool skip = m_skip_value;
+			m_skip_value = false;
+			if (is(token::index_of<open_brace_token>::value) || is(token::index_of<open_bracket_token>::value))
+			{
+				bool object = is(token::index_of<open_brace_token>::value);
+				sax_action action = sax_action::skip;
+				if (!skip)
+					action = object ? send([&] { return m_handler.on_object_begin(); }) : send([&] { return m_handler.on_array_begin(); });
+				m_stack.push_back(object ? '{' : '[');
+				if (action == sax_action::skip && !m_skipped)
+					m_skipped = m_stack.size();
+				m_expected = object ? expectation::key_or_end : expectation::value_or_end;
+				return;
+			}
+			if (!skip)
+			{
+				switch (m_current.index())
+				{
+					case token::index_of<string_view_token>::value:
+						send([&] { return m_handler.on_string(m_current.get<string_view_token>().value); });
+						break;
+					case token::index_of<integral_token>::value:
+						send([&] { return m_handler.on_integer(m_current.get<integral_token>().value); });
+						break;
+					case token::index_of<unsigned_token>::value:
+						if constexpr (has_unsigned_event<HandlerT>::value)
+							send([&] { return m_handler.on_unsigned(m_current.get<unsigned_token>().value); });
+						else
+							send([&] { return m_handler.on_double(static_cast<double>(m_current.get<unsigned_token>().value)); });
+						break;
+					case token::index_of<numeric_token>::value:
+						send([&] { return m_handler.on_double(m_current.get<numeric_token>().value); });
+						break;
+					case token::index_of<true_token>::value:
+						send([&] { return m_handler.on_bool(true); });
+						break;
+					case token::index_of<false_token>::value:
+						send([&] { return m_handler.on_bool(false); });
+						break;
+					case token::index_of<null_token>::value:
+						send([&] { return m_handler.on_null(); });
+						break;
+					default:
+						unexpected("value");
+				}
+			}
+			else
+			{
+				/* a skipped value still has to be a value */
+				switch (m_current.index())
+				{
+					case token::index_of<string_view_token>::value:
+					case token::index_of<integral_token>::value:
+					case token::index_of<unsigned_token>::value:
+					case token::index_of<numeric_token>::value:
+					case token::index_of<true_token>::value:
+					case token::index_of<false_token>::value:
+					case token::index_of<null_token>::value:
+						break;
+					default:
+						unexpected("value");
+				}
+			}
+			value_read();
+		}
+		void process()
+		{
+			switch (m_expected)
+			{
+				case expectation::value_or_end:
+					if (is(token::index_of<close_bracket_token>::value))
+						return close();
+					return begin_value();
+				case expectation::value:
+					return begin_value();
+				case expectation::key_or_end:
+					if (is(token::index_of<close_brace_token>::value))
+						return close();
+					[[ fallthrough ]];
+				case expectation::key:
+					if (!is(token::index_of<string_view_token>::value))
+						unexpected("property name");
+					if (send([&] { return m_handler.on_key(m_current.get<string_view_token>().value); }) == sax_action::skip)
+						m_skip_value = true;
+					m_expected = expectation::colon;
+					return;
+				case expectation::colon:
+					if (!is(token::index_of<colon_token>::value))
+						unexpected("colon");
+					m_expected = expectation::value;
+					return;
+				case expectation::separator:
+					if (is(token::index_of<comma_token>::value))
+						m_expected = m_stack.back() == '[' ? expectation::value : expectation::key;
+					else if ((m_stack.back() == '{' && is(token::index_of<close_brace_token>::value))
+						|| (m_stack.back() == '[' && is(token::index_of<close_bracket_token>::value)))
+						close();
+					else
+						unexpected("comma or end of container");
+					return;
+			}
+		}
+		bool parse()
+		{
+			while (!m_stopped && m_tokenizer.next(m_current) == token_status::ready)
+				process();
+			return !m_stopped;
+		}
+	public:
+		explicit push_reader(HandlerT& handler)
+		: m_handler(handler), m_tokenizer(), m_current(), m_stack(), m_expected(expectation::value), m_skipped(0),
+		m_skip_value(false), m_stopped(false)
+		{}
+		/**
+		 * \brief parse the next chunk of input, sending the events of the tokens it completes
+		 * \return false if the handler stopped the reading
+		 * \remark the chunk does not need to outlive the call
+		 */
+		bool feed(std::string_view chunk)
+		{
+			if (m_stopped)
+				return false;
+			m_tokenizer.feed(chunk);
+			return parse();
+		}
+		bool feed(const char* data, std::size_t size)
+		{
+			return feed(std::string_view { data, size });
+		}
+		/**
+		 * \brief tell the input is over, which completes a trailing top-level number
+		 * \return false if the handler stopped the reading
+		 * \throw corecpp::syntax_error if the input ends in the middle of a value
+		 */
+		bool finish()
+		{
+			if (m_stopped)
+				return false;
+			m_tokenizer.finish();
+			if (!parse())
+				return false;
+			if (!m_stack.empty() || m_expected != expectation::value)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ",
+					std::to_string(m_tokenizer.offset()) }));
+			return true;
+		}
+		/**
+		 * \brief tells if the input read so far ends between two top-level values
+		 */
+		bool at_boundary() const noexcept
+		{
+			return m_stack.empty() && m_expected == expectation::value && !m_tokenizer.in_token();
+		}
+	};
 }
 
 #endif
@@ -0,0 +1,337 @@
+#ifndef CORECPP_JSON_CHECKED_H
+#define CORECPP_JSON_CHECKED_H
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <corecpp/algorithm.h>
+#include <corecpp/expected.h>
+#include <corecpp/serialization/common.h>
+#include <corecpp/serialization/json_tokenizer.h>
+
+namespace corecpp::json
+{
+	/**
+	* \brief class used to deserialize json held in a contiguous buffer, reporting errors without any exception
+	* \remark the first error stops the deserialization and is returned by try_deserialize, as a code and an offset.
+	* Supports booleans, numbers, enumerations, std::string, sequence containers, and the types providing
+	* properties() or deserialize(deserializer&, property). Unknown properties are skipped.
+	* The buffer is read in place, so it must outlive the deserializer.
+	* Nothing it instantiates throws, so that it can be used by code built with -fno-exceptions.
+	*/
+	class checked_deserializer
+	{
+		buffer_tokenizer m_tokenizer;
+		token m_current;
+		std::optional<parse_error> m_error;
+		std::string m_name; /* copy of a property name which does not point into the buffer */
+		std::string m_nesting; /* closing chars of the containers being skipped */
+
+		template <typename TokenT>
+		bool is() const noexcept
+		{
+			return m_current.index() == token::index_of<TokenT>::value;
+		}
+		bool fail(parse_errc code)
+		{
+			if (!m_error)
+				m_error = parse_error { code, m_tokenizer.offset() };
+			return false;
+		}
+		bool read()
+		{
+			if (m_error)
+				return false;
+			switch (m_tokenizer.try_next(m_current))
+			{
+				case token_status::ready:
+					return true;
+				case token_status::invalid:
+					m_error = m_tokenizer.error();
+					return false;
+				default:
+					return fail(parse_errc::truncated);
+			}
+		}
+		/* check the current token is a property name, and move to the value */
+		bool read_property_name()
+		{
+			if (!is<string_view_token>())
+				return fail(parse_errc::unexpected_token);
+			if (!read())
+				return false;
+			if (!is<colon_token>())
+				return fail(parse_errc::unexpected_token);
+			return read();
+		}
+		/* after an element or a property, move to the next one */
+		bool read_separator(bool& more)
+		{
+			if (!read())
+				return false;
+			more = is<comma_token>();
+			if (more)
+				return read();
+			return true;
+		}
+		bool is_closing(char closing) const noexcept
+		{
+			return closing == '}' ? is<close_brace_token>() : is<close_bracket_token>();
+		}
+		/* skip the current value, without recursion so that a deep nesting can not exhaust the stack */
+		void skip_value()
+		{
+			m_nesting.clear();
+			for (;;)
+			{
+				if (is<open_brace_token>() || is<open_bracket_token>())
+				{
+					m_nesting.push_back(is<open_brace_token>() ? '}' : ']');
+					if (!read())
+						return;
+					if (!is_closing(m_nesting.back()))
+					{
+						if (m_nesting.back() == '}' && !read_property_name())
+							return;
+						continue;
+					}
+					m_nesting.pop_back();
+				}
+				else if (!is<string_view_token>() && !is<integral_token>() && !is<unsigned_token>() && !is<numeric_token>()
+					&& !is<true_token>() && !is<false_token>() && !is<null_token>())
+				{
+					fail(parse_errc::unexpected_token);
+					return;
+				}
+				/* a value has been read, close the containers it ends */
+				for (;;)
+				{
+					if (m_nesting.empty())
+						return;
+					if (!read())
+						return;
+					if (is<comma_token>())
+					{
+						if (!read() || (m_nesting.back() == '}' && !read_property_name()))
+							return;
+						break;
+					}
+					if (!is_closing(m_nesting.back()))
+					{
+						fail(parse_errc::unexpected_token);
+						return;
+					}
+					m_nesting.pop_back();
+				}
+			}
+		}
+		template <typename IntegralT>
+		void read_integral(IntegralT& value)
+		{
+			if (is<integral_token>())
+			{
+				auto result = m_current.get<integral_token>().value;
+				bool overflow;
+				if constexpr (std::is_signed_v<IntegralT>)
+					overflow = result > std::numeric_limits<IntegralT>::max() || result < std::numeric_limits<IntegralT>::lowest();
+				else
+					overflow = result < 0 || static_cast<std::uint64_t>(result) > std::numeric_limits<IntegralT>::max();
+				if (overflow)
+					fail(parse_errc::out_of_range);
+				else
+					value = static_cast<IntegralT>(result);
+			}
+			else if (is<unsigned_token>())
+			{
+				auto result = m_current.get<unsigned_token>().value;
+				if (result > static_cast<std::make_unsigned_t<IntegralT>>(std::numeric_limits<IntegralT>::max()))
+					fail(parse_errc::out_of_range);
+				else
+					value = static_cast<IntegralT>(result);
+			}
+			else
+				fail(parse_errc::unexpected_token);
+		}
+		template <typename FloatT>
+		void read_float(FloatT& value)
+		{
+			double result;
+			if (is<numeric_token>())
+				result = m_current.get<numeric_token>().value;
+			else if (is<integral_token>())
+				result = m_current.get<integral_token>().as_double();
+			else if (is<unsigned_token>())
+				result = m_current.get<unsigned_token>().value;
+			else
+			{
+				fail(parse_errc::unexpected_token);
+				return;
+			}
+			if (result > std::numeric_limits<FloatT>::max() || result < std::numeric_limits<FloatT>::lowest())
+				fail(parse_errc::out_of_range);
+			else
+				value = result;
+		}
+		template <typename ValueT, typename FuncT>
+		void read_object(ValueT& value, FuncT func)
+		{
+			if (!is<open_brace_token>())
+			{
+				fail(parse_errc::unexpected_token);
+				return;
+			}
+			if (!read() || is<close_brace_token>())
+				return;
+			for (bool more = true; more; )
+			{
+				if (!is<string_view_token>())
+				{
+					fail(parse_errc::unexpected_token);
+					return;
+				}
+				/* the name may live in the scratch buffer of the tokenizer, overwritten by the value */
+				auto name = m_current.get<string_view_token>().value;
+				if (!m_tokenizer.is_persistent(name))
+					name = m_name.assign(name);
+				if (!read_property_name())
+					return;
+				func(value, name);
+				if (m_error || !read_separator(more))
+					return;
+			}
+			if (!is<close_brace_token>())
+				fail(parse_errc::unexpected_token);
+		}
+		template <typename ValueT>
+		void read_array(ValueT& value)
+		{
+			if (!is<open_bracket_token>())
+			{
+				fail(parse_errc::unexpected_token);
+				return;
+			}
+			if (!read() || is<close_bracket_token>())
+				return;
+			for (bool more = true; more; )
+			{
+				value.emplace_back();
+				deserialize(value.back());
+				if (m_error || !read_separator(more))
+					return;
+			}
+			if (!is<close_bracket_token>())
+				fail(parse_errc::unexpected_token);
+		}
+	public:
+		checked_deserializer(std::string_view buffer)
+		: m_tokenizer(buffer), m_current(), m_error(), m_name(), m_nesting()
+		{}
+		/**
+		 * \brief deserialize from another buffer, keeping the scratch buffers
+		 */
+		void reset(std::string_view buffer)
+		{
+			m_tokenizer.reset(buffer);
+			m_error.reset();
+		}
+		/**
+		 * \brief deserialize the next value of the buffer
+		 * \remark on error, value may be partially deserialized
+		 */
+		template <typename ValueT>
+		corecpp::expected<void, parse_error> try_deserialize(ValueT& value)
+		{
+			if (read())
+				deserialize(value);
+			if (m_error)
+				return *m_error;
+			return {};
+		}
+		/**
+		 * \brief check nothing but blanks follows the values deserialized so far
+		 */
+		corecpp::expected<void, parse_error> try_end()
+		{
+			if (m_error)
+				return *m_error;
+			token tk;
+			switch (m_tokenizer.try_next(tk))
+			{
+				case token_status::end:
+					return {};
+				case token_status::invalid:
+					return m_tokenizer.error();
+				case token_status::need_more:
+					return parse_error { parse_errc::truncated, m_tokenizer.offset() };
+				case token_status::ready:
+				default:
+					return parse_error { parse_errc::unexpected_token, m_tokenizer.offset() };
+			}
+		}
+		/**
+		 * \brief deserialize the value starting at the current token, if no error occured
+		 * \remark called by the properties, use try_deserialize to get the error
+		 */
+		template <typename ValueT>
+		void deserialize(ValueT& value)
+		{
+			static_assert(!is_associative<ValueT>::value, "associative arrays are not supported by checked_deserializer");
+			if (m_error)
+				return;
+			if constexpr (std::is_same_v<ValueT, bool>)
+			{
+				if (is<true_token>() || is<false_token>())
+					value = is<true_token>();
+				else
+					fail(parse_errc::unexpected_token);
+			}
+			else if constexpr (std::is_enum_v<ValueT>)
+			{
+				std::underlying_type_t<ValueT> underlying {};
+				read_integral(underlying);
+				if (!m_error)
+					value = static_cast<ValueT>(underlying);
+			}
+			else if constexpr (std::is_integral_v<ValueT>)
+				read_integral(value);
+			else if constexpr (std::is_floating_point_v<ValueT>)
+				read_float(value);
+			else if constexpr (std::is_same_v<ValueT, std::string>)
+			{
+				if (is<string_view_token>())
+					value.assign(m_current.get<string_view_token>().value);
+				else
+					fail(parse_errc::unexpected_token);
+			}
+			else if constexpr (is_property_deserializable<ValueT, checked_deserializer, std::string_view>::value)
+				read_object(value, [this](ValueT& v, std::string_view name) { v.deserialize(*this, name); });
+			else if constexpr (is_iterable<ValueT>::value)
+				read_array(value);
+			else
+			{
+				const auto& properties = ValueT::properties();
+				read_object(value, [this, &properties](ValueT& v, std::string_view name) {
+					if (!corecpp::details::deserialize_property(*this, v, properties, name))
+						skip_value();
+				});
+			}
+		}
+	};
+
+	/**
+	 * \brief deserialize the json held in buffer into value, without any exception
+	 */
+	template <typename ValueT>
+	corecpp::expected<void, parse_error> try_deserialize(std::string_view buffer, ValueT& value)
+	{
+		checked_deserializer deserializer { buffer };
+		auto result = deserializer.try_deserialize(value);
+		if (!result)
+			return result;
+		return deserializer.try_end();
+	}
+}
+
+#endif
@@ -0,0 +1,226 @@
+#ifndef CORECPP_JSON_TOKENIZER_H
+#define CORECPP_JSON_TOKENIZER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include <corecpp/variant.h>
+
+namespace corecpp::json
+{
+	struct open_brace_token
+	{};
+
+	struct close_brace_token
+	{};
+
+	struct open_bracket_token
+	{};
+
+	struct close_bracket_token
+	{};
+
+	struct comma_token
+	{};
+
+	struct dot_token
+	{};
+
+	struct colon_token
+	{};
+
+	struct string_token
+	{
+		std::wstring value;
+	};
+
+	/**
+	 * \brief utf-8 string literal produced by the buffer-based tokenizers
+	 * \remark value either points into the input buffer (when the literal holds no escape sequence)
+	 * or into the tokenizer's scratch buffer. In both case it is only valid until the next token is read.
+	 */
+	struct string_view_token
+	{
+		std::string_view value;
+	};
+
+	struct numeric_token
+	{
+		double value;
+	};
+
+	struct integral_token
+	{
+		std::int64_t value;
+		bool negative = false; /* the literal has a minus sign, which only matters for -0 */
+		/**
+		 * \brief value as a floating point number, keeping the sign of -0
+		 */
+		double as_double() const noexcept
+		{
+			return (negative && !value) ? -0.0 : static_cast<double>(value);
+		}
+	};
+
+	/**
+	 * \brief integral literal above the range of integral_token
+	 */
+	struct unsigned_token
+	{
+		std::uint64_t value;
+	};
+
+	struct null_token
+	{};
+
+	struct true_token
+	{};
+
+	struct false_token
+	{};
+
+	using token = corecpp::variant<open_brace_token, close_brace_token, open_bracket_token, close_bracket_token,
+		comma_token, dot_token, colon_token,
+		string_token, string_view_token, numeric_token, integral_token, unsigned_token,
+		null_token, true_token, false_token>;
+
+	std::string to_string(const token& tk);
+
+	/**
+	 * \brief result of an attempt to extract a token
+	 */
+	enum struct token_status
+	{
+		ready = 0,     /* a token has been extracted */
+		need_more = 1, /* the input ends with an incomplete token, nothing has been consumed */
+		end = 2,       /* there is no more token to read */
+		invalid = 3    /* the input is not valid json, only returned by buffer_tokenizer::try_next */
+	};
+
+	/**
+	 * \brief kind of a parse_error
+	 */
+	enum struct parse_errc : std::uint8_t
+	{
+		unexpected_character = 1, /* a char which can not start any token */
+		invalid_escape,           /* invalid escape sequence in a string */
+		control_character,        /* unescaped control character in a string */
+		invalid_number,
+		truncated,                /* the input ends in the middle of a value */
+		unexpected_token,         /* a valid token, not allowed at this place or by the target type */
+		out_of_range,             /* a number which does not fit in the target type */
+		unpaired_surrogate        /* an escaped utf-16 surrogate which is not part of a pair */
+	};
+
+	/**
+	 * \brief error reported by the non-throwing parsing functions
+	 * \remark it only holds a code and an offset, the message is built on demand
+	 */
+	struct parse_error
+	{
+		parse_errc code;
+		std::size_t offset; /* offset of the invalid char, or past the unexpected token */
+
+		std::string message() const;
+	};
+
+	/**
+	 * \brief encoding of the string tokens produced by a tokenizer
+	 */
+	enum struct encoding
+	{
+		wide = 0, /* string_token, holding a std::wstring */
+		utf8 = 1  /* string_view_token, holding the utf-8 bytes */
+	};
+
+	/**
+	 * \brief tokenizer working directly on a contiguous buffer (std::string, mmap'd file, ...)
+	 * \remark the buffer must outlive the tokenizer. String literals are returned as string_view_token,
+	 * pointing into the buffer itself unless they contain escape sequences.
+	 */
+	class buffer_tokenizer
+	{
+		const char* m_begin;
+		const char* m_current;
+		const char* m_end;
+		std::string m_literal; /* scratch buffer used to unescape string literals */
+		parse_error m_error; /* why the last call to try_next returned token_status::invalid */
+
+		token_status fail(parse_errc code, const char* pos) noexcept
+		{
+			m_error = parse_error { code, static_cast<std::size_t>(pos - m_begin) };
+			return token_status::invalid;
+		}
+		token_status read_escape_sequence(const char*& pos);
+		token_status read_string_literal(token& tk);
+		token_status read_numeric_literal(const char* start, token& tk);
+		token_status read_keyword(const char* start, std::string_view keyword);
+	public:
+		buffer_tokenizer(std::string_view buffer) noexcept
+		: m_begin(buffer.data()), m_current(buffer.data()), m_end(buffer.data() + buffer.size()), m_literal(), m_error()
+		{}
+		buffer_tokenizer(const char* data, std::size_t size) noexcept
+		: buffer_tokenizer(std::string_view { data, size })
+		{}
+		/**
+		 * \brief extract the next token into tk
+		 * \return token_status::ready if tk holds the next token. Otherwise tk is left untouched and the status tells
+		 * whether the buffer ends with an incomplete token or has no more token.
+		 * \throw corecpp::lexical_error or corecpp::syntax_error if the input is not valid json
+		 */
+		token_status next(token& tk);
+		/**
+		 * \brief extract the next token into tk, without throwing on invalid input
+		 * \return the same statuses as next, or token_status::invalid, error() telling why
+		 */
+		token_status try_next(token& tk);
+		/**
+		 * \brief error met by the last call to try_next which returned token_status::invalid
+		 */
+		const parse_error& error() const noexcept
+		{
+			return m_error;
+		}
+		/**
+		 * \brief tells if the value of a string_view_token stays valid once the next token is read
+		 * \remark this is the case when it points into the input buffer rather than into the scratch buffer
+		 */
+		bool is_persistent(std::string_view str) const noexcept
+		{
+			return str.data() >= m_begin && str.data() < m_end;
+		}
+		/**
+		 * \brief offset of the next unread char, from the begining of the buffer
+		 */
+		std::size_t offset() const noexcept
+		{
+			return m_current - m_begin;
+		}
+		/**
+		 * \brief move to the given offset, from the begining of the buffer
+		 */
+		void seek(std::size_t offset) noexcept
+		{
+			m_current = m_begin + offset;
+		}
+		/**
+		 * \brief tokenize another buffer, keeping the scratch buffer
+		 */
+		void reset(std::string_view buffer) noexcept
+		{
+			m_begin = m_current = buffer.data();
+			m_end = buffer.data() + buffer.size();
+		}
+		/**
+		 * \brief get the unread chars
+		 */
+		std::string_view reminder() const noexcept
+		{
+			return { m_current, static_cast<std::size_t>(m_end - m_current) };
+		}
+	};
+}
+
+#endif
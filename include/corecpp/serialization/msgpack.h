@@ -0,0 +1,616 @@
+#ifndef CORECPP_MSGPACK_H
+#define CORECPP_MSGPACK_H
+
+#include <codecvt>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <locale>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include <stdexcept>
+
+#include <corecpp/algorithm.h>
+#include <corecpp/except.h>
+#include <corecpp/serialization/common.h>
+#include <corecpp/serialization/sink.h>
+
+namespace corecpp::msgpack
+{
+	/**
+	 * \brief first bytes of the MessagePack formats
+	 */
+	namespace format
+	{
+		constexpr std::uint8_t positive_fixint = 0x00; /* 0xxxxxxx */
+		constexpr std::uint8_t fixmap = 0x80;          /* 1000xxxx */
+		constexpr std::uint8_t fixarray = 0x90;        /* 1001xxxx */
+		constexpr std::uint8_t fixstr = 0xa0;          /* 101xxxxx */
+		constexpr std::uint8_t nil = 0xc0;
+		constexpr std::uint8_t false_ = 0xc2;
+		constexpr std::uint8_t true_ = 0xc3;
+		constexpr std::uint8_t bin8 = 0xc4;
+		constexpr std::uint8_t bin16 = 0xc5;
+		constexpr std::uint8_t bin32 = 0xc6;
+		constexpr std::uint8_t ext8 = 0xc7;
+		constexpr std::uint8_t ext16 = 0xc8;
+		constexpr std::uint8_t ext32 = 0xc9;
+		constexpr std::uint8_t float32 = 0xca;
+		constexpr std::uint8_t float64 = 0xcb;
+		constexpr std::uint8_t uint8 = 0xcc;
+		constexpr std::uint8_t uint16 = 0xcd;
+		constexpr std::uint8_t uint32 = 0xce;
+		constexpr std::uint8_t uint64 = 0xcf;
+		constexpr std::uint8_t int8 = 0xd0;
+		constexpr std::uint8_t int16 = 0xd1;
+		constexpr std::uint8_t int32 = 0xd2;
+		constexpr std::uint8_t int64 = 0xd3;
+		constexpr std::uint8_t fixext1 = 0xd4;
+		constexpr std::uint8_t fixext16 = 0xd8;
+		constexpr std::uint8_t str8 = 0xd9;
+		constexpr std::uint8_t str16 = 0xda;
+		constexpr std::uint8_t str32 = 0xdb;
+		constexpr std::uint8_t array16 = 0xdc;
+		constexpr std::uint8_t array32 = 0xdd;
+		constexpr std::uint8_t map16 = 0xde;
+		constexpr std::uint8_t map32 = 0xdf;
+		constexpr std::uint8_t negative_fixint = 0xe0; /* 111xxxxx */
+	}
+
+	/**
+	 * \brief MessagePack serializer, writing to any output sink (see corecpp/serialization/sink.h)
+	 * \remark integers are written in their smallest format. The objects of the types with properties() are maps
+	 * keyed by the property names, written at once. The objects whose number of properties is only known at their
+	 * end (custom serialize methods, optional values...) are first written to a scratch buffer, reused from one
+	 * object to the next.
+	 */
+	template <typename SinkT>
+	class basic_serializer
+	{
+		/* object being written, whose map header is written once its properties are counted */
+		struct pending_object
+		{
+			std::string body;
+			std::size_t size;
+		};
+		SinkT m_sink;
+		std::vector<pending_object> m_pending;
+		std::size_t m_depth; /* number of pending objects, the last one receiving the output */
+
+		void put(std::uint8_t c)
+		{
+			if (m_depth)
+				m_pending[m_depth - 1].body.push_back(static_cast<char>(c));
+			else
+				m_sink.put(static_cast<char>(c));
+		}
+		void write(const char* data, std::size_t size)
+		{
+			if (m_depth)
+				m_pending[m_depth - 1].body.append(data, size);
+			else
+				m_sink.write(data, size);
+		}
+		/* write marker followed by the big endian bytes of value */
+		template <typename UnsignedT>
+		void write_header(std::uint8_t marker, UnsignedT value)
+		{
+			char buffer[1 + sizeof(UnsignedT)];
+			buffer[0] = static_cast<char>(marker);
+			for (std::size_t i = 0; i < sizeof(UnsignedT); ++i)
+				buffer[1 + i] = static_cast<char>(value >> (8 * (sizeof(UnsignedT) - 1 - i)));
+			write(buffer, sizeof(buffer));
+		}
+		void write_unsigned(std::uint64_t value)
+		{
+			if (value < 0x80)
+				put(static_cast<std::uint8_t>(value));
+			else if (value <= std::numeric_limits<std::uint8_t>::max())
+				write_header(format::uint8, static_cast<std::uint8_t>(value));
+			else if (value <= std::numeric_limits<std::uint16_t>::max())
+				write_header(format::uint16, static_cast<std::uint16_t>(value));
+			else if (value <= std::numeric_limits<std::uint32_t>::max())
+				write_header(format::uint32, static_cast<std::uint32_t>(value));
+			else
+				write_header(format::uint64, value);
+		}
+		void write_signed(std::int64_t value)
+		{
+			if (value >= 0)
+				write_unsigned(static_cast<std::uint64_t>(value));
+			else if (value >= -32)
+				put(static_cast<std::uint8_t>(value));
+			else if (value >= std::numeric_limits<std::int8_t>::lowest())
+				write_header(format::int8, static_cast<std::uint8_t>(value));
+			else if (value >= std::numeric_limits<std::int16_t>::lowest())
+				write_header(format::int16, static_cast<std::uint16_t>(value));
+			else if (value >= std::numeric_limits<std::int32_t>::lowest())
+				write_header(format::int32, static_cast<std::uint32_t>(value));
+			else
+				write_header(format::int64, static_cast<std::uint64_t>(value));
+		}
+		void write_size(std::uint8_t fix, std::size_t fix_limit, std::uint8_t marker8, std::uint8_t marker16,
+			std::uint8_t marker32, std::size_t size)
+		{
+			if (size < fix_limit)
+				put(static_cast<std::uint8_t>(fix | size));
+			else if (marker8 && size <= std::numeric_limits<std::uint8_t>::max())
+				write_header(marker8, static_cast<std::uint8_t>(size));
+			else if (size <= std::numeric_limits<std::uint16_t>::max())
+				write_header(marker16, static_cast<std::uint16_t>(size));
+			else if (size <= std::numeric_limits<std::uint32_t>::max())
+				write_header(marker32, static_cast<std::uint32_t>(size));
+			else
+				corecpp::throws<std::length_error>("too many elements for a MessagePack container");
+		}
+		void write_string(std::string_view value)
+		{
+			write_size(format::fixstr, 32, format::str8, format::str16, format::str32, value.size());
+			write(value.data(), value.size());
+		}
+		void write_array_header(std::size_t size)
+		{
+			write_size(format::fixarray, 16, 0, format::array16, format::array32, size);
+		}
+		void write_map_header(std::size_t size)
+		{
+			write_size(format::fixmap, 16, 0, format::map16, format::map32, size);
+		}
+		template <typename StringT>
+		void write_key(const StringT& name)
+		{
+			if constexpr (std::is_convertible_v<const StringT&, std::string_view>)
+				write_string(name);
+			else
+				serialize(name);
+		}
+		/* property names of ValueT, encoded once for all */
+		template <typename ValueT, typename PropertiesT>
+		static const std::vector<std::string>& property_keys(const PropertiesT& properties)
+		{
+			static const std::vector<std::string> keys = [&properties] {
+				std::vector<std::string> result;
+				tuple_foreach([&result](const auto& prop) {
+					std::string key;
+					basic_serializer<string_sink> s { string_sink { key } };
+					s.write_string(prop.utf8_name());
+					result.push_back(std::move(key));
+				}, properties);
+				return result;
+			}();
+			return keys;
+		}
+		template <typename> friend class basic_serializer;
+	public:
+		basic_serializer(SinkT sink)
+		: m_sink { std::move(sink) }, m_pending {}, m_depth { 0 }
+		{}
+		SinkT& sink()
+		{
+			return m_sink;
+		}
+		/**
+		 * \brief push the bytes buffered by the sink to their final destination
+		 */
+		void flush()
+		{
+			m_sink.flush();
+		}
+		void serialize(bool value)
+		{
+			put(value ? format::true_ : format::false_);
+		}
+		void serialize(int8_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int16_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int32_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(int64_t value)
+		{
+			write_signed(value);
+		}
+		void serialize(uint8_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(uint16_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(char16_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(uint32_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(uint64_t value)
+		{
+			write_unsigned(value);
+		}
+		void serialize(char value)
+		{
+			write_signed(value);
+		}
+		void serialize(std::nullptr_t)
+		{
+			put(format::nil);
+		}
+		void serialize(float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write_header(format::float32, bits);
+		}
+		void serialize(double value)
+		{
+			std::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write_header(format::float64, bits);
+		}
+		void serialize(const char* value)
+		{
+			write_string(value);
+		}
+		void serialize(const wchar_t* value)
+		{
+			serialize(std::wstring { value });
+		}
+		void serialize(const std::string& value)
+		{
+			write_string(value);
+		}
+		void serialize(std::string_view value)
+		{
+			write_string(value);
+		}
+		void serialize(const std::wstring& value)
+		{
+			write_string(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(value));
+		}
+		void serialize(const std::u16string& value)
+		{
+			write_string(std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>().to_bytes(value));
+		}
+		void serialize(const std::u32string& value)
+		{
+			write_string(std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>().to_bytes(value));
+		}
+		template <typename ValueT, typename Enable = void>
+		void serialize(ValueT&& value)
+		{
+			serialize_impl<basic_serializer, ValueT> impl;
+			impl(*this, std::forward<ValueT>(value));
+		}
+
+		/* "Low level" methods */
+		/**
+		 * \brief begin an object whose properties are given by write_property
+		 */
+		template <typename ValueT>
+		void begin_object()
+		{
+			if (m_depth == m_pending.size())
+				m_pending.emplace_back();
+			m_pending[m_depth].body.clear();
+			m_pending[m_depth].size = 0;
+			++m_depth;
+		}
+		void end_object()
+		{
+			auto& object = m_pending[--m_depth];
+			write_map_header(object.size);
+			write(object.body.data(), object.body.size());
+		}
+		template <typename StringT, typename ValueT>
+		void write_property(const StringT& name, ValueT&& value)
+		{
+			++m_pending[m_depth - 1].size;
+			write_key(name);
+			serialize(std::forward<ValueT>(value));
+		}
+		template <typename StringT, typename FuncT>
+		void write_property_cb(const StringT& name, FuncT func)
+		{
+			++m_pending[m_depth - 1].size;
+			write_key(name);
+			func();
+		}
+		template <typename ValueT, typename PropertiesT>
+		void write_object(ValueT&& value, const PropertiesT& properties)
+		{
+			const auto& keys = property_keys<std::decay_t<ValueT>>(properties);
+			auto key = keys.begin();
+			write_map_header(keys.size());
+			tuple_foreach([&](const auto& prop) {
+				write(key->data(), key->size());
+				++key;
+				this->serialize(prop.cget(value));
+			}, properties);
+		}
+		template <typename ValueT, typename FuncT>
+		void write_object_cb(ValueT&& value, FuncT func)
+		{
+			begin_object<ValueT>();
+			func(std::forward<ValueT>(value));
+			end_object();
+		}
+		template <typename ValueT>
+		void write_array(ValueT&& value)
+		{
+			write_array_header(std::distance(std::cbegin(value), std::cend(value)));
+			for (const auto& element : value)
+				serialize(element);
+		}
+		/**
+		 * \brief write an associative array as a map
+		 */
+		template <typename ValueT>
+		void write_associative_array(ValueT&& value)
+		{
+			write_map_header(value.size());
+			for (const auto& element : value)
+			{
+				serialize(element.first);
+				serialize(element.second);
+			}
+		}
+	};
+	using serializer = basic_serializer<ostream_sink>;
+
+
+	/**
+	* \brief class used to deserialize MessagePack held in a contiguous buffer
+	* \remark the buffer is read in place, so it must outlive the deserializer.
+	* Malformed or truncated input throws corecpp::syntax_error, integers out of the range of their target std::overflow_error.
+	* \implements deserializer concept
+	*/
+	class deserializer
+	{
+		const char* m_begin;
+		const char* m_current;
+		const char* m_end;
+		std::vector<std::size_t> m_remaining; /* properties left in the objects begun with begin_object */
+
+		std::uint8_t read_byte();
+		const char* read_bytes(std::size_t size);
+		template <typename UnsignedT>
+		UnsignedT read_big_endian()
+		{
+			const char* bytes = read_bytes(sizeof(UnsignedT));
+			UnsignedT value = 0;
+			for (std::size_t i = 0; i < sizeof(UnsignedT); ++i)
+				value = static_cast<UnsignedT>((value << 8) | static_cast<std::uint8_t>(bytes[i]));
+			return value;
+		}
+		[[ noreturn ]] void unexpected(const char* expected, std::uint8_t marker) const;
+		/* read an integer: true if it is an unsigned one, held by unsigned_value, false if held by signed_value */
+		bool read_integer(std::int64_t& signed_value, std::uint64_t& unsigned_value);
+		double read_float();
+		std::string_view read_string();
+		std::size_t read_array_header();
+		std::size_t read_map_header();
+		void skip_value();
+
+		template<typename IntegralT>
+		void deserialize_integral(IntegralT& value)
+		{
+			std::int64_t signed_value;
+			std::uint64_t unsigned_value;
+			if (read_integer(signed_value, unsigned_value))
+			{
+				if (unsigned_value > static_cast<std::make_unsigned_t<IntegralT>>(std::numeric_limits<IntegralT>::max()))
+					corecpp::throws<std::overflow_error>(std::to_string(unsigned_value));
+				value = static_cast<IntegralT>(unsigned_value);
+			}
+			else
+			{
+				bool overflow;
+				if constexpr (std::is_signed_v<IntegralT>)
+					overflow = signed_value > std::numeric_limits<IntegralT>::max() || signed_value < std::numeric_limits<IntegralT>::lowest();
+				else
+					overflow = signed_value < 0 || static_cast<std::uint64_t>(signed_value) > std::numeric_limits<IntegralT>::max();
+				if (overflow)
+					corecpp::throws<std::overflow_error>(std::to_string(signed_value));
+				value = static_cast<IntegralT>(signed_value);
+			}
+		}
+		template<typename FloatT>
+		void deserialize_float(FloatT& value)
+		{
+			double result = read_float();
+			if (result > std::numeric_limits<FloatT>::max() || result < std::numeric_limits<FloatT>::lowest())
+				corecpp::throws<std::overflow_error>(std::to_string(result));
+			value = static_cast<FloatT>(result);
+		}
+		/* call func with the property name, in the first form it accepts */
+		template <typename FuncT>
+		static void invoke_property(FuncT& func, std::string_view name)
+		{
+			if constexpr (std::is_invocable_v<FuncT&, std::string_view>)
+				func(name);
+			else if constexpr (std::is_invocable_v<FuncT&, const std::string&>)
+				func(std::string { name });
+			else
+				func(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(name.data(), name.data() + name.size()));
+		}
+	public:
+		deserializer(std::string_view buffer)
+		: m_begin(buffer.data()), m_current(buffer.data()), m_end(buffer.data() + buffer.size()), m_remaining()
+		{}
+		deserializer(const char* data, std::size_t size)
+		: deserializer(std::string_view { data, size })
+		{}
+		/**
+		 * \brief deserialize from another buffer, keeping the scratch buffers
+		 */
+		void reset(std::string_view buffer) noexcept
+		{
+			m_begin = m_current = buffer.data();
+			m_end = buffer.data() + buffer.size();
+			m_remaining.clear();
+		}
+		/**
+		 * \brief offset of the next unread byte, from the begining of the buffer
+		 */
+		std::size_t offset() const noexcept
+		{
+			return m_current - m_begin;
+		}
+		/**
+		 * \brief tells if the whole buffer has been read
+		 */
+		bool at_end() const noexcept
+		{
+			return m_current == m_end;
+		}
+
+		void deserialize(bool& value);
+		void deserialize(int8_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int32_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(int64_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint8_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint32_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(uint64_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(char& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(char16_t& value)
+		{
+			deserialize_integral(value);
+		}
+		void deserialize(std::nullptr_t);
+		void deserialize(float& value)
+		{
+			deserialize_float(value);
+		}
+		void deserialize(double& value)
+		{
+			deserialize_float(value);
+		}
+		void deserialize(std::string& value)
+		{
+			value.assign(read_string());
+		}
+		void deserialize(std::wstring& value);
+		void deserialize(std::u16string& value);
+		void deserialize(std::u32string& value);
+		template <typename ValueT, typename Enable = void>
+		void deserialize(ValueT& value)
+		{
+			deserialize_impl<deserializer, ValueT> impl;
+			impl(*this, value);
+		}
+
+		/* "Low level" methods */
+		template <typename ValueT>
+		void begin_object()
+		{
+			m_remaining.push_back(read_map_header());
+		}
+		void end_object();
+		template <typename FuncT>
+		void read_property_cb(FuncT func)
+		{
+			if (m_remaining.empty() || !m_remaining.back())
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "no more property at offset ", std::to_string(offset()) }));
+			--m_remaining.back();
+			invoke_property(func, read_string());
+		}
+		template <typename ValueT>
+		void read_object(ValueT& value)
+		{
+			for (std::size_t size = read_map_header(); size; --size)
+			{
+				/* give the property name to ValueT in the first form it supports */
+				std::string_view name = read_string();
+				if constexpr (is_property_deserializable<ValueT, deserializer, std::string_view>::value)
+					value.deserialize(*this, name);
+				else if constexpr (is_property_deserializable<ValueT, deserializer, const std::string&>::value)
+					value.deserialize(*this, std::string { name });
+				else
+					value.deserialize(*this, std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(name.data(), name.data() + name.size()));
+			}
+		}
+		/**
+		 * \remark unknown properties are skipped
+		 */
+		template <typename ValueT, typename PropertiesT>
+		void read_object(ValueT& value, const PropertiesT& properties)
+		{
+			for (std::size_t size = read_map_header(); size; --size)
+			{
+				if (!corecpp::details::deserialize_property(*this, value, properties, read_string()))
+					skip_value();
+			}
+		}
+		template <typename ValueT, typename FuncT>
+		void read_object_cb(FuncT func)
+		{
+			for (std::size_t size = read_map_header(); size; --size)
+				invoke_property(func, read_string());
+		}
+		template <typename ValueT>
+		void read_array(ValueT& value)
+		{
+			for (std::size_t size = read_array_header(); size; --size)
+			{
+				value.emplace_back();
+				deserialize(value.back());
+			}
+		}
+		template <typename ValueT>
+		void read_associative_array(ValueT& value)
+		{
+			for (std::size_t size = read_map_header(); size; --size)
+			{
+				typename ValueT::key_type key;
+				typename ValueT::mapped_type mapped;
+				deserialize(key);
+				deserialize(mapped);
+				value.emplace(std::move(key), std::move(mapped));
+			}
+		}
+	};
+}
+
+#endif
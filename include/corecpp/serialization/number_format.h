@@ -0,0 +1,41 @@
+#ifndef CORECPP_SERIALIZATION_NUMBER_FORMAT_H
+#define CORECPP_SERIALIZATION_NUMBER_FORMAT_H
+
+#include <charconv>
+#include <cstddef>
+#include <type_traits>
+
+namespace corecpp
+{
+	/**
+	 * \brief size of a buffer large enough for any number written by format_number
+	 */
+	constexpr std::size_t number_buffer_size = 32;
+
+	/**
+	 * \brief write the decimal representation of value at first, without any allocation
+	 * \return a pointer past the last written char
+	 * \remark first must point to at least number_buffer_size chars
+	 */
+	template <typename IntegralT, typename = std::enable_if_t<std::is_integral<IntegralT>::value>>
+	char* format_number(char* first, IntegralT value) noexcept
+	{
+		return std::to_chars(first, first + number_buffer_size, value).ptr;
+	}
+
+	/**
+	 * \brief write the shortest representation of value which reads back to the same value
+	 * \return a pointer past the last written char
+	 * \remark first must point to at least number_buffer_size chars
+	 */
+	inline char* format_number(char* first, double value) noexcept
+	{
+		return std::to_chars(first, first + number_buffer_size, value).ptr;
+	}
+	inline char* format_number(char* first, float value) noexcept
+	{
+		return std::to_chars(first, first + number_buffer_size, value).ptr;
+	}
+}
+
+#endif
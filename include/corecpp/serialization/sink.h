@@ -0,0 +1,176 @@
+#ifndef CORECPP_SERIALIZATION_SINK_H
+#define CORECPP_SERIALIZATION_SINK_H
+
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <corecpp/except.h>
+
+namespace corecpp
+{
+	/*
+	 * OUTPUT SINKS
+	 * A sink is where a serializer writes its output. A sink provides the following methods:
+	 *  - void put(char c) appends a char
+	 *  - void write(const char* data, std::size_t size) appends a block of chars
+	 *  - void flush() pushes the buffered chars, if any, to their final destination
+	 */
+
+	/**
+	 * \brief sink appending to a growable container of chars (std::string or std::vector<char>)
+	 */
+	template <typename ContainerT>
+	class container_sink
+	{
+		ContainerT& m_container;
+	public:
+		container_sink(ContainerT& container)
+		: m_container(container)
+		{}
+		void put(char c)
+		{
+			m_container.push_back(c);
+		}
+		void write(const char* data, std::size_t size)
+		{
+			m_container.insert(m_container.end(), data, data + size);
+		}
+		void flush()
+		{}
+		ContainerT& container()
+		{
+			return m_container;
+		}
+	};
+	using string_sink = container_sink<std::string>;
+	using vector_sink = container_sink<std::vector<char>>;
+
+	/**
+	 * \brief sink writing into a fixed buffer provided by the caller
+	 * \remark writing past the end of the buffer throws std::length_error
+	 */
+	class buffer_sink
+	{
+		char* m_begin;
+		char* m_current;
+		char* m_end;
+		/* out of line, so that the inline code does not throw */
+		[[ noreturn ]] static void overflow();
+	public:
+		buffer_sink(char* data, std::size_t size)
+		: m_begin(data), m_current(data), m_end(data + size)
+		{}
+		void put(char c)
+		{
+			if (m_current == m_end)
+				overflow();
+			*m_current++ = c;
+		}
+		void write(const char* data, std::size_t size)
+		{
+			if (static_cast<std::size_t>(m_end - m_current) < size)
+				overflow();
+			std::memcpy(m_current, data, size);
+			m_current += size;
+		}
+		void flush()
+		{}
+		/**
+		 * \brief number of chars written so far
+		 */
+		std::size_t size() const noexcept
+		{
+			return m_current - m_begin;
+		}
+		std::string_view view() const noexcept
+		{
+			return std::string_view { m_begin, size() };
+		}
+	};
+
+	/**
+	 * \brief sink writing to the streambuf of a std::ostream, without the sentry and locale costs of the stream operators
+	 * \remark the badbit of the stream is set when its streambuf fails
+	 */
+	class ostream_sink
+	{
+		std::ostream& m_stream;
+		std::streambuf* m_buffer;
+	public:
+		ostream_sink(std::ostream& stream)
+		: m_stream(stream), m_buffer(stream.rdbuf())
+		{}
+		void put(char c)
+		{
+			if (m_buffer->sputc(c) == std::streambuf::traits_type::eof())
+				m_stream.setstate(std::ios_base::badbit);
+		}
+		void write(const char* data, std::size_t size)
+		{
+			if (m_buffer->sputn(data, size) != static_cast<std::streamsize>(size))
+				m_stream.setstate(std::ios_base::badbit);
+		}
+		void flush()
+		{
+			m_stream.flush();
+		}
+	};
+
+	/**
+	 * \brief sink writing to a file descriptor
+	 * \remark chars are gathered in a large buffer, written with write(2), or along with the next block with writev(2)
+	 * when that block does not fit. The remaining chars are written when the sink is destroyed.
+	 * Failures throw std::system_error.
+	 */
+	class fd_sink
+	{
+		int m_fd;
+		std::unique_ptr<char[]> m_buffer;
+		char* m_current;
+		char* m_end;
+		void write_through(const char* data, std::size_t size);
+		[[ noreturn ]] static void moved_from();
+	public:
+		static constexpr std::size_t default_capacity = 64 * 1024;
+		/**
+		 * \throw std::invalid_argument if capacity is 0
+		 */
+		explicit fd_sink(int fd, std::size_t capacity = default_capacity);
+		/**
+		 * \remark the moved-from sink can only be destroyed: using it throws std::logic_error
+		 */
+		fd_sink(fd_sink&& other) noexcept
+		: m_fd(other.m_fd), m_buffer(std::move(other.m_buffer)), m_current(other.m_current), m_end(other.m_end)
+		{
+			other.m_current = other.m_end = nullptr;
+		}
+		fd_sink(const fd_sink&) = delete;
+		~fd_sink();
+		void put(char c)
+		{
+			if (m_current == m_end)
+				flush();
+			*m_current++ = c;
+		}
+		void write(const char* data, std::size_t size)
+		{
+			if (static_cast<std::size_t>(m_end - m_current) >= size)
+			{
+				std::memcpy(m_current, data, size);
+				m_current += size;
+			}
+			else
+				write_through(data, size);
+		}
+		void flush();
+	};
+}
+
+#endif
@@ -10,6 +10,7 @@
 #include <optional>
 #include <sstream>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <vector>
 #include <stdexcept>
@@ -18,6 +19,8 @@
 #include <corecpp/diagnostic.h>
 #include <corecpp/variant.h>
 #include <corecpp/visibility.h>
+#include <corecpp/serialization/number_format.h>
+#include <corecpp/serialization/sink.h>
 #include <corecpp/except.h>
 #include <corecpp/serialization/common.h>
 
@@ -26,110 +29,174 @@ namespace corecpp::xml
 	_internal corecpp::diagnostic::event_producer& xml_logger();
 
 
-	class serializer
+	/**
+	 * \brief xml serializer, writing to any output sink (see corecpp/serialization/sink.h)
+	 */
+	template <typename SinkT>
+	class basic_serializer
 	{
-		std::ostream& m_stream;
+		SinkT m_sink;
 		bool m_use_attributes; //TODO
 		bool m_pretty;
 		bool m_started;
 		unsigned int m_indent_level;
-		void convert_and_escape(const std::string& value);
-		void convert_and_escape(const std::wstring& value);
-		void convert_and_escape(const std::u16string& value);
-		void convert_and_escape(const std::u32string& value);
+		template <std::size_t N>
+		void write_literal(const char (&str)[N])
+		{
+			m_sink.write(str, N - 1);
+		}
+		template <typename NumberT>
+		void write_number(NumberT value)
+		{
+			char buffer[number_buffer_size];
+			m_sink.write(buffer, format_number(buffer, value) - buffer);
+		}
+		void convert_and_escape(std::string_view value)
+		{
+			for (char c : value)
+			{
+				switch(c)
+				{
+					case '&':  write_literal("&amp;");       break;
+					case '\"': write_literal("&quot;");      break;
+					case '\'': write_literal("&apos;");      break;
+					case '<':  write_literal("&lt;");        break;
+					case '>':  write_literal("&gt;");        break;
+					default:   m_sink.put(c);   break;
+				}
+			}
+		}
+		void convert_and_escape(std::wstring_view value)
+		{
+			//TODO: utf8-encode
+			for (wchar_t c : value)
+			{
+				switch(c)
+				{
+					case '&':  write_literal("&amp;");       break;
+					case '\"': write_literal("&quot;");      break;
+					case '\'': write_literal("&apos;");      break;
+					case '<':  write_literal("&lt;");        break;
+					case '>':  write_literal("&gt;");        break;
+					default:   m_sink.put((char)c);   break;
+				}
+			}
+		}
+		void convert_and_escape(std::u16string_view)
+		{
+			//TODO
+		}
+		void convert_and_escape(std::u32string_view)
+		{
+			//TODO
+		}
 		void indent()
 		{
 			for (int i = 0; i < m_indent_level; ++i)
-				m_stream << "\t";
+				write_literal("\t");
 		}
 		void start_document()
 		{
-			m_stream << "<?xml version=\"1.0\" standalone=\"yes\" ?>";
+			write_literal("<?xml version=\"1.0\" standalone=\"yes\" ?>");
 			if (m_pretty)
-				m_stream << "\n";
-			m_stream << "<root>";
+				write_literal("\n");
+			write_literal("<root>");
 		}
 		void end_document()
 		{
-			m_stream << "</root>";
+			write_literal("</root>");
 		}
 		template<typename T>
 		void start_tag(T&& name)
 		{
-			m_stream << '<';
+			m_sink.put('<');
 			convert_and_escape(std::forward<T>(name));
-			m_stream << '>';
+			m_sink.put('>');
 		}
 		template<typename T>
 		void end_tag(T&& name)
 		{
-			m_stream << "</";
+			write_literal("</");
 			convert_and_escape(std::forward<T>(name));
-			m_stream << '>';
+			m_sink.put('>');
 		}
 	public:
-		serializer(std::ostream& s, bool use_attributes = true, bool pretty = false)
-		: m_stream { s }, m_use_attributes { use_attributes }, m_pretty { pretty }, m_started { false }, m_indent_level { 0 }
+		basic_serializer(SinkT sink, bool use_attributes = true, bool pretty = false)
+		: m_sink { std::move(sink) }, m_use_attributes { use_attributes }, m_pretty { pretty }, m_started { false }, m_indent_level { 0 }
 		{}
+		SinkT& sink()
+		{
+			return m_sink;
+		}
+		/**
+		 * \brief push the chars buffered by the sink to their final destination
+		 */
+		void flush()
+		{
+			m_sink.flush();
+		}
 		void serialize(bool value)
 		{
-			m_stream << (value ? "true" : "false");
+			if (value)
+				write_literal("true");
+			else
+				write_literal("false");
 		}
 		void serialize(int8_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(int16_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(int32_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(int64_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(uint8_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(uint16_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(char16_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(static_cast<std::uint_least16_t>(value));
 		}
 		void serialize(uint32_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(uint64_t value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(std::nullptr_t)
 		{
-			m_stream << "null";
+			write_literal("null");
 		}
 		void serialize(float value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(double value)
 		{
-			m_stream << std::to_string(value);
+			write_number(value);
 		}
 		void serialize(const char *value)
 		{
-			convert_and_escape(value);
+			convert_and_escape(std::string_view { value });
 		}
 		void serialize(const wchar_t *value)
 		{
-			convert_and_escape(value);
+			convert_and_escape(std::wstring_view { value });
 		}
 		/* TODO: Allows string to be r-value references
 		 */
@@ -158,7 +225,7 @@ namespace corecpp::xml
 				start_document();
 				started = m_started = true;
 			}
-			serialize_impl<serializer, ValueT> impl;
+			serialize_impl<basic_serializer, ValueT> impl;
 			impl(*this, std::forward<ValueT>(value));
 			if (started)
 			{
@@ -192,40 +259,40 @@ namespace corecpp::xml
 		template <typename ValueT>
 		void write_element(ValueT&& value)
 		{
-			m_stream << "<item>";
+			write_literal("<item>");
 			if (m_pretty)
 			{
 				m_indent_level++;
-				m_stream << "\n";
+				write_literal("\n");
 				indent();
 			}
 			serialize(std::forward<ValueT>(value));
 			if (m_pretty)
 			{
 				m_indent_level--;
-				m_stream << "\n";
+				write_literal("\n");
 				indent();
 			}
-			m_stream << "</item>";
+			write_literal("</item>");
 		}
 		template <typename ValueT>
 		void write_element(const ValueT& value)
 		{
-			m_stream << "<item>";
+			write_literal("<item>");
 			if (m_pretty)
 			{
 				m_indent_level++;
-				m_stream << "\n";
+				write_literal("\n");
 				indent();
 			}
 			serialize(value);
 			if (m_pretty)
 			{
 				m_indent_level--;
-				m_stream << "\n";
+				write_literal("\n");
 				indent();
 			}
-			m_stream << "</item>";
+			write_literal("</item>");
 		}
 
 		template <typename StringT, typename ValueT>
@@ -254,7 +321,7 @@ namespace corecpp::xml
 			tuple_foreach([&](const auto& prop) {
 				if (m_pretty)
 				{
-					m_stream << "\n";
+					write_literal("\n");
 					indent();
 				}
 				this->write_property(prop.name(), prop.cget(value));
@@ -264,7 +331,7 @@ namespace corecpp::xml
 			{
 				// set the position for next element
 				m_indent_level--;
-				m_stream << "\n";
+				write_literal("\n");
 				indent();
 			}
 		}
@@ -290,7 +357,7 @@ namespace corecpp::xml
 			{
 				if (m_pretty)
 				{
-					m_stream << "\n";
+					write_literal("\n");
 					indent();
 				}
 				write_element(*iter);
@@ -300,7 +367,7 @@ namespace corecpp::xml
 			{
 				// set the position for next element
 				m_indent_level--;
-				m_stream << "\n";
+				write_literal("\n");
 				indent();
 			}
 		}
@@ -319,29 +386,29 @@ namespace corecpp::xml
 				begin_object<typename std::decay_t<ValueT>::value_type>();
 				if (m_pretty)
 				{
-					m_stream << '\n';
+					m_sink.put('\n');
 					indent();
 					m_indent_level++;
 				}
-				m_stream << "<key>";
+				write_literal("<key>");
 				write_element<typename std::decay_t<ValueT>::key_type>(iter->first);
 				if (m_pretty)
 				{
-					m_stream << '\n';
+					m_sink.put('\n');
 					indent();
 				}
-				m_stream << "</key>";
+				write_literal("</key>");
 				if (m_pretty)
 				{
-					m_stream << '\n';
+					m_sink.put('\n');
 					indent();
 				}
-				m_stream << "<value>";
+				write_literal("<value>");
 				write_element<typename std::decay_t<ValueT>::mapped_type>(iter->second);
-				m_stream << "</value>";
+				write_literal("</value>");
 				if (m_pretty)
 				{
-					m_stream << '\n';
+					m_sink.put('\n');
 					indent();
 					m_indent_level--;
 				}
@@ -352,11 +419,12 @@ namespace corecpp::xml
 			{
 				// set the position for next element
 				m_indent_level--;
-				m_stream << "\n";
+				write_literal("\n");
 				indent();
 			}
 		}
 	};
+	using serializer = basic_serializer<ostream_sink>;
 }
 
 #endif
@@ -141,8 +141,8 @@ public:
 		{
 			if (m_type_index == other.m_type_index)
 			{
-				visit([this](const auto& value) {
-					using ValueT = std::remove_reference_t<decltype(value)>;
+				other.visit([this](const auto& value) {
+					using ValueT = std::remove_cv_t<std::remove_reference_t<decltype(value)>>;
 					get<ValueT>() = value;
 				});
 			}
@@ -182,7 +182,7 @@ public:
 		{
 			if (m_type_index == other.m_type_index)
 			{
-				visit([this](auto& value) {
+				other.visit([this](auto& value) {
 					using ValueT = std::remove_reference_t<decltype(value)>;
 					get<ValueT>() = std::move(value);
 				});
@@ -0,0 +1,342 @@
+#include <cmath>
+#include <codecvt>
+#include <cstring>
+#include <locale>
+
+#include <corecpp/serialization/cbor.h>
+
+
+namespace corecpp::cbor
+{
+
+std::uint8_t deserializer::read_byte()
+{
+	if (m_current == m_end)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(offset()) }));
+	return static_cast<std::uint8_t>(*m_current++);
+}
+
+const char* deserializer::read_bytes(std::uint64_t size)
+{
+	if (static_cast<std::uint64_t>(m_end - m_current) < size)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(offset()) }));
+	const char* bytes = m_current;
+	m_current += size;
+	return bytes;
+}
+
+void deserializer::unexpected(const char* expected, const head& h) const
+{
+	corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ expected, " expected, got major type ",
+		std::to_string(static_cast<int>(h.major)), " at offset ", std::to_string(h.offset) }));
+}
+
+deserializer::head deserializer::read_raw_head()
+{
+	head h;
+	h.offset = offset();
+	std::uint8_t initial = read_byte();
+	h.major = static_cast<major_type>(initial >> 5);
+	h.info = initial & 0x1f;
+	if (h.info < 24)
+		h.argument = h.info;
+	else if (h.info == 24)
+		h.argument = read_big_endian<std::uint8_t>();
+	else if (h.info == 25)
+		h.argument = read_big_endian<std::uint16_t>();
+	else if (h.info == 26)
+		h.argument = read_big_endian<std::uint32_t>();
+	else if (h.info == 27)
+		h.argument = read_big_endian<std::uint64_t>();
+	else if (h.info == indefinite_length
+		&& h.major != major_type::unsigned_integer && h.major != major_type::negative_integer && h.major != major_type::tag)
+		h.argument = 0;
+	else
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "invalid additional information at offset ", std::to_string(h.offset) }));
+	return h;
+}
+
+deserializer::head deserializer::read_head()
+{
+	head h = read_raw_head();
+	while (h.major == major_type::tag)
+		h = read_raw_head();
+	if (h.major == major_type::simple && h.info == indefinite_length)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "unexpected break at offset ", std::to_string(h.offset) }));
+	return h;
+}
+
+bool deserializer::at_break() const noexcept
+{
+	return m_current != m_end && static_cast<std::uint8_t>(*m_current) == break_code;
+}
+
+std::optional<std::uint64_t> deserializer::read_tag()
+{
+	if (m_current == m_end || static_cast<major_type>(static_cast<std::uint8_t>(*m_current) >> 5) != major_type::tag)
+		return std::nullopt;
+	return read_raw_head().argument;
+}
+
+bool deserializer::to_integer(const head& h, std::int64_t& signed_value, std::uint64_t& unsigned_value) const
+{
+	if (h.major == major_type::unsigned_integer)
+	{
+		unsigned_value = h.argument;
+		return true;
+	}
+	if (h.major != major_type::negative_integer)
+		unexpected("integer", h);
+	if (h.argument > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+		corecpp::throws<std::overflow_error>(corecpp::concat<std::string>({ "-1-", std::to_string(h.argument) }));
+	signed_value = -1 - static_cast<std::int64_t>(h.argument);
+	return false;
+}
+
+double deserializer::to_float(const head& h) const
+{
+	switch (h.major)
+	{
+		case major_type::unsigned_integer:
+			return static_cast<double>(h.argument);
+		case major_type::negative_integer:
+			return -1.0 - static_cast<double>(h.argument);
+		case major_type::simple:
+			break;
+		default:
+			unexpected("number", h);
+	}
+	if (h.info == simple::half_float)
+	{
+		/* RFC 8949, appendix D */
+		int exponent = (h.argument >> 10) & 0x1f;
+		int mantissa = h.argument & 0x3ff;
+		double value;
+		if (exponent == 0)
+			value = std::ldexp(mantissa, -24);
+		else if (exponent != 31)
+			value = std::ldexp(mantissa + 1024, exponent - 25);
+		else
+			value = mantissa == 0 ? std::numeric_limits<double>::infinity() : std::numeric_limits<double>::quiet_NaN();
+		return h.argument & 0x8000 ? -value : value;
+	}
+	if (h.info == simple::single_float)
+	{
+		std::uint32_t bits = static_cast<std::uint32_t>(h.argument);
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+	if (h.info == simple::double_float)
+	{
+		double value;
+		std::memcpy(&value, &h.argument, sizeof(value));
+		return value;
+	}
+	unexpected("number", h);
+}
+
+bool deserializer::read_integer(std::int64_t& signed_value, std::uint64_t& unsigned_value)
+{
+	return to_integer(read_head(), signed_value, unsigned_value);
+}
+
+std::string_view deserializer::read_string(major_type major, const char* expected)
+{
+	head h = read_head();
+	if (h.major != major)
+		unexpected(expected, h);
+	if (h.info != indefinite_length)
+		return std::string_view { read_bytes(h.argument), static_cast<std::size_t>(h.argument) };
+	/* concatenate the chunks, which are definite length strings of the same type */
+	m_scratch.clear();
+	while (!at_break())
+	{
+		head chunk = read_raw_head();
+		if (chunk.major != major || chunk.info == indefinite_length)
+			unexpected(expected, chunk);
+		m_scratch.append(read_bytes(chunk.argument), static_cast<std::size_t>(chunk.argument));
+	}
+	++m_current;
+	return m_scratch;
+}
+
+std::size_t deserializer::read_container_header(major_type major, const char* expected)
+{
+	head h = read_head();
+	if (h.major != major)
+		unexpected(expected, h);
+	if (h.info == indefinite_length)
+		return indefinite;
+	/* each item takes a byte at least: reject the sizes that can not be right before allocating anything */
+	if (h.argument > static_cast<std::uint64_t>(m_end - m_current))
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(h.offset) }));
+	return h.argument;
+}
+
+bool deserializer::next_item(std::size_t& remaining)
+{
+	if (remaining == indefinite)
+	{
+		if (m_current == m_end)
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(offset()) }));
+		if (!at_break())
+			return true;
+		++m_current;
+		remaining = 0;
+		return false;
+	}
+	if (!remaining)
+		return false;
+	--remaining;
+	return true;
+}
+
+namespace
+{
+	/* convert milliseconds or microseconds to nanoseconds */
+	std::int64_t scale_fraction(std::int64_t value, std::int64_t factor)
+	{
+		if (value > std::numeric_limits<std::int64_t>::max() / factor || value < std::numeric_limits<std::int64_t>::min() / factor)
+			corecpp::throws<std::overflow_error>(corecpp::concat<std::string>({ std::to_string(value), "*", std::to_string(factor) }));
+		return value * factor;
+	}
+}
+
+void deserializer::read_epoch_time(std::int64_t& seconds, std::int64_t& nanoseconds)
+{
+	auto tag = read_tag();
+	if (tag == tags::extended_time)
+	{
+		seconds = nanoseconds = 0;
+		for (std::size_t remaining = read_container_header(major_type::map, "map"); next_item(remaining);)
+		{
+			std::int64_t key, value;
+			deserialize(key);
+			if (key != 1 && key != -3 && key != -6 && key != -9)
+			{
+				skip_value();
+				continue;
+			}
+			deserialize(value);
+			if (key == 1)
+				seconds = value;
+			else if (key == -3)
+				nanoseconds = scale_fraction(value, 1000000);
+			else if (key == -6)
+				nanoseconds = scale_fraction(value, 1000);
+			else
+				nanoseconds = value;
+		}
+		return;
+	}
+	if (tag && tag != tags::epoch_time)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "unsupported time tag ", std::to_string(*tag) }));
+	head h = read_head();
+	if (h.major == major_type::simple)
+	{
+		double time = to_float(h);
+		if (!std::isfinite(time))
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "invalid time at offset ", std::to_string(h.offset) }));
+		double whole = std::floor(time);
+		/* -2^63 and 2^63 are exact doubles */
+		constexpr double lowest = static_cast<double>(std::numeric_limits<std::int64_t>::lowest());
+		if (whole < lowest || whole >= -lowest)
+			corecpp::throws<std::overflow_error>(std::to_string(time));
+		seconds = static_cast<std::int64_t>(whole);
+		nanoseconds = std::llround((time - whole) * 1e9);
+		return;
+	}
+	std::int64_t signed_value;
+	std::uint64_t unsigned_value;
+	if (to_integer(h, signed_value, unsigned_value))
+	{
+		if (unsigned_value > static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()))
+			corecpp::throws<std::overflow_error>(std::to_string(unsigned_value));
+		signed_value = static_cast<std::int64_t>(unsigned_value);
+	}
+	seconds = signed_value;
+	nanoseconds = 0;
+}
+
+void deserializer::skip_value()
+{
+	/* keep the items left in the enclosing containers instead of recursing, so that a deep nesting can not exhaust the stack */
+	m_skipped.assign(1, 1);
+	while (!m_skipped.empty())
+	{
+		if (!next_item(m_skipped.back()))
+		{
+			m_skipped.pop_back();
+			continue;
+		}
+		head h = read_head();
+		switch (h.major)
+		{
+			case major_type::byte_string:
+			case major_type::text_string:
+				if (h.info == indefinite_length)
+					m_skipped.push_back(indefinite);
+				else
+					read_bytes(h.argument);
+				break;
+			case major_type::array:
+			case major_type::map:
+				if (h.info == indefinite_length)
+					m_skipped.push_back(indefinite);
+				else if (h.argument > static_cast<std::uint64_t>(m_end - m_current))
+					corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(h.offset) }));
+				else /* the keys and the values of a map are skipped alike */
+					m_skipped.push_back(h.major == major_type::map ? 2 * h.argument : h.argument);
+				break;
+			default:
+				/* integers, simple values and floats are entirely held by their head */
+				break;
+		}
+	}
+}
+
+void deserializer::deserialize(bool& value)
+{
+	head h = read_head();
+	if (h.major == major_type::simple && h.info == simple::true_)
+		value = true;
+	else if (h.major == major_type::simple && h.info == simple::false_)
+		value = false;
+	else
+		unexpected("boolean", h);
+}
+
+void deserializer::deserialize(std::nullptr_t)
+{
+	head h = read_head();
+	if (h.major != major_type::simple || (h.info != simple::null && h.info != simple::undefined))
+		unexpected("null", h);
+}
+
+void deserializer::deserialize(std::wstring& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::deserialize(std::u16string& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::deserialize(std::u32string& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::end_object()
+{
+	if (m_remaining.empty() || next_item(m_remaining.back()))
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "end of object expected at offset ", std::to_string(offset()) }));
+	m_remaining.pop_back();
+}
+
+}
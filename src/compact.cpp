@@ -0,0 +1,119 @@
+#include <codecvt>
+#include <cstring>
+#include <locale>
+
+#include <corecpp/serialization/compact.h>
+
+
+namespace corecpp::compact
+{
+
+std::uint8_t deserializer::read_byte()
+{
+	if (m_current == m_end)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(offset()) }));
+	return static_cast<std::uint8_t>(*m_current++);
+}
+
+const char* deserializer::read_bytes(std::size_t size)
+{
+	if (static_cast<std::size_t>(m_end - m_current) < size)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(offset()) }));
+	const char* bytes = m_current;
+	m_current += size;
+	return bytes;
+}
+
+std::uint64_t deserializer::read_varint()
+{
+	std::size_t start = offset();
+	std::uint64_t value = 0;
+	for (unsigned int shift = 0; shift < 64; shift += 7)
+	{
+		std::uint8_t byte = read_byte();
+		value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+		if (!(byte & 0x80))
+		{
+			/* the tenth byte only holds the highest bit */
+			if (shift == 63 && byte > 1)
+				break;
+			return value;
+		}
+	}
+	corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "invalid varint at offset ", std::to_string(start) }));
+}
+
+std::int64_t deserializer::read_signed()
+{
+	std::uint64_t value = read_varint();
+	return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+std::size_t deserializer::read_size()
+{
+	std::size_t start = offset();
+	std::uint64_t size = read_varint();
+	if (size > static_cast<std::uint64_t>(m_end - m_current))
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(start) }));
+	return static_cast<std::size_t>(size);
+}
+
+std::string_view deserializer::read_string()
+{
+	std::size_t size = read_size();
+	return std::string_view { read_bytes(size), size };
+}
+
+void deserializer::check_fingerprint(std::uint64_t expected)
+{
+	std::uint64_t actual = read_little_endian<std::uint64_t>();
+	if (actual != expected)
+		corecpp::throws<corecpp::semantic_error>(corecpp::concat<std::string>({ "schema mismatch: fingerprint ", std::to_string(actual),
+			" read, ", std::to_string(expected), " expected" }));
+}
+
+void deserializer::deserialize(bool& value)
+{
+	std::uint8_t byte = read_byte();
+	if (byte > 1)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "invalid boolean at offset ", std::to_string(offset() - 1) }));
+	value = byte;
+}
+
+void deserializer::deserialize(float& value)
+{
+	std::uint32_t bits = read_little_endian<std::uint32_t>();
+	std::memcpy(&value, &bits, sizeof(value));
+}
+
+void deserializer::deserialize(double& value)
+{
+	std::uint64_t bits = read_little_endian<std::uint64_t>();
+	std::memcpy(&value, &bits, sizeof(value));
+}
+
+void deserializer::deserialize(std::wstring& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::deserialize(std::u16string& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::deserialize(std::u32string& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::end_object()
+{
+	if (!read_string().empty())
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "end of object expected at offset ", std::to_string(offset()) }));
+}
+
+}
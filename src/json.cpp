@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
@@ -5,9 +6,13 @@
 #include <locale>
 #include <memory>
 #include <iomanip>
+#include <utility>
 
 #include <corecpp/serialization/json.h>
 
+#include "json_number.h"
+#include "json_scan.h"
+
 
 namespace corecpp::json
 {
@@ -18,6 +23,123 @@ corecpp::diagnostic::channel& json_channel()
 	return channel;
 }
 
+std::size_t details::unescaped_length(std::string_view value) noexcept
+{
+	return find_string_delimiter(value.data(), value.data() + value.size()) - value.data();
+}
+
+void details::check_utf8(std::string_view value)
+{
+	const char* end = value.data() + value.size();
+	const char* invalid = find_invalid_utf8(value.data(), end);
+	if (invalid != end)
+		corecpp::throws<std::range_error>(corecpp::concat<std::string>({ "invalid utf-8 sequence at offset ", std::to_string(invalid - value.data()) }));
+}
+
+details::worker_pool::worker_pool(unsigned int threads)
+: m_threads(), m_mutex(), m_wake(), m_idle(), m_task(), m_generation(0), m_running(0), m_stopped(false)
+{
+	try
+	{
+		for (unsigned int i = 0; i < threads; ++i)
+			m_threads.emplace_back([this] { work(); });
+	}
+	catch (...)
+	{
+		stop();
+		throw;
+	}
+}
+
+details::worker_pool::~worker_pool()
+{
+	stop();
+}
+
+void details::worker_pool::stop() noexcept
+{
+	{
+		std::lock_guard<std::mutex> lock { m_mutex };
+		m_stopped = true;
+	}
+	m_wake.notify_all();
+	for (auto& thread : m_threads)
+		thread.join();
+	m_threads.clear();
+}
+
+void details::worker_pool::work()
+{
+	std::size_t generation = 0;
+	std::unique_lock<std::mutex> lock { m_mutex };
+	for (;;)
+	{
+		m_wake.wait(lock, [&] { return m_stopped || m_generation != generation; });
+		if (m_stopped)
+			return;
+		generation = m_generation;
+		lock.unlock();
+		m_task();
+		lock.lock();
+		if (!--m_running)
+			m_idle.notify_all();
+	}
+}
+
+void details::worker_pool::start(std::function<void()> task)
+{
+	std::unique_lock<std::mutex> lock { m_mutex };
+	m_idle.wait(lock, [this] { return !m_running; });
+	m_task = std::move(task);
+	m_running = m_threads.size();
+	++m_generation;
+	m_wake.notify_all();
+}
+
+void details::worker_pool::wait()
+{
+	std::unique_lock<std::mutex> lock { m_mutex };
+	m_idle.wait(lock, [this] { return !m_running; });
+}
+
+namespace
+{
+	inline int hex_value(char c) noexcept
+	{
+		if (c >= '0' && c <= '9')
+			return c - '0';
+		if (c >= 'a' && c <= 'f')
+			return c - 'a' + 10;
+		if (c >= 'A' && c <= 'F')
+			return c - 'A' + 10;
+		return -1;
+	}
+
+	void append_utf8(std::string& str, char32_t c)
+	{
+		if (c < 0x80)
+			str += static_cast<char>(c);
+		else if (c < 0x800)
+		{
+			str += static_cast<char>(0xC0 | (c >> 6));
+			str += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else if (c < 0x10000)
+		{
+			str += static_cast<char>(0xE0 | (c >> 12));
+			str += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			str += static_cast<char>(0x80 | (c & 0x3F));
+		}
+		else
+		{
+			str += static_cast<char>(0xF0 | (c >> 18));
+			str += static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+			str += static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+			str += static_cast<char>(0x80 | (c & 0x3F));
+		}
+	}
+}
+
 corecpp::diagnostic::event_producer& json_logger()
 {
 	static auto logger = corecpp::diagnostic::event_producer(json_channel());
@@ -44,10 +166,14 @@ std::string to_string(const token& tk)
 			return ":";
 		case token::index_of<string_token>::value:
 			return std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(tk.get<string_token>().value);
+		case token::index_of<string_view_token>::value:
+			return std::string { tk.get<string_view_token>().value };
 		case token::index_of<numeric_token>::value:
 			return std::to_string(tk.get<numeric_token>().value);
 		case token::index_of<integral_token>::value:
 			return std::to_string(tk.get<integral_token>().value);
+		case token::index_of<unsigned_token>::value:
+			return std::to_string(tk.get<unsigned_token>().value);
 		case token::index_of<null_token>::value:
 			return "null";
 		case token::index_of<true_token>::value:
@@ -58,308 +184,288 @@ std::string to_string(const token& tk)
 	corecpp::throws<std::logic_error>("unreachable");
 }
 
-wchar_t tokenizer::read_escaped_char()
-{
-	/* TODO: support not only UTF8 */
-	static wchar_t conversion_tab[256] = {
-		// 16 chars per line
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
-		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-	};
-
-	assert (m_buffer.in_avail() >= 4);
-
-	wchar_t a,b,c,d;
-	a = conversion_tab[(int)m_buffer.sbumpc()];
-	b = conversion_tab[(int)m_buffer.sbumpc()];
-	c = conversion_tab[(int)m_buffer.sbumpc()];
-	d = conversion_tab[(int)m_buffer.sbumpc()];
-	if ((a < 0) || (b < 0) || (c < 0) || (d < 0))
-		corecpp::throws<lexical_error>(corecpp::concat<std::string>({"invalid unicode escape sequence: ", std::to_string(a), ",",
-											std::to_string(b),  ",", std::to_string(c),  ",", std::to_string(d)}));
-	return (a << 12) + (b << 8) + (c << 4) + d;
-}
-
-std::unique_ptr<token> tokenizer::read_string_literal()
-{
-	if (m_buffer.in_avail() <= 0)
-		return nullptr;
-
-	std::wstring literal;
-	bool good = false;
-
-	while (!good && (m_buffer.in_avail() > 0))
+bool tokenizer::fill()
+{
+	/* take what the stream buffer already holds. When it holds nothing, sbumpc waits for its next chars */
+	std::streamsize available = m_buffer.in_avail();
+	std::size_t size = 0;
+	if (available <= 0)
 	{
 		int c = m_buffer.sbumpc();
-		json_logger().debug("string_literal : read char", std::string(1, c), __FILE__, __LINE__);
-		switch (c)
+		if (c == EOF)
+			return false;
+		m_chunk.assign(1, static_cast<char>(c));
+		size = 1;
+		available = m_buffer.in_avail();
+	}
+	if (available > 0)
+	{
+		m_chunk.resize(size + std::min(static_cast<std::size_t>(available), chunk_size));
+		size += m_buffer.sgetn(m_chunk.data() + size, m_chunk.size() - size);
+	}
+	m_chunk.resize(size);
+	m_chunk_offset = m_lexer.offset();
+	m_lexer.feed(m_chunk);
+	return true;
+}
+
+token_status tokenizer::next(token& tk)
+{
+	token_status status;
+	while ((status = m_lexer.next(tk)) == token_status::need_more)
+	{
+		if (!fill())
 		{
-			case '\"':
-				good = true;
-				break;
-			/* control-characters */
-			case '\r':
-			case '\n':
-				corecpp::throws<lexical_error>("invalid string expression : unexpected end of line");
-			case '\\':
-				if (m_buffer.in_avail() <= 0)
-					return nullptr;
-				switch (c = m_buffer.sbumpc())
-				{
-					case '"': literal += '"'; break;
-					case '\\': literal += '\\'; break;
-					case '/': literal += '/'; break;
-					case 'b': literal += '\b'; break;
-					case 'f': literal += '\f'; break;
-					case 'n': literal += '\n'; break;
-					case 'r': literal += '\r'; break;
-					case 't': literal += '\t'; break;
-					case 'u':
-						if (m_buffer.in_avail() < 4)
-							corecpp::throws<lexical_error>("invalid string expression : unterminated escape sequence");
-						/* \u four-hex-digits */
-						literal += read_escaped_char();
-						break;
-					default:
-						corecpp::throws<lexical_error>("invalid string expression : unknown escape sequence");
-				}
-				break;
-			default:
-				literal += c;
-				break;
+			/* end of stream: a number ends there, but the other tokens need more chars */
+			status = m_lexer.flush(tk);
+			break;
 		}
 	}
+	if (status == token_status::ready && m_encoding == encoding::wide && tk.index() == token::index_of<string_view_token>::value)
+	{
+		auto str = tk.get<string_view_token>().value;
+		try
+		{
+			tk = string_token { std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(str.data(), str.data() + str.size()) };
+		}
+		catch (const std::range_error&)
+		{
+			corecpp::throws<lexical_error>("invalid string expression : invalid utf-8 sequence");
+		}
+	}
+	return status;
+}
 
-	if(!good)
+std::unique_ptr<token> tokenizer::next()
+{
+	token tk;
+	if (next(tk) != token_status::ready)
 		return nullptr;
-
-	json_logger().trace("string_literal read", std::wstring_convert<std::codecvt_utf8<wchar_t>>().to_bytes(literal), __FILE__, __LINE__);
-	return std::make_unique<token>(string_token { literal });
+	return std::make_unique<token>(std::move(tk));
 }
 
-unsigned int tokenizer::read_exponential(char c)
+/*
+ * PARSE ERRORS
+ */
+
+namespace
 {
-	unsigned int exponential_value = 0;
-	for (; m_buffer.in_avail() >= 0; c = m_buffer.sbumpc())
+	const char* describe(parse_errc code) noexcept
 	{
-		switch(c)
+		switch (code)
 		{
-			case '0':
-			case '1':
-			case '2':
-			case '3':
-			case '4':
-			case '5':
-			case '6':
-			case '7':
-			case '8':
-			case '9':
-				exponential_value = (10 * exponential_value) + (c - '0');
-				break;
+			case parse_errc::unexpected_character:
+				return "unexpected character";
+			case parse_errc::invalid_escape:
+				return "invalid escape sequence";
+			case parse_errc::control_character:
+				return "unescaped control character";
+			case parse_errc::invalid_number:
+				return "invalid numeric expression";
+			case parse_errc::truncated:
+				return "truncated document";
+			case parse_errc::unexpected_token:
+				return "unexpected token";
+			case parse_errc::out_of_range:
+				return "number out of range";
+			case parse_errc::unpaired_surrogate:
+				return "unpaired surrogate";
+		}
+		return "unknown error";
+	}
+
+	/* throw the exception the throwing api used to report the error */
+	[[ noreturn ]] void raise(const parse_error& error)
+	{
+		switch (error.code)
+		{
+			case parse_errc::invalid_escape:
+			case parse_errc::control_character:
+			case parse_errc::invalid_number:
+			case parse_errc::unpaired_surrogate:
+				corecpp::throws<lexical_error>(error.message());
+			case parse_errc::out_of_range:
+				corecpp::throws<std::overflow_error>(error.message());
 			default:
-			{
-				return exponential_value;
-			}
+				corecpp::throws<corecpp::syntax_error>(error.message());
 		}
 	}
-	return 0;
 }
 
-std::unique_ptr<token> tokenizer::read_numeric_literal(char c)
+std::string parse_error::message() const
 {
-	bool negative = false;
-	long integral_value = 0;
+	return corecpp::concat<std::string>({ describe(code), " at offset ", std::to_string(offset) });
+}
 
-	if (c == '-')
-	{
-		if (m_buffer.in_avail() <= 0)
-			return nullptr;
-		negative = true;
-		c = m_buffer.sbumpc();
-	}
+/*
+ * BUFFER TOKENIZER
+ */
 
-	for(; m_buffer.in_avail() >= 0; c = m_buffer.sbumpc())
+token_status buffer_tokenizer::read_escape_sequence(const char*& pos)
+{
+	/* pos points past the backslash. It is left untouched unless the sequence is ready */
+	const char* start = pos - 1;
+	if (pos == m_end)
+		return token_status::need_more;
+	switch (*pos)
 	{
-		switch (c)
+		case '"': m_literal += '"'; break;
+		case '\\': m_literal += '\\'; break;
+		case '/': m_literal += '/'; break;
+		case 'b': m_literal += '\b'; break;
+		case 'f': m_literal += '\f'; break;
+		case 'n': m_literal += '\n'; break;
+		case 'r': m_literal += '\r'; break;
+		case 't': m_literal += '\t'; break;
+		case 'u':
 		{
-			case '0':
-			case '1':
-			case '2':
-			case '3':
-			case '4':
-			case '5':
-			case '6':
-			case '7':
-			case '8':
-			case '9':
-				integral_value = (10 * integral_value) + (c - '0');
-				break;
-			case 'e':
-			case 'E':
+			/* need_more only when the input ends within the 4 digits */
+			auto read_hex = [this](const char* p, char32_t& code) -> token_status {
+				code = 0;
+				for (const char* digits = p; p != digits + 4; ++p)
+				{
+					if (p == m_end)
+						return token_status::need_more;
+					int digit = hex_value(*p);
+					if (digit < 0)
+						return fail(parse_errc::invalid_escape, p);
+					code = (code << 4) + digit;
+				}
+				return token_status::ready;
+			};
+			const char* p = pos + 1;
+			char32_t c;
+			auto status = read_hex(p, c);
+			if (status != token_status::ready)
+				return status;
+			p += 4;
+			if (c >= 0xDC00 && c <= 0xDFFF)
+				return fail(parse_errc::unpaired_surrogate, start);
+			if (c >= 0xD800 && c <= 0xDBFF)
 			{
-				bool negative_exponential = false;
+				/* utf-16 surrogate pair : the low surrogate must follow */
+				if (p == m_end || (p[0] == '\\' && p + 1 == m_end))
+					return token_status::need_more;
+				if (p[0] != '\\' || p[1] != 'u')
+					return fail(parse_errc::unpaired_surrogate, start);
+				char32_t low;
+				status = read_hex(p + 2, low);
+				if (status != token_status::ready)
+					return status;
+				if (low < 0xDC00 || low > 0xDFFF)
+					return fail(parse_errc::unpaired_surrogate, start);
+				c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+				p += 6;
+			}
+			append_utf8(m_literal, c);
+			pos = p;
+			return token_status::ready;
+		}
+		default:
+			return fail(parse_errc::invalid_escape, start);
+	}
+	++pos;
+	return token_status::ready;
+}
 
-				if (m_buffer.in_avail() < 0)
-					return nullptr;
+token_status buffer_tokenizer::read_string_literal(token& tk)
+{
+	const char* run = m_current;
+	const char* pos = m_current;
+	bool escaped = false;
 
-				c = m_buffer.sbumpc();
-				if (c == '-' || c == '+')
+	for (;;)
+	{
+		pos = details::find_string_delimiter(pos, m_end);
+		if (pos == m_end)
+			return token_status::need_more;
+		switch (*pos)
+		{
+			case '"':
+				if (escaped)
 				{
-					negative_exponential = (c == '-');
-					if (m_buffer.in_avail() < 0)
-						return nullptr;
-					c = m_buffer.sbumpc();
+					m_literal.append(run, pos);
+					tk = string_view_token { m_literal };
 				}
-
-				auto exponential_value = read_exponential(c);
-				double value = integral_value;
-				if (!negative_exponential)
-					value *= pow(10, exponential_value);
 				else
-					value /= pow(10, exponential_value);
-				m_buffer.sungetc();
-				return std::make_unique<token>(numeric_token { negative ? -value : value });
-			}
-			case '.':
+					tk = string_view_token { std::string_view { run, static_cast<std::size_t>(pos - run) } };
+				m_current = pos + 1;
+				return token_status::ready;
+			case '\\':
 			{
-				long decimal_value = 0;
-				unsigned int decimal_precision = 1;
-				while (m_buffer.in_avail() >= 0)
+				if (!escaped)
 				{
-					c = m_buffer.sbumpc();
-					switch (c)
-					{
-						case '0':
-						case '1':
-						case '2':
-						case '3':
-						case '4':
-						case '5':
-						case '6':
-						case '7':
-						case '8':
-						case '9':
-							decimal_value = (10 * decimal_value) + (c - '0');
-							decimal_precision *= 10;
-							break;
-						case 'e':
-						case 'E':
-						{
-							bool negative_exponential = false;
-
-							if (m_buffer.in_avail() < 0)
-								return nullptr;
-
-							c = m_buffer.sbumpc();
-							if (c == '-' || c == '+')
-							{
-								negative_exponential = (c == '-');
-								if (m_buffer.in_avail() < 0)
-									return nullptr;
-								c = m_buffer.sbumpc();
-							}
-
-							auto exponential_value = read_exponential(c);
-							double value = ((double)integral_value + ((double)decimal_value/decimal_precision));
-							if (!negative_exponential)
-								value *= pow(10, exponential_value);
-							else
-								value /= pow(10, exponential_value);
-							m_buffer.sungetc();
-							return std::make_unique<token>(numeric_token { negative ? -value : value });
-						}
-						default:
-						{
-							double value = (double)integral_value + ((double)decimal_value/decimal_precision);
-							m_buffer.sungetc();
-							return std::make_unique<token>(numeric_token { negative ? -value : value });
-						}
-					}
+					m_literal.clear();
+					escaped = true;
 				}
+				m_literal.append(run, pos);
+				++pos;
+				auto status = read_escape_sequence(pos);
+				if (status != token_status::ready)
+					return status;
+				run = pos;
 				break;
 			}
 			default:
-				m_buffer.sungetc();
-				return std::make_unique<token>(integral_token { negative ? -integral_value : integral_value });
+				return fail(parse_errc::control_character, pos);
 		}
 	}
+}
 
-	return nullptr;
+token_status buffer_tokenizer::read_numeric_literal(const char* start, token& tk)
+{
+	const char* pos = details::parse_number(start, m_end, tk);
+	if (!pos)
+		return token_status::need_more;
+	if (pos == start)
+		return fail(parse_errc::invalid_number, start);
+	m_current = pos;
+	return token_status::ready;
 }
 
-std::unique_ptr<token> tokenizer::next()
+token_status buffer_tokenizer::read_keyword(const char* start, std::string_view keyword)
 {
-	char c;
-	if (m_buffer.in_avail() <= 0)
-	{
-		m_buffer.pubsync();
-		if (m_buffer.in_avail() <= 0)
-		{
-			json_logger().trace("No more token to parse", __FILE__, __LINE__);
-			return nullptr;
-		}
-	}
+	std::size_t available = m_end - start;
+	if (keyword.compare(0, std::min(available, keyword.size()), start, std::min(available, keyword.size())) != 0
+		|| (available > keyword.size() && std::isalnum(static_cast<unsigned char>(start[keyword.size()]))))
+		return fail(parse_errc::unexpected_character, start);
+	if (available < keyword.size())
+		return token_status::need_more;
+	m_current = start + keyword.size();
+	return token_status::ready;
+}
 
-	for (c = m_buffer.sbumpc(); std::isspace(c, m_locale); c = m_buffer.sbumpc())
-	{
-		if (m_buffer.in_avail() <= 0)
-		{
-			json_logger().trace("Skipped blank caracters, no more token to parse", __FILE__, __LINE__);
-			return nullptr;
-		}
-		json_logger().trace("Skipped blank caracter", __FILE__, __LINE__);
-	}
+token_status buffer_tokenizer::try_next(token& tk)
+{
+	m_current = details::skip_blanks(m_current, m_end);
+	if (m_current == m_end)
+		return token_status::end;
 
-	pos_type pos = m_buffer.pubseekoff(0, std::ios_base::cur, std::ios_base::in);
-	json_logger().debug("parse token", corecpp::concat<std::string>({ "at pos ", std::to_string(pos), "'", std::to_string(c), "'"  }),
-			__FILE__, __LINE__);
-	switch (c)
+	const char* start = m_current++;
+	token_status status = token_status::ready;
+	switch (*start)
 	{
 		case '{':
-		{
-			return std::make_unique<token>(open_brace_token());
-		}
+			tk = open_brace_token();
+			break;
 		case '}':
-		{
-			return std::make_unique<token>(close_brace_token());
-		}
+			tk = close_brace_token();
+			break;
 		case '[':
-		{
-			return std::make_unique<token>(open_bracket_token());
-		}
+			tk = open_bracket_token();
+			break;
 		case ']':
-		{
-			return std::make_unique<token>(close_bracket_token());
-		}
+			tk = close_bracket_token();
+			break;
 		case ',':
-		{
-			return std::make_unique<token>(comma_token());
-		}
+			tk = comma_token();
+			break;
 		case ':':
-		{
-			return std::make_unique<token>(colon_token());
-		}
+			tk = colon_token();
+			break;
 		case '"':
-		{
-			auto res = read_string_literal();
-			if (!res)
-				m_buffer.pubseekpos(pos, std::ios_base::in);
-			return res;
-		}
+			status = read_string_literal(tk);
+			break;
 		case '-':
 		case '0':
 		case '1':
@@ -371,105 +477,893 @@ std::unique_ptr<token> tokenizer::next()
 		case '7':
 		case '8':
 		case '9':
+			status = read_numeric_literal(start, tk);
+			break;
+		case 'f':
+			if ((status = read_keyword(start, "false")) == token_status::ready)
+				tk = false_token();
+			break;
+		case 'n':
+			if ((status = read_keyword(start, "null")) == token_status::ready)
+				tk = null_token();
+			break;
+		case 't':
+			if ((status = read_keyword(start, "true")) == token_status::ready)
+				tk = true_token();
+			break;
+		default:
+			status = fail(parse_errc::unexpected_character, start);
+	}
+	if (status != token_status::ready)
+		m_current = start;
+	return status;
+}
+
+token_status buffer_tokenizer::next(token& tk)
+{
+	auto status = try_next(tk);
+	if (status == token_status::invalid)
+		raise(m_error);
+	return status;
+}
+
+/*
+ * CHUNK TOKENIZER
+ */
+
+void chunk_tokenizer::check_high_surrogate() const
+{
+	if (m_high)
+		corecpp::throws<lexical_error>(corecpp::concat<std::string>({ "invalid string expression : unpaired surrogate at offset ", std::to_string(offset()) }));
+}
+
+void chunk_tokenizer::read_number(const char* begin, const char* end, token& tk)
+{
+	if (details::parse_number(begin, end, tk) != end)
+		corecpp::throws<lexical_error>(corecpp::concat<std::string>({ "invalid numeric expression at offset ", std::to_string(offset()) }));
+}
+
+token_status chunk_tokenizer::flush(token& tk)
+{
+	if (m_state == lexer_state::blank)
+		return token_status::end;
+	if (m_state != lexer_state::number)
+		return token_status::need_more;
+	m_state = lexer_state::blank;
+	read_number(m_literal.data(), m_literal.data() + m_literal.size(), tk);
+	return token_status::ready;
+}
+
+token_status chunk_tokenizer::next(token& tk)
+{
+	for (;;)
+	{
+		if (m_state == lexer_state::blank)
+		{
+			m_current = details::skip_blanks(m_current, m_end);
+			if (m_current == m_end)
+				return m_finished ? token_status::end : token_status::need_more;
+			switch (*m_current)
+			{
+				case '{':
+					tk = open_brace_token();
+					++m_current;
+					return token_status::ready;
+				case '}':
+					tk = close_brace_token();
+					++m_current;
+					return token_status::ready;
+				case '[':
+					tk = open_bracket_token();
+					++m_current;
+					return token_status::ready;
+				case ']':
+					tk = close_bracket_token();
+					++m_current;
+					return token_status::ready;
+				case ',':
+					tk = comma_token();
+					++m_current;
+					return token_status::ready;
+				case ':':
+					tk = colon_token();
+					++m_current;
+					return token_status::ready;
+				case '"':
+				{
+					/* a literal held by the chunk, without any escape sequence, is viewed in place */
+					const char* start = ++m_current;
+					const char* pos = details::find_string_delimiter(start, m_end);
+					if (pos != m_end && *pos == '"')
+					{
+						tk = string_view_token { std::string_view { start, static_cast<std::size_t>(pos - start) } };
+						m_current = pos + 1;
+						return token_status::ready;
+					}
+					m_literal.assign(start, pos);
+					m_current = pos;
+					m_state = lexer_state::string;
+					break;
+				}
+				case '-':
+				case '0':
+				case '1':
+				case '2':
+				case '3':
+				case '4':
+				case '5':
+				case '6':
+				case '7':
+				case '8':
+				case '9':
+					m_literal.clear();
+					m_state = lexer_state::number;
+					break;
+				case 't':
+				case 'f':
+				case 'n':
+					m_keyword = *m_current == 't' ? "true" : *m_current == 'f' ? "false" : "null";
+					m_matched = 0;
+					m_state = lexer_state::keyword;
+					break;
+				default:
+					corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "unexpected character at offset ", std::to_string(offset()) }));
+			}
+		}
+
+		if (m_current == m_end)
 		{
-			auto res = read_numeric_literal(c);
-			if (!res)
-				m_buffer.pubseekpos(pos, std::ios_base::in);
-			return res;
+			if (!m_finished)
+				return token_status::need_more;
+			if (m_state != lexer_state::number)
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(offset()) }));
+			m_state = lexer_state::blank;
+			read_number(m_literal.data(), m_literal.data() + m_literal.size(), tk);
+			return token_status::ready;
 		}
-		case 'f':
+
+		switch (m_state)
+		{
+			case lexer_state::string:
+			{
+				if (*m_current != '\\')
+					check_high_surrogate();
+				const char* pos = details::find_string_delimiter(m_current, m_end);
+				m_literal.append(m_current, pos);
+				m_current = pos;
+				if (pos == m_end)
+					break;
+				if (*pos == '"')
+				{
+					++m_current;
+					m_state = lexer_state::blank;
+					tk = string_view_token { m_literal };
+					return token_status::ready;
+				}
+				if (*pos != '\\')
+					corecpp::throws<lexical_error>("invalid string expression : unescaped control character");
+				++m_current;
+				m_state = lexer_state::escape;
+				break;
+			}
+			case lexer_state::escape:
+			{
+				char c = *m_current++;
+				if (c == 'u')
+				{
+					m_code = 0;
+					m_digits = 0;
+					m_state = lexer_state::unicode;
+					break;
+				}
+				check_high_surrogate();
+				switch (c)
+				{
+					case '"': m_literal += '"'; break;
+					case '\\': m_literal += '\\'; break;
+					case '/': m_literal += '/'; break;
+					case 'b': m_literal += '\b'; break;
+					case 'f': m_literal += '\f'; break;
+					case 'n': m_literal += '\n'; break;
+					case 'r': m_literal += '\r'; break;
+					case 't': m_literal += '\t'; break;
+					default:
+						corecpp::throws<lexical_error>("invalid string expression : unknown escape sequence");
+				}
+				m_state = lexer_state::string;
+				break;
+			}
+			case lexer_state::unicode:
+			{
+				for (; m_digits < 4 && m_current != m_end; ++m_digits)
+				{
+					int digit = hex_value(*m_current++);
+					if (digit < 0)
+						corecpp::throws<lexical_error>(corecpp::concat<std::string>({ "invalid unicode escape sequence at offset ", std::to_string(offset()) }));
+					m_code = (m_code << 4) + digit;
+				}
+				if (m_digits < 4)
+					break;
+				m_state = lexer_state::string;
+				if (m_high && m_code >= 0xDC00 && m_code <= 0xDFFF)
+				{
+					append_utf8(m_literal, 0x10000 + ((m_high - 0xD800) << 10) + (m_code - 0xDC00));
+					m_high = 0;
+					break;
+				}
+				check_high_surrogate();
+				if (m_code >= 0xDC00 && m_code <= 0xDFFF)
+					corecpp::throws<lexical_error>(corecpp::concat<std::string>({ "invalid string expression : unpaired surrogate at offset ", std::to_string(offset()) }));
+				if (m_code >= 0xD800 && m_code <= 0xDBFF)
+					m_high = m_code;
+				else
+					append_utf8(m_literal, m_code);
+				break;
+			}
+			case lexer_state::number:
+			{
+				/* a number held by the chunk is parsed in place */
+				const char* start = m_current;
+				const char* pos = start;
+				while (pos != m_end && details::is_number_char(*pos))
+					++pos;
+				m_current = pos;
+				if (pos == m_end)
+				{
+					m_literal.append(start, pos);
+					break;
+				}
+				m_state = lexer_state::blank;
+				if (m_literal.empty())
+					read_number(start, pos, tk);
+				else
+				{
+					m_literal.append(start, pos);
+					read_number(m_literal.data(), m_literal.data() + m_literal.size(), tk);
+				}
+				return token_status::ready;
+			}
+			case lexer_state::keyword:
+			{
+				for (; m_matched < m_keyword.size() && m_current != m_end; ++m_matched, ++m_current)
+				{
+					if (*m_current != m_keyword[m_matched])
+						corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "unexpected character at offset ", std::to_string(offset()) }));
+				}
+				if (m_matched < m_keyword.size())
+					break;
+				m_state = lexer_state::blank;
+				if (m_keyword[0] == 't')
+					tk = true_token();
+				else if (m_keyword[0] == 'f')
+					tk = false_token();
+				else
+					tk = null_token();
+				return token_status::ready;
+			}
+			case lexer_state::blank:
+				break;
+		}
+	}
+}
+
+/*
+ * NODES
+ */
+namespace
+{
+	std::uint32_t hash_key(std::wstring_view key) noexcept
+	{
+		/* folded through 64 bits, shifting a 32 bits size_t by 32 is undefined */
+		std::uint64_t hash = std::hash<std::wstring_view>{}(key);
+		return static_cast<std::uint32_t>(hash ^ (hash >> 32));
+	}
+}
+
+void key_index::insert(const std::vector<pair_node>& members, std::size_t position, std::uint32_t hash)
+{
+	std::size_t mask = m_slots.size() - 1;
+	for (std::size_t i = hash & mask; ; i = (i + 1) & mask)
+	{
+		auto& s = m_slots[i];
+		if (!s.position)
+		{
+			s = slot { static_cast<std::uint32_t>(position + 1), hash };
+			return;
+		}
+		/* keep the first of duplicated names, as a linear search would */
+		if (s.hash == hash && members[s.position - 1].name.value == members[position].name.value)
+			return;
+	}
+}
+
+void key_index::update(const std::vector<pair_node>& members)
+{
+	if (members.size() < m_count)
+		reset();
+	if (members.size() < threshold)
+		return;
+	if (members.size() * 2 > m_slots.size())
+	{
+		/* keep the load factor under 1/2 */
+		std::size_t capacity = 64;
+		while (capacity < members.size() * 4)
+			capacity *= 2;
+		m_slots.assign(capacity, slot { 0, 0 });
+		m_count = 0;
+	}
+	for (; m_count < members.size(); ++m_count)
+		insert(members, m_count, hash_key(members[m_count].name.value));
+}
+
+std::size_t key_index::lookup(const std::vector<pair_node>& members, std::wstring_view key, bool& stale) const
+{
+	stale = members.size() < m_count;
+	if (m_slots.empty() || stale)
+		return npos;
+	auto hash = hash_key(key);
+	std::size_t mask = m_slots.size() - 1;
+	for (std::size_t i = hash & mask; m_slots[i].position; i = (i + 1) & mask)
+	{
+		const auto& s = m_slots[i];
+		if (s.hash != hash)
+			continue;
+		const auto& name = members[s.position - 1].name.value;
+		if (name == key)
+			return s.position - 1;
+		/* a member renamed since it was indexed no longer has the hash of its slot */
+		if (hash_key(name) != hash)
+		{
+			stale = true;
+			return npos;
+		}
+	}
+	/* the members appended since the last update are not indexed yet */
+	for (std::size_t i = m_count; i < members.size(); ++i)
+	{
+		if (members[i].name.value == key)
+			return i;
+	}
+	return npos;
+}
+
+std::size_t key_index::find(const std::vector<pair_node>& members, std::wstring_view key) const
+{
+	bool stale;
+	auto position = lookup(members, key, stale);
+	if (!stale && !m_slots.empty())
+		return position;
+	for (std::size_t i = 0; i < members.size(); ++i)
+	{
+		if (members[i].name.value == key)
+			return i;
+	}
+	return npos;
+}
+
+std::size_t key_index::find(const std::vector<pair_node>& members, std::wstring_view key)
+{
+	update(members);
+	bool stale;
+	auto position = lookup(members, key, stale);
+	if (stale)
+	{
+		reset();
+		update(members);
+		position = lookup(members, key, stale);
+	}
+	if (m_slots.empty())
+		return std::as_const(*this).find(members, key);
+	return position;
+}
+
+value_node& object_node::at (const std::wstring& key)
+{
+	auto position = index.find(members, key);
+	if (position == key_index::npos)
+		corecpp::throws<std::overflow_error>(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(key));
+	return members[position].value;
+}
+const value_node& object_node::at (const std::wstring& key) const
+{
+	auto position = index.find(members, key);
+	if (position == key_index::npos)
+		corecpp::throws<std::overflow_error>(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(key));
+	return members[position].value;
+}
+value_node& object_node::at (std::string_view key)
+{
+	return at(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(key.data(), key.data() + key.size()));
+}
+const value_node& object_node::at (std::string_view key) const
+{
+	return at(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(key.data(), key.data() + key.size()));
+}
+
+/*
+ * TAPE DOCUMENT
+ */
+std::int64_t element::as_integral() const
+{
+	const auto& value = get();
+	if (value.type == tape_type::unsigned_integral)
+		corecpp::throws<std::overflow_error>(std::to_string(value.unsigned_integral));
+	return get(tape_type::integral).integral;
+}
+
+std::uint64_t element::as_unsigned() const
+{
+	const auto& value = get();
+	if (value.type == tape_type::unsigned_integral)
+		return value.unsigned_integral;
+	if (get(tape_type::integral).integral < 0)
+		corecpp::throws<std::overflow_error>(std::to_string(value.integral));
+	return value.integral;
+}
+
+double element::as_double() const
+{
+	const auto& value = get();
+	switch (value.type)
+	{
+		case tape_type::integral:
+			return value.integral;
+		case tape_type::unsigned_integral:
+			return value.unsigned_integral;
+		default:
+			return get(tape_type::numeric).numeric;
+	}
+}
+
+element element::operator[](std::size_t index) const
+{
+	const auto& value = get(tape_type::array);
+	if (index >= value.length)
+		corecpp::throws<std::out_of_range>(std::to_string(index));
+	std::size_t pos = m_index + 1;
+	for (; index; --index)
+		pos = element { *m_document, pos }.next();
+	return element { *m_document, pos };
+}
+
+std::optional<element> element::find(std::string_view key) const
+{
+	const auto& value = get(tape_type::object);
+	for (std::size_t pos = m_index + 1; pos != value.end; pos = element { *m_document, pos + 1 }.next())
+	{
+		if (element { *m_document, pos }.as_string() == key)
+			return element { *m_document, pos + 1 };
+	}
+	return std::nullopt;
+}
+
+element element::at(std::string_view key) const
+{
+	auto result = find(key);
+	if (!result)
+		corecpp::throws<std::out_of_range>(std::string { key });
+	return *result;
+}
+
+void document::push_string(std::string_view str)
+{
+	if (str.size() > std::numeric_limits<std::uint32_t>::max())
+		corecpp::throws<std::length_error>("json string too long to be stored in a document");
+	auto& value = push(tape_type::string);
+	value.offset = m_strings.size();
+	value.length = static_cast<std::uint32_t>(str.size());
+	m_strings.append(str);
+}
+
+void document::push_scalar(token& tk)
+{
+	switch (tk.index())
+	{
+		case token::index_of<string_view_token>::value:
+			push_string(tk.get<string_view_token>().value);
+			break;
+		case token::index_of<string_token>::value:
+			push_string(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(tk.get<string_token>().value));
+			break;
+		case token::index_of<integral_token>::value:
+			push(tape_type::integral).integral = tk.get<integral_token>().value;
+			break;
+		case token::index_of<unsigned_token>::value:
+			push(tape_type::unsigned_integral).unsigned_integral = tk.get<unsigned_token>().value;
+			break;
+		case token::index_of<numeric_token>::value:
+			push(tape_type::numeric).numeric = tk.get<numeric_token>().value;
+			break;
+		case token::index_of<true_token>::value:
+			push(tape_type::boolean).unsigned_integral = 1;
+			break;
+		case token::index_of<false_token>::value:
+			push(tape_type::boolean);
+			break;
+		case token::index_of<null_token>::value:
+			push(tape_type::null);
+			break;
+		default:
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "value expected, got ", to_string(tk) }));
+	}
+}
+
+/* next(token&) gives the next token of the document, or throws */
+template <typename NextT>
+void document::build(NextT next)
+{
+	enum struct expect { value, first_value, first_key, key, colon, separator };
+	token tk;
+	expect state = expect::value;
+
+	clear();
+	m_stack.clear();
+	for (;;)
+	{
+		bool closed = false;
+		next(tk);
+		switch (state)
 		{
-			if ((c = m_buffer.sbumpc()) == 'a'
-				&& (c = m_buffer.sbumpc()) == 'l'
-				&& (c = m_buffer.sbumpc()) == 's'
-				&& (c = m_buffer.sbumpc()) == 'e'
-				&& (!isalnum((c = m_buffer.sgetc()), m_locale)))
-			{
-				return std::make_unique<token>(false_token());
-			}
-			else
-			{
-				if (c == EOF)
-				{
-					m_buffer.pubseekpos(pos, std::ios_base::in);
-					return nullptr;
-				}
-				else
+			case expect::first_value:
+				if (tk.index() == token::index_of<close_bracket_token>::value)
 				{
-					m_buffer.pubseekpos(pos, std::ios_base::in);
-					corecpp::throws<corecpp::syntax_error>(reminder());
+					closed = true;
+					break;
 				}
-			}
-		}
-		case 'n':
-			if ((c = m_buffer.sbumpc()) == 'u'
-				&& (c = m_buffer.sbumpc()) == 'l'
-				&& (c = m_buffer.sbumpc()) == 'l'
-				&& (!isalnum((c = m_buffer.sgetc()), m_locale)))
-			{
-				return std::make_unique<token>(null_token());
-			}
-			else
-			{
-				if (c == EOF)
+				/* fallthrough */
+			case expect::value:
+				switch (tk.index())
 				{
-					m_buffer.pubseekpos(pos, std::ios_base::in);
-					return nullptr;
+					case token::index_of<open_brace_token>::value:
+						m_stack.push_back(m_tape.size());
+						push(tape_type::object);
+						state = expect::first_key;
+						continue;
+					case token::index_of<open_bracket_token>::value:
+						m_stack.push_back(m_tape.size());
+						push(tape_type::array);
+						state = expect::first_value;
+						continue;
+					default:
+						push_scalar(tk);
+						break;
 				}
-				else
+				break;
+			case expect::first_key:
+				if (tk.index() == token::index_of<close_brace_token>::value)
 				{
-					m_buffer.pubseekpos(pos, std::ios_base::in);
-					corecpp::throws<corecpp::syntax_error>(reminder());
+					closed = true;
+					break;
 				}
-			}
-
-		case 't':
-			if ((c = m_buffer.sbumpc()) == 'r'
-				&& (c = m_buffer.sbumpc()) == 'u'
-				&& (c = m_buffer.sbumpc()) == 'e'
-				&& (!isalnum((c = m_buffer.sgetc()), m_locale)))
-			{
-				return std::make_unique<token>(true_token());
-			}
-			else
+				/* fallthrough */
+			case expect::key:
+				if (tk.index() != token::index_of<string_view_token>::value && tk.index() != token::index_of<string_token>::value)
+					corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "string token expected, got ", to_string(tk) }));
+				push_scalar(tk);
+				state = expect::colon;
+				continue;
+			case expect::colon:
+				if (tk.index() != token::index_of<colon_token>::value)
+					corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "colon token expected, got ", to_string(tk) }));
+				state = expect::value;
+				continue;
+			case expect::separator:
 			{
-				if (c == EOF)
-				{
-					m_buffer.pubseekpos(pos, std::ios_base::in);
-					return nullptr;
-				}
-				else
+				auto& container = m_tape[m_stack.back()];
+				if (tk.index() == token::index_of<comma_token>::value)
 				{
-					m_buffer.pubseekpos(pos, std::ios_base::in);
-					corecpp::throws<corecpp::syntax_error>(reminder());
+					state = (container.type == tape_type::object) ? expect::key : expect::value;
+					continue;
 				}
+				bool closing = (container.type == tape_type::object)
+					? tk.index() == token::index_of<close_brace_token>::value
+					: tk.index() == token::index_of<close_bracket_token>::value;
+				if (!closing)
+					corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "comma or end of container expected, got ", to_string(tk) }));
+				closed = true;
+				break;
 			}
-		default:
-			m_buffer.pubseekpos(pos, std::ios_base::in);
-			return nullptr;
+		}
+
+		/* a value is complete: either a scalar, or a container which has just been closed */
+		if (closed)
+		{
+			m_tape[m_stack.back()].end = m_tape.size();
+			m_stack.pop_back();
+		}
+		if (m_stack.empty())
+			return;
+		auto& container = m_tape[m_stack.back()];
+		if (container.length == std::numeric_limits<std::uint32_t>::max())
+			corecpp::throws<std::length_error>("json container too large to be stored in a document");
+		container.length++;
+		state = expect::separator;
 	}
 }
 
+void document::parse(std::string_view buffer)
+{
+	buffer_tokenizer tokenizer { buffer };
+	build([&tokenizer](token& tk) {
+		switch (tokenizer.next(tk))
+		{
+			case token_status::ready:
+				return;
+			case token_status::need_more:
+				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(tokenizer.offset()) }));
+			case token_status::end:
+			default:
+				corecpp::throws<std::runtime_error>("eof reached unexpectedly");
+		}
+	});
+}
+
+void document::parse(std::istream& stream)
+{
+	tokenizer tokenizer { *stream.rdbuf(), encoding::utf8 };
+	build([&tokenizer](token& tk) {
+		/* the tokenizer waits for the stream: anything but a token means the stream has ended */
+		if (tokenizer.next(tk) != token_status::ready)
+			corecpp::throws<std::runtime_error>("eof reached unexpectedly");
+	});
+}
+
 /*
- * NODES
+ * ON-DEMAND ACCESS
  */
-value_node& object_node::at (const std::wstring& key)
+structural_index::structural_index(std::string_view buffer)
+: m_buffer(buffer), m_positions()
+{
+	if (buffer.size() >= std::numeric_limits<std::uint32_t>::max())
+		corecpp::throws<std::length_error>("json buffer too large to be indexed");
+	m_positions.reserve(buffer.size() / 8 + 1);
+	if (!details::index_structurals(buffer.data(), buffer.data() + buffer.size(), m_positions))
+		corecpp::throws<corecpp::syntax_error>("unterminated string literal");
+	m_positions.push_back(static_cast<std::uint32_t>(buffer.size()));
+}
+
+std::size_t structural_index::entry(std::size_t offset) const noexcept
+{
+	return std::lower_bound(m_positions.begin(), m_positions.end(), offset) - m_positions.begin();
+}
+
+cursor::cursor(const structural_index& index, std::size_t offset, std::size_t entry) noexcept
+: m_index(&index), m_offset(), m_entry(entry)
+{
+	auto buffer = index.buffer();
+	m_offset = details::skip_blanks(buffer.data() + offset, buffer.data() + buffer.size()) - buffer.data();
+}
+
+bool cursor::is_empty_container(char close) const noexcept
+{
+	auto buffer = m_index->buffer();
+	const char* first = details::skip_blanks(buffer.data() + m_offset + 1, buffer.data() + buffer.size());
+	return first != buffer.data() + buffer.size() && *first == close;
+}
+
+void cursor::unexpected(const char* expected, std::size_t offset) const
+{
+	corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ expected, " expected at offset ", std::to_string(offset) }));
+}
+
+void cursor::read_scalar(buffer_tokenizer& tokenizer, token& tk) const
+{
+	tokenizer.seek(m_offset);
+	if (tokenizer.next(tk) != token_status::ready)
+		unexpected("value", m_offset);
+}
+
+std::string_view cursor::read_key(std::size_t entry, std::string& buffer) const
+{
+	if (m_index->at(entry) != '"')
+		unexpected("string", entry < m_index->size() ? m_index->position(entry) : m_index->buffer().size());
+	const char* begin = m_index->buffer().data() + m_index->position(entry) + 1;
+	const char* end = m_index->buffer().data() + m_index->position(entry + 1);
+	/* plain keys are used in place, the others go through the tokenizer to be unescaped and validated */
+	if (details::find_string_delimiter(begin, end) == end)
+		return std::string_view { begin, static_cast<std::size_t>(end - begin) };
+	buffer_tokenizer tokenizer { m_index->buffer() };
+	token tk;
+	cursor { *m_index, m_index->position(entry), entry }.read_scalar(tokenizer, tk);
+	buffer.assign(tk.get<string_view_token>().value);
+	return buffer;
+}
+
+tape_type cursor::type() const
 {
-	for (auto& value : members)
+	auto buffer = m_index->buffer();
+	if (m_offset >= buffer.size())
+		unexpected("value", m_offset);
+	switch (buffer[m_offset])
+	{
+		case '{':
+			return tape_type::object;
+		case '[':
+			return tape_type::array;
+		case '"':
+			return tape_type::string;
+		case 't':
+		case 'f':
+			return tape_type::boolean;
+		case 'n':
+			return tape_type::null;
+		default:
+			break;
+	}
+	buffer_tokenizer tokenizer { buffer };
+	token tk;
+	read_scalar(tokenizer, tk);
+	switch (tk.index())
 	{
-		if (value.name.value == key)
-			return value.value;
+		case token::index_of<integral_token>::value:
+			return tape_type::integral;
+		case token::index_of<unsigned_token>::value:
+			return tape_type::unsigned_integral;
+		case token::index_of<numeric_token>::value:
+			return tape_type::numeric;
+		default:
+			unexpected("value", m_offset);
 	}
-	corecpp::throws<std::overflow_error>(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(key));
 }
-const value_node& object_node::at (const std::wstring& key) const
+
+bool cursor::as_bool() const
+{
+	buffer_tokenizer tokenizer { m_index->buffer() };
+	token tk;
+	read_scalar(tokenizer, tk);
+	if (tk.index() == token::index_of<true_token>::value)
+		return true;
+	if (tk.index() != token::index_of<false_token>::value)
+		unexpected("boolean", m_offset);
+	return false;
+}
+
+std::int64_t cursor::as_integral() const
+{
+	buffer_tokenizer tokenizer { m_index->buffer() };
+	token tk;
+	read_scalar(tokenizer, tk);
+	if (tk.index() == token::index_of<unsigned_token>::value)
+		corecpp::throws<std::overflow_error>(std::to_string(tk.get<unsigned_token>().value));
+	if (tk.index() != token::index_of<integral_token>::value)
+		unexpected("integral", m_offset);
+	return tk.get<integral_token>().value;
+}
+
+std::uint64_t cursor::as_unsigned() const
+{
+	buffer_tokenizer tokenizer { m_index->buffer() };
+	token tk;
+	read_scalar(tokenizer, tk);
+	if (tk.index() == token::index_of<unsigned_token>::value)
+		return tk.get<unsigned_token>().value;
+	if (tk.index() != token::index_of<integral_token>::value)
+		unexpected("integral", m_offset);
+	if (tk.get<integral_token>().value < 0)
+		corecpp::throws<std::overflow_error>(std::to_string(tk.get<integral_token>().value));
+	return tk.get<integral_token>().value;
+}
+
+double cursor::as_double() const
+{
+	buffer_tokenizer tokenizer { m_index->buffer() };
+	token tk;
+	read_scalar(tokenizer, tk);
+	switch (tk.index())
+	{
+		case token::index_of<numeric_token>::value:
+			return tk.get<numeric_token>().value;
+		case token::index_of<integral_token>::value:
+			return tk.get<integral_token>().as_double();
+		case token::index_of<unsigned_token>::value:
+			return tk.get<unsigned_token>().value;
+		default:
+			unexpected("number", m_offset);
+	}
+}
+
+std::string cursor::as_string() const
+{
+	buffer_tokenizer tokenizer { m_index->buffer() };
+	token tk;
+	read_scalar(tokenizer, tk);
+	if (tk.index() != token::index_of<string_view_token>::value)
+		unexpected("string", m_offset);
+	return std::string { tk.get<string_view_token>().value };
+}
+
+std::size_t cursor::size() const
+{
+	std::size_t count = 0;
+	if (type() == tape_type::array)
+		iterate([&count](const cursor&) { ++count; return true; });
+	else if (type() == tape_type::object)
+		iterate([&count](std::string_view, const cursor&) { ++count; return true; });
+	else
+		corecpp::throws<std::runtime_error>("json value is not a container");
+	return count;
+}
+
+cursor cursor::operator[](std::size_t index) const
+{
+	std::optional<cursor> result;
+	std::size_t remaining = index;
+	iterate([&result, &remaining](const cursor& item) {
+		if (remaining--)
+			return true;
+		result = item;
+		return false;
+	});
+	if (!result)
+		corecpp::throws<std::out_of_range>(std::to_string(index));
+	return *result;
+}
+
+std::optional<cursor> cursor::find(std::string_view key) const
+{
+	std::optional<cursor> result;
+	iterate([&result, key](std::string_view name, const cursor& item) {
+		if (name != key)
+			return true;
+		result = item;
+		return false;
+	});
+	return result;
+}
+
+cursor cursor::at(std::string_view key) const
+{
+	auto result = find(key);
+	if (!result)
+		corecpp::throws<std::out_of_range>(std::string { key });
+	return *result;
+}
+
+std::size_t cursor::next() const
+{
+	auto buffer = m_index->buffer();
+	char c = m_offset < buffer.size() ? buffer[m_offset] : '\0';
+	if (c == '"')
+		return m_entry + 2;
+	if (c != '{' && c != '[')
+		return m_entry;
+	std::size_t depth = 0;
+	for (std::size_t entry = m_entry; entry < m_index->size(); )
+	{
+		switch (m_index->at(entry))
+		{
+			case '"':
+				entry += 2;
+				continue;
+			case '{':
+			case '[':
+				++depth;
+				break;
+			case '}':
+			case ']':
+				if (--depth == 0)
+					return entry + 1;
+				break;
+			default:
+				break;
+		}
+		++entry;
+	}
+	unexpected("end of container", buffer.size());
+}
+
+void cursor_deserializer::read_token()
 {
-	for (const auto& value : members)
+	switch (m_tokenizer.next(m_current))
 	{
-		if (value.name.value == key)
-			return value.value;
+		case token_status::ready:
+			return;
+		case token_status::need_more:
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(m_tokenizer.offset()) }));
+		case token_status::end:
+		default:
+			corecpp::throws<std::runtime_error>("eof reached unexpectedly");
 	}
-	corecpp::throws<std::overflow_error>(std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().to_bytes(key));
 }
 
 /*
@@ -480,22 +1374,26 @@ shift_result object_rule::shift(token&& tk)
 	switch (m_status)
 	{
 		case status::start:
-		{
-			switch (tk.index())
+			if (tk.index() != token::index_of<open_brace_token>::value)
+				return { false, nullptr };
+			m_status = status::first;
+			return { true, nullptr };
+		case status::first:
+			if (tk.index() == token::index_of<close_brace_token>::value)
 			{
-				case token::index_of<open_brace_token>::value:
-					m_status = status::members;
-					return { true, rule { pair_rule {} } };
-				default:
-					return { false, nullptr };
+				m_status = status::end;
+				return { true, nullptr };
 			}
-		}
+			return { false, rule { pair_rule {} } };
 		case status::members:
+			return { false, rule { pair_rule {} } };
+		case status::separator:
 		{
 			switch (tk.index())
 			{
-				case token::index_of<colon_token>::value:
-					return { true, rule { pair_rule {} } };
+				case token::index_of<comma_token>::value:
+					m_status = status::members;
+					return { true, nullptr };
 				case token::index_of<close_brace_token>::value:
 					m_status = status::end;
 					return { true, nullptr };
@@ -511,11 +1409,12 @@ shift_result object_rule::shift(token&& tk)
 
 shift_result object_rule::shift(node&& n)
 {
-	if (m_status != status::members)
+	if (m_status != status::first && m_status != status::members)
 		return { false, nullptr };
 	if(n.index() != node::index_of<pair_node>::value)
 		return { false, nullptr };
 	m_members.emplace_back(std::move(n.get<pair_node>()));
+	m_status = status::separator;
 	return { true, nullptr };
 }
 
@@ -523,7 +1422,9 @@ node object_rule::reduce()
 {
 	if (m_status != status::end)
 		corecpp::throws<syntax_error>("close_brace_token expected");
-	return object_node { std::move(m_members) };
+	object_node object { std::move(m_members) };
+	object.index.update(object.members);
+	return object;
 }
 
 
@@ -532,22 +1433,26 @@ shift_result array_rule::shift(token&& tk)
 	switch (m_status)
 	{
 		case status::start:
-		{
-			switch (tk.index())
+			if (tk.index() != token::index_of<open_bracket_token>::value)
+				return { false, nullptr };
+			m_status = status::first;
+			return { true, nullptr };
+		case status::first:
+			if (tk.index() == token::index_of<close_bracket_token>::value)
 			{
-				case token::index_of<open_bracket_token>::value:
-					m_status = status::members;
-					return { true, rule { value_rule {} } };
-				default:
-					return { false, nullptr };
+				m_status = status::end;
+				return { true, nullptr };
 			}
-		}
+			return { false, rule { value_rule {} } };
 		case status::members:
+			return { false, rule { value_rule {} } };
+		case status::separator:
 		{
 			switch (tk.index())
 			{
-				case token::index_of<colon_token>::value:
-					return { true, rule { value_rule {} } };
+				case token::index_of<comma_token>::value:
+					m_status = status::members;
+					return { true, nullptr };
 				case token::index_of<close_bracket_token>::value:
 					m_status = status::end;
 					return { true, nullptr };
@@ -563,8 +1468,9 @@ shift_result array_rule::shift(token&& tk)
 
 shift_result array_rule::shift(node&& n)
 {
-	if (m_status != status::members)
+	if (m_status != status::first && m_status != status::members)
 		return { false, nullptr };
+	m_status = status::separator;
 	switch(n.index())
 	{
 		case node::index_of<object_node>::value:
@@ -579,6 +1485,9 @@ shift_result array_rule::shift(node&& n)
 		case node::index_of<integral_node>::value:
 			m_values.emplace_back(std::move(n.get<integral_node>()));
 			return { true, nullptr };
+		case node::index_of<unsigned_node>::value:
+			m_values.emplace_back(std::move(n.get<unsigned_node>()));
+			return { true, nullptr };
 		case node::index_of<numeric_node>::value:
 			m_values.emplace_back(std::move(n.get<numeric_node>()));
 			return { true, nullptr };
@@ -591,6 +1500,9 @@ shift_result array_rule::shift(node&& n)
 		case node::index_of<null_node>::value:
 			m_values.emplace_back(std::move(n.get<null_node>()));
 			return { true, nullptr };
+		case node::index_of<utf8_string_node>::value:
+			m_values.emplace_back(std::move(n.get<utf8_string_node>()));
+			return { true, nullptr };
 		default:
 			return { false, nullptr };
 	}
@@ -609,10 +1521,14 @@ shift_result pair_rule::shift(token&& tk)
 	switch(m_status)
 	{
 		case status::start:
-			if(tk.index() != token::index_of<string_token>::value)
+			if(tk.index() != token::index_of<string_token>::value
+				&& tk.index() != token::index_of<string_view_token>::value)
 				return { false, nullptr };
 			m_status = status::name;
-			m_name = tk.get<string_token>().value;
+			if (tk.index() == token::index_of<string_token>::value)
+				m_name = std::move(tk.get<string_token>().value);
+			else
+				read_string(tk.get<string_view_token>(), m_name);
 			return { true, nullptr };
 		case status::name:
 			if(tk.index() != token::index_of<colon_token>::value)
@@ -648,6 +1564,10 @@ shift_result pair_rule::shift(node&& n)
 			m_value = value_node { n.get<integral_node>() };
 			m_status = status::value;
 			return { true, nullptr };
+		case node::index_of<unsigned_node>::value:
+			m_value = value_node { n.get<unsigned_node>() };
+			m_status = status::value;
+			return { true, nullptr };
 		case node::index_of<numeric_node>::value:
 			m_value = value_node { n.get<numeric_node>() };
 			m_status = status::value;
@@ -664,6 +1584,10 @@ shift_result pair_rule::shift(node&& n)
 			m_value = value_node { n.get<null_node>() };
 			m_status = status::value;
 			return { true, nullptr };
+		case node::index_of<utf8_string_node>::value:
+			m_value = value_node { std::move(n.get<utf8_string_node>()) };
+			m_status = status::value;
+			return { true, nullptr };
 		default:
 			return { true, nullptr };
 	}
@@ -686,6 +1610,8 @@ node pair_rule::reduce()
 
 shift_result value_rule::shift(token&& tk)
 {
+	if (m_value.index() != corecpp::variant<std::nullptr_t, value_node>::index_of<std::nullptr_t>::value)
+		return { false, nullptr };
 	switch (tk.index())
 	{
 		case token::index_of<open_brace_token>::value:
@@ -693,7 +1619,10 @@ shift_result value_rule::shift(token&& tk)
 		case token::index_of<open_bracket_token>::value:
 			return { false, rule { array_rule {} } };
 		case token::index_of<string_token>::value:
-			m_value = value_node { string_node { tk.get<string_token>().value } };
+			m_value = value_node { string_node { std::move(tk.get<string_token>().value) } };
+			return { true, nullptr };
+		case token::index_of<string_view_token>::value:
+			m_value = value_node { utf8_string_node { std::string { tk.get<string_view_token>().value } } };
 			return { true, nullptr };
 		case token::index_of<numeric_token>::value:
 			m_value = value_node { numeric_node { tk.get<numeric_token>().value } };
@@ -701,6 +1630,9 @@ shift_result value_rule::shift(token&& tk)
 		case token::index_of<integral_token>::value:
 			m_value = value_node { integral_node { tk.get<integral_token>().value } };
 			return { true, nullptr };
+		case token::index_of<unsigned_token>::value:
+			m_value = value_node { unsigned_node { tk.get<unsigned_token>().value } };
+			return { true, nullptr };
 		case token::index_of<null_token>::value:
 			m_value = value_node { null_node { } };
 			return { true, nullptr };
@@ -747,29 +1679,38 @@ node value_rule::reduce()
 
 void parser::push(token&& tk)
 {
-	auto pushed = m_stack.back().visit([&tk](auto& r) -> shift_result { return r.shift(std::move(tk)); });
+	/* the rules build a string_node from a string_token and an utf8_string_node from a string_view_token */
+	if (m_encoding == encoding::wide && tk.index() == token::index_of<string_view_token>::value)
+	{
+		string_token str;
+		read_string(tk.get<string_view_token>(), str.value);
+		tk = std::move(str);
+	}
+	else if (m_encoding == encoding::utf8 && tk.index() == token::index_of<string_token>::value)
+	{
+		read_string(tk.get<string_token>(), m_literal);
+		tk = string_view_token { m_literal };
+	}
+	auto shift = [&tk](auto& r) -> shift_result { return r.shift(std::move(tk)); };
+	auto pushed = m_stack.back().visit(shift);
 	while (!pushed.eaten)
 	{
-		if (pushed.next_rule.index() == corecpp::variant<std::nullptr_t, value_node>::index_of<std::nullptr_t>::value)
+		if (pushed.next_rule.index() == corecpp::variant<std::nullptr_t, rule>::index_of<std::nullptr_t>::value)
 		{
+			/* the rule on top is complete : its node goes to the enclosing rule */
 			node n = m_stack.back().visit([](auto& r) -> node { return r.reduce(); });
 			m_stack.pop_back();
 			if (m_stack.empty())
 				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ __func__," unexpected token : ", to_string(tk)}));
-			pushed = m_stack.back().visit([&n](auto& r) -> shift_result { return r.shift(std::move(n)); });
-			if (!pushed.eaten)
+			auto reduced = m_stack.back().visit([&n](auto& r) -> shift_result { return r.shift(std::move(n)); });
+			if (!reduced.eaten)
 				corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ __func__," unexpected token : ", to_string(tk)}));
-			if (pushed.next_rule.index() == corecpp::variant<std::nullptr_t, value_node>::index_of<std::nullptr_t>::value)
-				m_stack.emplace_back(std::move(pushed.next_rule.get<rule>()));
-			pushed = m_stack.back().visit([&tk](auto& r) -> shift_result { return r.shift(std::move(tk)); });
 		}
 		else
-		{
 			m_stack.emplace_back(std::move(pushed.next_rule.get<rule>()));
-			pushed = m_stack.back().visit([&tk](auto& r) -> shift_result { return r.shift(std::move(tk)); });
-		}
+		pushed = m_stack.back().visit(shift);
 	}
-	if (pushed.next_rule.index() == corecpp::variant<std::nullptr_t, value_node>::index_of<std::nullptr_t>::value)
+	if (pushed.next_rule.index() != corecpp::variant<std::nullptr_t, rule>::index_of<std::nullptr_t>::value)
 		m_stack.emplace_back(std::move(pushed.next_rule.get<rule>()));
 }
 
@@ -781,199 +1722,151 @@ node parser::end(void)
 		m_stack.pop_back();
 		if (m_stack.empty())
 			return n;
-		auto pushed = m_stack.back().visit([&n](auto& r) -> shift_result { return r.shift(std::move(n)); });
-		if (!pushed.eaten)
+		auto reduced = m_stack.back().visit([&n](auto& r) -> shift_result { return r.shift(std::move(n)); });
+		if (!reduced.eaten)
 			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ __func__," unable to reduce node"}));
-		if (pushed.next_rule.index() == corecpp::variant<std::nullptr_t, value_node>::index_of<std::nullptr_t>::value)
-			m_stack.emplace_back(std::move(pushed.next_rule.get<rule>()));
 	}
 }
 
 
-void serializer::convert_and_escape(const std::string& value)
+void read_string(const string_token& wstr, std::string& value)
 {
-	static const char hex_chars[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-	for(unsigned char c : value)
+	/* strings are utf-8, whatever the current locale. Encoded in place, to keep the capacity of value */
+	value.clear();
+	for (wchar_t c : wstr.value)
 	{
-		if (std::isprint((char)c))
-		{
-			if ( (char)c == '\\' || (char)c == '\"' )
-				m_stream << '\\';
-			m_stream << (char)c;
-		}
-		else if (c < 0x10)
-			m_stream << "\\u000" << hex_chars[c & 0x0F];
-		else
-			m_stream << "\\u00" << hex_chars[(c & 0xF0) >> 4] << hex_chars[c & 0x0F];
+		auto code = static_cast<char32_t>(c);
+		if (code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF))
+			corecpp::throws<std::runtime_error>("conversion error");
+		append_utf8(value, code);
 	}
 }
 
 
-void serializer::convert_and_escape(const std::wstring& value)
+void read_string(const string_token& wstr, std::wstring& value)
 {
-	static const char hex_chars[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-	/* TODO: support not only UTF8 */
-	for (wchar_t c : value)
-	{
-		if ((c > 0) &&  std::isprint((char)c))
-		{
-			if ( (char)c == '\\' || (char)c == '\"' )
-				m_stream << '\\';
-			m_stream << (char)c;
-		}
-		else if (c < 0x10)
-			m_stream << "\\u000" << hex_chars[c & 0x0F];
-		else if (c < 0x100)
-			m_stream << "\\u00" << hex_chars[(c & 0xF0) >> 4] << hex_chars[c & 0x0F];
-		else if (c <= 0x7FF)
-		{
-			m_stream << (c >> 6) + 0xC0;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else if (c <= 0xFFFF)
-		{
-			m_stream << (c >> 12) + 0xE0;
-			m_stream << ((c >> 6) & 0x3F) + 0x80;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else if (c <= 0x10FFFF)
-		{
-			m_stream << (c >> 18) + 0xF0;
-			m_stream << ((c >> 12) & 0x3F) + 0x80;
-			m_stream << ((c >> 6) & 0x3F) + 0x80;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else
-			corecpp::throws<std::range_error>(corecpp::concat<std::string>({ "Unable to convert charcode ", std::to_string((uint32_t)c) }));
-	}
+	value = wstr.value;
 }
 
 
-void serializer::convert_and_escape(const std::u16string& value)
+void read_string(const string_token& wstr, std::u16string& value)
 {
-	static const char hex_chars[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-	/* TODO: support not only UTF8 */
-	for (char16_t c : value)
-	{
-		if ((c > 0) &&  std::isprint((char)c))
-		{
-			if ( (char)c == '\\' || (char)c == '\"' )
-				m_stream << '\\';
-			m_stream << (char)c;
-		}
-		else if (c < 0x10)
-			m_stream << "\\u000" << hex_chars[c & 0x0F];
-		else if (c < 0x100)
-			m_stream << "\\u00" << hex_chars[(c & 0xF0) >> 4] << hex_chars[c & 0x0F];
-		else if (c <= 0x7FF)
-		{
-			m_stream << (c >> 6) + 0xC0;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else if (c <= 0xFFFF)
-		{
-			m_stream << (c >> 12) + 0xE0;
-			m_stream << ((c >> 6) & 0x3F) + 0x80;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else
-			corecpp::throws<std::range_error>(corecpp::concat<std::string>({ "Unable to convert charcode ", std::to_string((uint32_t)c) }));
-	}
+	const wchar_t* wchar = wstr.value.data();
+	std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> convw;
+	auto u8 = convw.to_bytes(wchar, wchar + wstr.value.size());
+	std::wstring_convert<std::codecvt_utf8<char16_t>, char16_t> conv16;
+	value = conv16.from_bytes(u8);
 }
 
 
-void serializer::convert_and_escape(const std::u32string& value)
+void read_string(const string_token& wstr, std::u32string& value)
 {
-	static const char hex_chars[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'A', 'B', 'C', 'D', 'E', 'F' };
-	/* TODO: support not only UTF8 */
-	for (char32_t c : value)
-	{
-		if ((c > 0) &&  std::isprint((char)c))
-		{
-			if ( (char)c == '\\' || (char)c == '\"' )
-				m_stream << '\\';
-			m_stream << (char)c;
-		}
-		else if (c < 0x10)
-			m_stream << "\\u000" << hex_chars[c & 0x0F];
-		else if (c < 0x100)
-			m_stream << "\\u00" << hex_chars[(c & 0xF0) >> 4] << hex_chars[c & 0x0F];
-		else if (c <= 0x7FF)
-		{
-			m_stream << (c >> 6) + 0xC0;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else if (c <= 0xFFFF)
-		{
-			m_stream << (c >> 12) + 0xE0;
-			m_stream << ((c >> 6) & 0x3F) + 0x80;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else if (c <= 0x10FFFF)
-		{
-			m_stream << (c >> 18) + 0xF0;
-			m_stream << ((c >> 12) & 0x3F) + 0x80;
-			m_stream << ((c >> 6) & 0x3F) + 0x80;
-			m_stream << (c & 0x3F) + 0x80;
-		}
-		else
-			corecpp::throws<std::range_error>(corecpp::concat<std::string>({ "Unable to convert charcode ", std::to_string((uint32_t)c) }));
-	}
+	const wchar_t* wchar = wstr.value.data();
+	std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> convw;
+	auto u8 = convw.to_bytes(wchar, wchar + wstr.value.size());
+	std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv32;
+	value = conv32.from_bytes(u8);
 }
 
 
-void deserializer::read_string(const string_token& wstr, std::string& value)
+void read_string(const string_view_token& str, std::string& value)
 {
-	const wchar_t* wchar = wstr.value.data();
-	std::mbstate_t state = std::mbstate_t();
-	auto len = std::wcsrtombs(nullptr, &wchar, 0, &state);
-	if (len == static_cast<std::size_t>(-1))
-		corecpp::throws<std::runtime_error>("converion error");
-	value.resize(len);
-	std::wcsrtombs((char*)value.data(), &wchar, len, &state);
+	value.assign(str.value);
 }
 
 
-void deserializer::read_string(const string_token& wstr, std::u16string& value)
+void read_string(const string_view_token& str, std::wstring& value)
 {
-	const wchar_t* wchar = wstr.value.data();
-	std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> convw;
-	auto u8 = convw.to_bytes(wchar, wchar + wstr.value.size());
-	std::wstring_convert<std::codecvt_utf8<char16_t>, char16_t> conv16;
-	value = conv16.from_bytes(u8);
+	value = std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(str.value.data(), str.value.data() + str.value.size());
 }
 
 
-void deserializer::read_string(const string_token& wstr, std::u32string& value)
+void read_string(const string_view_token& str, std::u16string& value)
 {
-	const wchar_t* wchar = wstr.value.data();
-	std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t> convw;
-	auto u8 = convw.to_bytes(wchar, wchar + wstr.value.size());
-	std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t> conv32;
-	value = conv32.from_bytes(u8);
+	value = std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>().from_bytes(str.value.data(), str.value.data() + str.value.size());
+}
+
+
+void read_string(const string_view_token& str, std::u32string& value)
+{
+	value = std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>().from_bytes(str.value.data(), str.value.data() + str.value.size());
+}
+
+
+void deserializer::read_token()
+{
+	/* the tokenizer waits for the stream: anything but a token means the stream has ended */
+	if (m_tokenizer.next(m_current) != token_status::ready)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(m_tokenizer.offset()) }));
 }
 
 
-void deserializer::read()
+bool deserializer::next_document()
 {
-	// 1st try, no read
-	auto token = m_tokenizer.next();
-	if (token)
+	m_first = true;
+	switch (m_tokenizer.next(m_current))
 	{
-		json_logger().trace("read token", to_string(*token), __FILE__, __LINE__);
-		m_current = std::move(*token);
-		return;
+		case token_status::ready:
+			return true;
+		case token_status::end:
+			return false;
+		case token_status::need_more:
+		default:
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(m_tokenizer.offset()) }));
+	}
+}
+
+
+void buffer_deserializer::read_token()
+{
+	switch (m_tokenizer.next(m_current))
+	{
+		case token_status::ready:
+			return;
+		case token_status::need_more:
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(m_tokenizer.offset()) }));
+		case token_status::end:
+		default:
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(m_tokenizer.offset()) }));
 	}
-	do
+}
+
+
+bool buffer_deserializer::next_document()
+{
+	m_first = true;
+	switch (m_tokenizer.next(m_current))
+	{
+		case token_status::ready:
+			return true;
+		case token_status::need_more:
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(m_tokenizer.offset()) }));
+		case token_status::end:
+		default:
+			return false;
+	}
+}
+
+
+void reader::read_token()
+{
+	if (m_tokenizer.next(m_current) != token_status::ready)
+		corecpp::throws<std::runtime_error>("eof reached unexpectedly");
+}
+
+
+void buffer_reader::read_token()
+{
+	switch (m_tokenizer.next(m_current))
 	{
-		if (m_stream.eof())
+		case token_status::ready:
+			return;
+		case token_status::need_more:
+			corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated document at offset ", std::to_string(m_tokenizer.offset()) }));
+		case token_status::end:
+		default:
 			corecpp::throws<std::runtime_error>("eof reached unexpectedly");
-		m_stream.peek(); /* does this block until next caracters are available?  */
-		token = m_tokenizer.next();
 	}
-	while (!token);
-	json_logger().trace("read token", to_string(*token), __FILE__, __LINE__);
-	m_current = std::move(*token);
 }
 
 
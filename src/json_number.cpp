@@ -0,0 +1,109 @@
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+#include "json_number.h"
+
+namespace corecpp::json::details
+{
+
+namespace
+{
+	inline bool is_digit(char c) noexcept
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	/* correctly rounded conversion of a validated json number */
+	double to_double(const char* begin, const char* end)
+	{
+		double value;
+		auto result = std::from_chars(begin, end, value);
+		if (result.ec == std::errc())
+			return value;
+		/* out of the range of double : let strtod choose between infinity and zero */
+		std::string copy { begin, end };
+		return std::strtod(copy.c_str(), nullptr);
+	}
+}
+
+const char* parse_number(const char* begin, const char* end, token& tk)
+{
+	const char* pos = begin;
+	bool negative = false;
+	bool integral = true;
+	bool overflow = false;
+	std::uint64_t value = 0;
+
+	if (*pos == '-')
+	{
+		negative = true;
+		if (++pos == end)
+			return nullptr;
+	}
+	if (!is_digit(*pos))
+		return begin;
+	/* the grammar forbids leading zeros */
+	if (*pos == '0' && pos + 1 != end && is_digit(pos[1]))
+		return begin;
+	/* at most 19 digits cannot overflow, check the next ones */
+	for (const char* safe_end = (end - pos > 19) ? pos + 19 : end; pos != safe_end && is_digit(*pos); ++pos)
+		value = 10 * value + (*pos - '0');
+	for (; pos != end && is_digit(*pos); ++pos)
+	{
+		unsigned int digit = *pos - '0';
+		if (value > (std::numeric_limits<std::uint64_t>::max() - digit) / 10)
+			overflow = true;
+		else
+			value = 10 * value + digit;
+	}
+	if (pos != end && *pos == '.')
+	{
+		integral = false;
+		if (++pos == end)
+			return nullptr;
+		if (!is_digit(*pos))
+			return begin;
+		while (pos != end && is_digit(*pos))
+			++pos;
+	}
+	if (pos != end && (*pos == 'e' || *pos == 'E'))
+	{
+		integral = false;
+		if (++pos != end && (*pos == '-' || *pos == '+'))
+			++pos;
+		if (pos == end)
+			return nullptr;
+		if (!is_digit(*pos))
+			return begin;
+		while (pos != end && is_digit(*pos))
+			++pos;
+	}
+
+	if (integral && !overflow)
+	{
+		constexpr std::uint64_t max_int64 = std::numeric_limits<std::int64_t>::max();
+		if (!negative && value <= max_int64)
+		{
+			tk = integral_token { static_cast<std::int64_t>(value) };
+			return pos;
+		}
+		if (!negative)
+		{
+			tk = unsigned_token { value };
+			return pos;
+		}
+		if (value <= max_int64 + 1)
+		{
+			/* the sign is kept along with the value, so that -0 is read as -0.0 by the floating point types */
+			tk = integral_token { static_cast<std::int64_t>(0 - value), true };
+			return pos;
+		}
+	}
+	tk = numeric_token { to_double(begin, pos) };
+	return pos;
+}
+
+}
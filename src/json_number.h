@@ -0,0 +1,26 @@
+#ifndef CORECPP_SRC_JSON_NUMBER_H
+#define CORECPP_SRC_JSON_NUMBER_H
+
+#include <corecpp/serialization/json.h>
+
+namespace corecpp::json::details
+{
+	/**
+	 * \brief tells if c may be part of a json number
+	 */
+	inline bool is_number_char(char c) noexcept
+	{
+		return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+	}
+
+	/**
+	 * \brief parse the json number at the begining of [begin, end) into tk
+	 * \return a pointer past the last char of the number, nullptr if [begin, end) ends in the middle
+	 * of the number (e.g. "-" or "1e+"), or begin if it does not follow the json grammar.
+	 * \remark integers are exact over the whole int64_t and uint64_t ranges. Integers out of these ranges
+	 * are given as numeric_token, like the other numbers, which are correctly rounded.
+	 */
+	const char* parse_number(const char* begin, const char* end, token& tk);
+}
+
+#endif
@@ -0,0 +1,420 @@
+#include <cstdint>
+#include <cstring>
+
+#include "json_scan.h"
+
+/* CORECPP_NO_SIMD forces the portable implementation */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__SSE2__)) && !defined(CORECPP_NO_SIMD)
+#define CORECPP_JSON_SSE2
+#define CORECPP_JSON_AVX2
+#include <immintrin.h>
+#endif
+
+namespace corecpp::json::details
+{
+
+namespace
+{
+	inline bool is_string_delimiter(char c) noexcept
+	{
+		return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+	}
+
+	inline bool is_blank(char c) noexcept
+	{
+		return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+	}
+
+	/*
+	 * PORTABLE IMPLEMENTATION
+	 * 8 bytes at a time, using the classical "has zero byte" bit tricks
+	 */
+	const char* find_string_delimiter_portable(const char* begin, const char* end) noexcept
+	{
+		constexpr std::uint64_t ones = 0x0101010101010101ull;
+		constexpr std::uint64_t highs = 0x8080808080808080ull;
+		for (; end - begin >= 8; begin += 8)
+		{
+			std::uint64_t v;
+			std::memcpy(&v, begin, sizeof(v));
+			std::uint64_t quote = v ^ (ones * '"');
+			std::uint64_t backslash = v ^ (ones * '\\');
+			std::uint64_t found = ((quote - ones) & ~quote)
+				| ((backslash - ones) & ~backslash)
+				| ((v - ones * 0x20) & ~v);
+			if (found & highs)
+				break;
+		}
+		while (begin != end && !is_string_delimiter(*begin))
+			++begin;
+		return begin;
+	}
+
+	const char* skip_blanks_portable(const char* begin, const char* end) noexcept
+	{
+		while (begin != end && is_blank(*begin))
+			++begin;
+		return begin;
+	}
+
+#ifdef CORECPP_JSON_SSE2
+	/*
+	 * SSE2 IMPLEMENTATION
+	 */
+	const char* find_string_delimiter_sse2(const char* begin, const char* end) noexcept
+	{
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		const __m128i control = _mm_set1_epi8(0x1F);
+		for (; end - begin >= 16; begin += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			__m128i found = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)),
+				_mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+			int mask = _mm_movemask_epi8(found);
+			if (mask)
+				return begin + __builtin_ctz(mask);
+		}
+		return find_string_delimiter_portable(begin, end);
+	}
+
+	const char* skip_blanks_sse2(const char* begin, const char* end) noexcept
+	{
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i tab = _mm_set1_epi8('\t');
+		const __m128i lf = _mm_set1_epi8('\n');
+		const __m128i cr = _mm_set1_epi8('\r');
+		for (; end - begin >= 16; begin += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+			__m128i blanks = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, space), _mm_cmpeq_epi8(v, tab)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, lf), _mm_cmpeq_epi8(v, cr)));
+			int mask = ~_mm_movemask_epi8(blanks) & 0xFFFF;
+			if (mask)
+				return begin + __builtin_ctz(mask);
+		}
+		return skip_blanks_portable(begin, end);
+	}
+#endif
+
+#ifdef CORECPP_JSON_AVX2
+	/*
+	 * AVX2 IMPLEMENTATION
+	 * only selected at runtime, when the cpu supports it
+	 */
+	__attribute__((target("avx2")))
+	const char* find_string_delimiter_avx2(const char* begin, const char* end) noexcept
+	{
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i control = _mm256_set1_epi8(0x1F);
+		for (; end - begin >= 32; begin += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+			__m256i found = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, backslash)),
+				_mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v));
+			unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(found));
+			if (mask)
+				return begin + __builtin_ctz(mask);
+		}
+		return find_string_delimiter_sse2(begin, end);
+	}
+
+	__attribute__((target("avx2")))
+	const char* skip_blanks_avx2(const char* begin, const char* end) noexcept
+	{
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i tab = _mm256_set1_epi8('\t');
+		const __m256i lf = _mm256_set1_epi8('\n');
+		const __m256i cr = _mm256_set1_epi8('\r');
+		for (; end - begin >= 32; begin += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+			__m256i blanks = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, space), _mm256_cmpeq_epi8(v, tab)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, lf), _mm256_cmpeq_epi8(v, cr)));
+			unsigned int mask = ~static_cast<unsigned int>(_mm256_movemask_epi8(blanks));
+			if (mask)
+				return begin + __builtin_ctz(mask);
+		}
+		return skip_blanks_sse2(begin, end);
+	}
+
+	bool has_avx2() noexcept
+	{
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+	}
+#endif
+
+	/*
+	 * STRUCTURAL INDEX
+	 * Each block of 64 chars is summarized as bit masks, bit i standing for its char i.
+	 */
+	struct block_masks
+	{
+		std::uint64_t quote;
+		std::uint64_t backslash;
+		std::uint64_t structural; /* { } [ ] : , */
+	};
+
+	inline bool is_structural(char c) noexcept
+	{
+		return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' || c == ',';
+	}
+
+#ifndef CORECPP_JSON_SSE2
+	void classify_portable(const char* block, block_masks& masks) noexcept
+	{
+		masks = block_masks { 0, 0, 0 };
+		for (unsigned int i = 0; i < 64; ++i)
+		{
+			std::uint64_t bit = std::uint64_t { 1 } << i;
+			if (block[i] == '"')
+				masks.quote |= bit;
+			else if (block[i] == '\\')
+				masks.backslash |= bit;
+			else if (is_structural(block[i]))
+				masks.structural |= bit;
+		}
+	}
+#endif
+
+#ifdef CORECPP_JSON_SSE2
+	void classify_sse2(const char* block, block_masks& masks) noexcept
+	{
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i backslash = _mm_set1_epi8('\\');
+		/* '[' | 0x20 == '{' and ']' | 0x20 == '}' */
+		const __m128i lower = _mm_set1_epi8(0x20);
+		const __m128i open = _mm_set1_epi8('{');
+		const __m128i close = _mm_set1_epi8('}');
+		const __m128i colon = _mm_set1_epi8(':');
+		const __m128i comma = _mm_set1_epi8(',');
+		masks = block_masks { 0, 0, 0 };
+		for (unsigned int i = 0; i < 64; i += 16)
+		{
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+			__m128i folded = _mm_or_si128(v, lower);
+			__m128i structural = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+				_mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+			masks.quote |= static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote))) << i;
+			masks.backslash |= static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash))) << i;
+			masks.structural |= static_cast<std::uint64_t>(_mm_movemask_epi8(structural)) << i;
+		}
+	}
+#endif
+
+#ifdef CORECPP_JSON_AVX2
+	__attribute__((target("avx2")))
+	void classify_avx2(const char* block, block_masks& masks) noexcept
+	{
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i backslash = _mm256_set1_epi8('\\');
+		const __m256i lower = _mm256_set1_epi8(0x20);
+		const __m256i open = _mm256_set1_epi8('{');
+		const __m256i close = _mm256_set1_epi8('}');
+		const __m256i colon = _mm256_set1_epi8(':');
+		const __m256i comma = _mm256_set1_epi8(',');
+		masks = block_masks { 0, 0, 0 };
+		for (unsigned int i = 0; i < 64; i += 32)
+		{
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+			__m256i folded = _mm256_or_si256(v, lower);
+			__m256i structural = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)),
+				_mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+			masks.quote |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << i;
+			masks.backslash |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << i;
+			masks.structural |= static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(structural))) << i;
+		}
+	}
+#endif
+
+	using classify_function = void (*)(const char*, block_masks&) noexcept;
+
+	classify_function select_classify() noexcept
+	{
+#if defined(CORECPP_JSON_AVX2)
+		if (has_avx2())
+			return &classify_avx2;
+#endif
+#if defined(CORECPP_JSON_SSE2)
+		return &classify_sse2;
+#else
+		return &classify_portable;
+#endif
+	}
+
+	/* bit i of the result is the xor of the bits 0 to i of x */
+	inline std::uint64_t prefix_xor(std::uint64_t x) noexcept
+	{
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+		return x;
+	}
+
+	/* chars escaped by a backslash. escaping tells if the first char is escaped by the end of the previous block,
+	 * and is updated for the next one */
+	inline std::uint64_t escaped_chars(std::uint64_t backslash, bool& escaping) noexcept
+	{
+		std::uint64_t escaped = escaping ? 1 : 0;
+		backslash &= ~escaped;
+		escaping = false;
+		while (backslash)
+		{
+			int i = __builtin_ctzll(backslash);
+			if (i == 63)
+			{
+				escaping = true;
+				break;
+			}
+			escaped |= std::uint64_t { 2 } << i;
+			/* an escaped backslash does not escape the next char */
+			backslash &= ~(std::uint64_t { 3 } << i);
+		}
+		return escaped;
+	}
+
+	using scan_function = const char* (*)(const char*, const char*) noexcept;
+
+	scan_function select_find_string_delimiter() noexcept
+	{
+#if defined(CORECPP_JSON_AVX2)
+		if (has_avx2())
+			return &find_string_delimiter_avx2;
+#endif
+#if defined(CORECPP_JSON_SSE2)
+		return &find_string_delimiter_sse2;
+#else
+		return &find_string_delimiter_portable;
+#endif
+	}
+
+	scan_function select_skip_blanks() noexcept
+	{
+#if defined(CORECPP_JSON_AVX2)
+		if (has_avx2())
+			return &skip_blanks_avx2;
+#endif
+#if defined(CORECPP_JSON_SSE2)
+		return &skip_blanks_sse2;
+#else
+		return &skip_blanks_portable;
+#endif
+	}
+}
+
+const char* find_string_delimiter(const char* begin, const char* end) noexcept
+{
+	static const scan_function impl = select_find_string_delimiter();
+	return impl(begin, end);
+}
+
+bool index_structurals(const char* begin, const char* end, std::vector<std::uint32_t>& positions)
+{
+	static const classify_function classify = select_classify();
+	block_masks masks;
+	bool escaping = false;
+	std::uint64_t in_string = 0; /* all ones when the previous block ended inside a string */
+	char padded[64];
+
+	for (const char* block = begin; block < end; block += 64)
+	{
+		if (end - block >= 64)
+			classify(block, masks);
+		else
+		{
+			std::memset(padded, ' ', sizeof(padded));
+			std::memcpy(padded, block, end - block);
+			classify(padded, masks);
+		}
+		std::uint64_t escaped = (masks.backslash || escaping) ? escaped_chars(masks.backslash, escaping) : 0;
+		std::uint64_t quotes = masks.quote & ~escaped;
+		/* set from an opening quote (included) to the closing one (excluded) */
+		std::uint64_t strings = prefix_xor(quotes) ^ in_string;
+		in_string = static_cast<std::uint64_t>(static_cast<std::int64_t>(strings) >> 63);
+		std::uint64_t found = (masks.structural & ~strings) | quotes;
+		auto offset = static_cast<std::uint32_t>(block - begin);
+		while (found)
+		{
+			positions.push_back(offset + __builtin_ctzll(found));
+			found &= found - 1;
+		}
+	}
+	return !in_string;
+}
+
+const char* find_invalid_utf8(const char* begin, const char* end) noexcept
+{
+	constexpr std::uint64_t highs = 0x8080808080808080ull;
+	while (begin != end)
+	{
+		/* ascii runs, 16 bytes at a time */
+		for (; end - begin >= 16; begin += 16)
+		{
+			std::uint64_t v[2];
+			std::memcpy(v, begin, sizeof(v));
+			if ((v[0] | v[1]) & highs)
+				break;
+		}
+		if (begin == end)
+			break;
+		auto c = static_cast<unsigned char>(*begin);
+		if (c < 0x80)
+		{
+			++begin;
+			continue;
+		}
+		/* length of the sequence, and bounds of its second byte */
+		int length;
+		unsigned char low = 0x80, high = 0xBF;
+		if (c >= 0xC2 && c <= 0xDF)
+			length = 2;
+		else if (c >= 0xE0 && c <= 0xEF)
+		{
+			length = 3;
+			if (c == 0xE0)
+				low = 0xA0; /* overlong */
+			else if (c == 0xED)
+				high = 0x9F; /* surrogates */
+		}
+		else if (c >= 0xF0 && c <= 0xF4)
+		{
+			length = 4;
+			if (c == 0xF0)
+				low = 0x90; /* overlong */
+			else if (c == 0xF4)
+				high = 0x8F; /* above U+10FFFF */
+		}
+		else
+			return begin;
+		if (end - begin < length)
+			return begin;
+		auto second = static_cast<unsigned char>(begin[1]);
+		if (second < low || second > high)
+			return begin;
+		for (int i = 2; i < length; ++i)
+		{
+			if ((static_cast<unsigned char>(begin[i]) & 0xC0) != 0x80)
+				return begin;
+		}
+		begin += length;
+	}
+	return end;
+}
+
+const char* skip_blanks(const char* begin, const char* end) noexcept
+{
+	/* most of the time, there is no blank at all or a single one: no need for the vectorized version */
+	if (begin == end || !is_blank(*begin))
+		return begin;
+	if (++begin == end || !is_blank(*begin))
+		return begin;
+	static const scan_function impl = select_skip_blanks();
+	return impl(begin, end);
+}
+
+}
@@ -0,0 +1,40 @@
+#ifndef CORECPP_SRC_JSON_SCAN_H
+#define CORECPP_SRC_JSON_SCAN_H
+
+#include <cstdint>
+#include <vector>
+
+namespace corecpp::json::details
+{
+	/**
+	 * \brief find the first char of [begin, end) that ends a clean run of a string literal,
+	 * that is a quote, a backslash or a control character (below 0x20)
+	 * \return a pointer to that char, or end if there is none
+	 * \remark uses AVX2 or SSE2 when available, and falls back to a portable implementation otherwise
+	 */
+	const char* find_string_delimiter(const char* begin, const char* end) noexcept;
+
+	/**
+	 * \brief find the first byte of [begin, end) which does not belong to a valid utf-8 sequence
+	 * \return a pointer to that byte, or end if [begin, end) is valid utf-8
+	 * \remark overlong forms, surrogates and code points above U+10FFFF are invalid
+	 */
+	const char* find_invalid_utf8(const char* begin, const char* end) noexcept;
+
+	/**
+	 * \brief skip the json blanks (space, tab, line feed and carriage return) at the begining of [begin, end)
+	 * \return a pointer to the first char which is not a blank, or end if there is none
+	 */
+	const char* skip_blanks(const char* begin, const char* end) noexcept;
+
+	/**
+	 * \brief append to positions the offsets of the structural chars of [begin, end): the unescaped quotes,
+	 * and the braces, brackets, colons and commas which are not part of a string literal
+	 * \return false if [begin, end) ends inside a string literal
+	 * \remark the text is processed by blocks of 64 chars, with AVX2 or SSE2 when available. Nothing but the string
+	 * literal boundaries is validated. The offsets must fit in 32 bits.
+	 */
+	bool index_structurals(const char* begin, const char* end, std::vector<std::uint32_t>& positions);
+}
+
+#endif
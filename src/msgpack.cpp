@@ -0,0 +1,269 @@
+#include <codecvt>
+#include <cstring>
+#include <locale>
+
+#include <corecpp/serialization/msgpack.h>
+
+
+namespace corecpp::msgpack
+{
+
+std::uint8_t deserializer::read_byte()
+{
+	if (m_current == m_end)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(offset()) }));
+	return static_cast<std::uint8_t>(*m_current++);
+}
+
+const char* deserializer::read_bytes(std::size_t size)
+{
+	if (static_cast<std::size_t>(m_end - m_current) < size)
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "truncated message at offset ", std::to_string(offset()) }));
+	const char* bytes = m_current;
+	m_current += size;
+	return bytes;
+}
+
+void deserializer::unexpected(const char* expected, std::uint8_t marker) const
+{
+	static const char hex_chars[16] = { '0', '1', '2', '3', '4', '5', '6', '7', '8', '9', 'a', 'b', 'c', 'd', 'e', 'f' };
+	const char found[] = { '0', 'x', hex_chars[marker >> 4], hex_chars[marker & 0x0F], '\0' };
+	corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ expected, " expected, got format ", found,
+		" at offset ", std::to_string(offset() - 1) }));
+}
+
+bool deserializer::read_integer(std::int64_t& signed_value, std::uint64_t& unsigned_value)
+{
+	std::uint8_t marker = read_byte();
+	if (marker < format::fixmap)
+	{
+		unsigned_value = marker;
+		return true;
+	}
+	if (marker >= format::negative_fixint)
+	{
+		signed_value = static_cast<std::int8_t>(marker);
+		return false;
+	}
+	switch (marker)
+	{
+		case format::uint8:
+			unsigned_value = read_big_endian<std::uint8_t>();
+			return true;
+		case format::uint16:
+			unsigned_value = read_big_endian<std::uint16_t>();
+			return true;
+		case format::uint32:
+			unsigned_value = read_big_endian<std::uint32_t>();
+			return true;
+		case format::uint64:
+			unsigned_value = read_big_endian<std::uint64_t>();
+			return true;
+		case format::int8:
+			signed_value = static_cast<std::int8_t>(read_big_endian<std::uint8_t>());
+			return false;
+		case format::int16:
+			signed_value = static_cast<std::int16_t>(read_big_endian<std::uint16_t>());
+			return false;
+		case format::int32:
+			signed_value = static_cast<std::int32_t>(read_big_endian<std::uint32_t>());
+			return false;
+		case format::int64:
+			signed_value = static_cast<std::int64_t>(read_big_endian<std::uint64_t>());
+			return false;
+		default:
+			unexpected("integer", marker);
+	}
+}
+
+double deserializer::read_float()
+{
+	std::uint8_t marker = static_cast<std::uint8_t>(m_current == m_end ? 0 : *m_current);
+	if (marker == format::float32)
+	{
+		++m_current;
+		std::uint32_t bits = read_big_endian<std::uint32_t>();
+		float value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+	if (marker == format::float64)
+	{
+		++m_current;
+		std::uint64_t bits = read_big_endian<std::uint64_t>();
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+	std::int64_t signed_value;
+	std::uint64_t unsigned_value;
+	if (read_integer(signed_value, unsigned_value))
+		return static_cast<double>(unsigned_value);
+	return static_cast<double>(signed_value);
+}
+
+std::string_view deserializer::read_string()
+{
+	std::uint8_t marker = read_byte();
+	std::size_t size;
+	if ((marker & 0xe0) == format::fixstr)
+		size = marker & 0x1f;
+	else if (marker == format::str8)
+		size = read_big_endian<std::uint8_t>();
+	else if (marker == format::str16)
+		size = read_big_endian<std::uint16_t>();
+	else if (marker == format::str32)
+		size = read_big_endian<std::uint32_t>();
+	else
+		unexpected("string", marker);
+	return std::string_view { read_bytes(size), size };
+}
+
+std::size_t deserializer::read_array_header()
+{
+	std::uint8_t marker = read_byte();
+	if ((marker & 0xf0) == format::fixarray)
+		return marker & 0x0f;
+	if (marker == format::array16)
+		return read_big_endian<std::uint16_t>();
+	if (marker == format::array32)
+		return read_big_endian<std::uint32_t>();
+	unexpected("array", marker);
+}
+
+std::size_t deserializer::read_map_header()
+{
+	std::uint8_t marker = read_byte();
+	if ((marker & 0xf0) == format::fixmap)
+		return marker & 0x0f;
+	if (marker == format::map16)
+		return read_big_endian<std::uint16_t>();
+	if (marker == format::map32)
+		return read_big_endian<std::uint32_t>();
+	unexpected("map", marker);
+}
+
+void deserializer::skip_value()
+{
+	/* count the values left instead of recursing, so that a deep nesting can not exhaust the stack */
+	for (std::uint64_t values = 1; values; --values)
+	{
+		std::uint8_t marker = read_byte();
+		if (marker < format::fixmap || marker >= format::negative_fixint)
+			continue;
+		if ((marker & 0xf0) == format::fixmap)
+			values += 2 * (marker & 0x0f);
+		else if ((marker & 0xf0) == format::fixarray)
+			values += marker & 0x0f;
+		else if ((marker & 0xe0) == format::fixstr)
+			read_bytes(marker & 0x1f);
+		else switch (marker)
+		{
+			case format::nil:
+			case format::false_:
+			case format::true_:
+				break;
+			case format::uint8:
+			case format::int8:
+				read_bytes(1);
+				break;
+			case format::uint16:
+			case format::int16:
+				read_bytes(2);
+				break;
+			case format::float32:
+			case format::uint32:
+			case format::int32:
+				read_bytes(4);
+				break;
+			case format::float64:
+			case format::uint64:
+			case format::int64:
+				read_bytes(8);
+				break;
+			case format::bin8:
+			case format::str8:
+				read_bytes(read_big_endian<std::uint8_t>());
+				break;
+			case format::bin16:
+			case format::str16:
+				read_bytes(read_big_endian<std::uint16_t>());
+				break;
+			case format::bin32:
+			case format::str32:
+				read_bytes(read_big_endian<std::uint32_t>());
+				break;
+			case format::ext8:
+				read_bytes(1 + read_big_endian<std::uint8_t>());
+				break;
+			case format::ext16:
+				read_bytes(1 + read_big_endian<std::uint16_t>());
+				break;
+			case format::ext32:
+				read_bytes(1 + static_cast<std::size_t>(read_big_endian<std::uint32_t>()));
+				break;
+			case format::array16:
+				values += read_big_endian<std::uint16_t>();
+				break;
+			case format::array32:
+				values += read_big_endian<std::uint32_t>();
+				break;
+			case format::map16:
+				values += 2 * static_cast<std::uint64_t>(read_big_endian<std::uint16_t>());
+				break;
+			case format::map32:
+				values += 2 * static_cast<std::uint64_t>(read_big_endian<std::uint32_t>());
+				break;
+			default:
+				if (marker >= format::fixext1 && marker <= format::fixext16)
+					read_bytes(1 + (std::size_t { 1 } << (marker - format::fixext1)));
+				else
+					unexpected("value", marker);
+		}
+	}
+}
+
+void deserializer::deserialize(bool& value)
+{
+	std::uint8_t marker = read_byte();
+	if (marker == format::true_)
+		value = true;
+	else if (marker == format::false_)
+		value = false;
+	else
+		unexpected("boolean", marker);
+}
+
+void deserializer::deserialize(std::nullptr_t)
+{
+	std::uint8_t marker = read_byte();
+	if (marker != format::nil)
+		unexpected("nil", marker);
+}
+
+void deserializer::deserialize(std::wstring& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::deserialize(std::u16string& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::deserialize(std::u32string& value)
+{
+	auto str = read_string();
+	value = std::wstring_convert<std::codecvt_utf8<char32_t>, char32_t>().from_bytes(str.data(), str.data() + str.size());
+}
+
+void deserializer::end_object()
+{
+	if (m_remaining.empty() || m_remaining.back())
+		corecpp::throws<corecpp::syntax_error>(corecpp::concat<std::string>({ "end of object expected at offset ", std::to_string(offset()) }));
+	m_remaining.pop_back();
+}
+
+}
@@ -0,0 +1,102 @@
+#include <cerrno>
+#include <system_error>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <corecpp/serialization/sink.h>
+
+namespace corecpp
+{
+
+namespace
+{
+	/* writev until every iovec has been written, resuming after partial writes */
+	void write_all(int fd, struct iovec* iov, int count)
+	{
+		while (count > 0)
+		{
+			ssize_t written = ::writev(fd, iov, count);
+			if (written < 0)
+			{
+				if (errno == EINTR)
+					continue;
+				corecpp::throws<std::system_error>(errno, std::generic_category(), "unable to write to file descriptor");
+			}
+			for (; count > 0 && static_cast<std::size_t>(written) >= iov->iov_len; ++iov, --count)
+				written -= iov->iov_len;
+			if (count > 0)
+			{
+				iov->iov_base = static_cast<char*>(iov->iov_base) + written;
+				iov->iov_len -= written;
+			}
+		}
+	}
+}
+
+void buffer_sink::overflow()
+{
+	corecpp::throws<std::length_error>("output buffer is full");
+}
+
+void fd_sink::moved_from()
+{
+	corecpp::throws<std::logic_error>("use of a moved-from fd_sink");
+}
+
+fd_sink::fd_sink(int fd, std::size_t capacity)
+: m_fd(fd), m_buffer(), m_current(), m_end()
+{
+	if (!capacity)
+		corecpp::throws<std::invalid_argument>("fd_sink capacity must not be 0");
+	m_buffer.reset(new char[capacity]);
+	m_current = m_buffer.get();
+	m_end = m_current + capacity;
+}
+
+fd_sink::~fd_sink()
+{
+	if (!m_buffer)
+		return;
+	try
+	{
+		flush();
+	}
+	catch (...)
+	{
+		/* nothing sensible to do in a destructor, call flush() explicitly to get the error */
+	}
+}
+
+void fd_sink::flush()
+{
+	if (!m_buffer)
+		moved_from();
+	struct iovec iov { m_buffer.get(), static_cast<std::size_t>(m_current - m_buffer.get()) };
+	m_current = m_buffer.get();
+	if (iov.iov_len)
+		write_all(m_fd, &iov, 1);
+}
+
+void fd_sink::write_through(const char* data, std::size_t size)
+{
+	if (!m_buffer)
+		moved_from();
+	std::size_t capacity = m_end - m_buffer.get();
+	if (size < capacity)
+	{
+		flush();
+		std::memcpy(m_current, data, size);
+		m_current += size;
+		return;
+	}
+	/* large block : write it along with the buffered chars, without copying it */
+	struct iovec iov[2] = {
+		{ m_buffer.get(), static_cast<std::size_t>(m_current - m_buffer.get()) },
+		{ const_cast<char*>(data), size }
+	};
+	m_current = m_buffer.get();
+	write_all(m_fd, iov, 2);
+}
+
+}
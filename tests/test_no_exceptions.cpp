@@ -0,0 +1,37 @@
+/* built with -fno-exceptions: the checked json api must compile, and work, without exceptions */
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <corecpp/serialization/json_checked.h>
+
+struct record
+{
+	std::int32_t id;
+	std::string name;
+	std::vector<double> values;
+
+	static const auto& properties()
+	{
+		static auto result = std::make_tuple(
+			corecpp::make_property("id", &record::id),
+			corecpp::make_property("name", &record::name),
+			corecpp::make_property("values", &record::values)
+		);
+		return result;
+	}
+};
+
+int main()
+{
+	std::vector<record> records;
+	if (!corecpp::json::try_deserialize("[{\"id\":1,\"name\":\"a\",\"values\":[1.5,2]},{\"id\":2,\"skipped\":{}}]", records))
+		return 1;
+	if (records.size() != 2 || records[0].values.size() != 2 || records[1].id != 2)
+		return 1;
+	auto result = corecpp::json::try_deserialize("[{\"id\":\"1\"}]", records);
+	if (result || result.error().code != corecpp::json::parse_errc::unexpected_token)
+		return 1;
+	return 0;
+}
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <chrono>
+#include <cstdio>
 #include <fstream>
 #include <functional>
 #include <iterator>
@@ -18,7 +20,11 @@
 #include <corecpp/flags.h>
 #include <corecpp/unittest.h>
 #include <corecpp/net/mailaddress.h>
+#include <corecpp/serialization/cbor.h>
+#include <corecpp/serialization/compact.h>
 #include <corecpp/serialization/json.h>
+#include <corecpp/serialization/json_checked.h>
+#include <corecpp/serialization/msgpack.h>
 
 using namespace corecpp;
 
@@ -61,6 +67,22 @@ std::ostream& operator << (std::ostream& oss, const structured& e)
 	return oss << e.i << " | " << e.b << " | " << e.s;
 }
 
+/* recursive type */
+struct tree
+{
+	int value;
+	std::vector<tree> children;
+
+	static const auto& properties()
+	{
+		static auto result = std::make_tuple(
+			corecpp::make_property("value", &tree::value),
+			corecpp::make_property("children", &tree::children)
+		);
+		return result;
+	}
+};
+
 
 struct complex
 {
@@ -94,6 +116,91 @@ std::ostream& operator << (std::ostream& oss, const complex& e)
 	return oss << e.real << "+" << e.imag << "i";
 }
 
+/* same as complex, with the utf-8 property names */
+struct utf8_complex : public complex
+{
+	template <typename DeserializerT>
+	void deserialize(DeserializerT& d, std::string_view property)
+	{
+		if (property == "real_part")
+			d.deserialize(real);
+		else if (property == "imaginary_part")
+			d.deserialize(imag);
+		else
+			throw std::runtime_error("invalid property");
+	}
+};
+
+/* hands its content out by 1, 3, 5 or 7 chars per refill, without any seek support, like a pipe */
+class chunked_streambuf : public std::streambuf
+{
+	std::string m_data;
+	std::size_t m_position = 0;
+	std::size_t m_refills = 0;
+	char m_chunk[7];
+protected:
+	int_type underflow() override
+	{
+		static constexpr std::size_t sizes[] = { 1, 3, 5, 7 };
+		if (m_position == m_data.size())
+			return traits_type::eof();
+		std::size_t size = std::min(sizes[m_refills++ % 4], m_data.size() - m_position);
+		std::copy_n(m_data.data() + m_position, size, m_chunk);
+		m_position += size;
+		setg(m_chunk, m_chunk, m_chunk + size);
+		return traits_type::to_int_type(m_chunk[0]);
+	}
+public:
+	explicit chunked_streambuf(std::string data)
+	: m_data(std::move(data))
+	{}
+};
+
+/* hands its content out one char at a time, without any get area */
+class unbuffered_streambuf : public std::streambuf
+{
+	std::string m_data;
+	std::size_t m_position = 0;
+protected:
+	int_type underflow() override
+	{
+		return m_position == m_data.size() ? traits_type::eof() : traits_type::to_int_type(m_data[m_position]);
+	}
+	int_type uflow() override
+	{
+		return m_position == m_data.size() ? traits_type::eof() : traits_type::to_int_type(m_data[m_position++]);
+	}
+public:
+	explicit unbuffered_streambuf(std::string data)
+	: m_data(std::move(data))
+	{}
+};
+
+/* records the sax events in a compact form */
+struct sax_recorder : public corecpp::json::sax_handler
+{
+	std::string events;
+	corecpp::json::sax_action on_object_begin() { events += '{'; return corecpp::json::sax_action::proceed; }
+	corecpp::json::sax_action on_key(std::string_view key)
+	{
+		events.append(key).append(":");
+		return key == "skipped" ? corecpp::json::sax_action::skip : corecpp::json::sax_action::proceed;
+	}
+	void on_object_end() { events += '}'; }
+	corecpp::json::sax_action on_array_begin()
+	{
+		events += '[';
+		return events.size() > 16 ? corecpp::json::sax_action::skip : corecpp::json::sax_action::proceed;
+	}
+	void on_array_end() { events += ']'; }
+	void on_string(std::string_view str) { events.append("s(").append(str).append(")"); }
+	void on_integer(std::int64_t value) { events.append("i(").append(std::to_string(value)).append(")"); }
+	void on_unsigned(std::uint64_t value) { events.append("u(").append(std::to_string(value)).append(")"); }
+	void on_double(double value) { events.append("d(").append(std::to_string(value)).append(")"); }
+	void on_bool(bool value) { events.append(value ? "t" : "f"); }
+	corecpp::json::sax_action on_null() { events.append("n"); return corecpp::json::sax_action::stop; }
+};
+
 class test_json_serialization final : public test_fixture
 {
 	template<typename T>
@@ -119,6 +226,17 @@ class test_json_serialization final : public test_fixture
 			corecpp::json::deserializer deserializer { iss };
 			deserializer.deserialize(value);
 			assert_equal(value, t.native);
+
+			typename T::test_type::value_type utf8_value;
+			std::istringstream utf8_iss { t.str };
+			corecpp::json::deserializer utf8_deserializer { utf8_iss, corecpp::json::encoding::utf8 };
+			utf8_deserializer.deserialize(utf8_value);
+			assert_equal(utf8_value, t.native);
+
+			typename T::test_type::value_type buffer_value;
+			corecpp::json::buffer_deserializer buffer_deserializer { t.str };
+			buffer_deserializer.deserialize(buffer_value);
+			assert_equal(buffer_value, t.native);
 		});
 	}
 
@@ -154,19 +272,113 @@ public:
 	test_case_result test_numeric() const
 	{
 		test_cases<type_test<double>> cases {
-			{ 0.0, "0.0" },
+			{ 0.0, "0" },
 			{ 1.0, "1" },
-			{ 10000, "10e3" },
+			{ 10000, "10000" },
 			{ 6.99, "6.99" },
 			{ 7.09e2, "709" },
 			{ 9.07e-1, "0.907" },
 			{ -1.5, "-1.5" },
 			{ 666.87e-2, "6.6687" },
+			{ 0.1, "0.1" },
+			{ 1e22, "1e+22" },
+			{ 5e-324, "5e-324" },
+			{ 1.7976931348623157e308, "1.7976931348623157e+308" },
 		};
 
 		return run_tests(cases);
 	}
 
+	test_case_result test_number_parsing() const
+	{
+		test_cases<type_test<std::int64_t>> int64_cases {
+			{ std::numeric_limits<std::int64_t>::max(), "9223372036854775807" },
+			{ std::numeric_limits<std::int64_t>::lowest(), "-9223372036854775808" },
+		};
+		test_cases<type_test<std::uint64_t>> uint64_cases {
+			{ std::numeric_limits<std::uint64_t>::max(), "18446744073709551615" },
+			{ 9223372036854775808ull, "9223372036854775808" },
+		};
+		test_cases<type_test<double>> double_cases {
+			{ 0.1, "0.1" },
+			{ 2.2250738585072014e-308, "2.2250738585072014e-308" },
+			{ 9007199254740993.0, "9007199254740993" },
+			{ 1.7976931348623157e308, "1.7976931348623157e308" },
+			{ 1e22, "1e22" },
+			{ 18446744073709551616.0, "18446744073709551616" },
+		};
+		struct overflow_test {
+			std::string json;
+		};
+		test_cases<overflow_test> overflow_cases {
+			{ "-1" },
+			{ "4294967296" },
+			{ "18446744073709551615" },
+		};
+		test_cases<std::string> invalid_cases { "012", "-012", "00", "-00.5", "[1,02]" };
+		struct negative_zero_test {
+			std::string json;
+			bool integral;
+		};
+		test_cases<negative_zero_test> negative_zero_cases {
+			{ "-0", true },
+			{ "-0.0", false },
+			{ "-0e3", false },
+		};
+
+		auto parse = [](const std::string& json, auto& value) {
+			corecpp::json::buffer_deserializer { json }.deserialize(value);
+			std::istringstream iss { json };
+			corecpp::json::deserializer { iss }.deserialize(value);
+		};
+		return run(int64_cases, [&](const auto& t){
+				std::int64_t value;
+				parse(t.str, value);
+				assert_equal(value, t.native);
+			})
+			+ run(uint64_cases, [&](const auto& t){
+				std::uint64_t value;
+				parse(t.str, value);
+				assert_equal(value, t.native);
+			})
+			+ run(double_cases, [&](const auto& t){
+				double value;
+				parse(t.str, value);
+				assert_equal(value, t.native);
+			})
+			+ run(overflow_cases, [&](const auto& t){
+				std::uint32_t value;
+				assert_throws<std::overflow_error>([&] { parse(t.json, value); });
+			})
+			+ run(invalid_cases, [&](const std::string& json){
+				std::vector<double> value;
+				assert_throws<corecpp::lexical_error>([&] { parse(json, value); });
+			})
+			+ run(negative_zero_cases, [&](const auto& t){
+				/* the floating point types keep the sign */
+				double value = 1;
+				parse(t.json, value);
+				assert_equal(value, 0.0);
+				assert_equal(std::signbit(value), true);
+				value = 1;
+				assert_equal(corecpp::json::try_deserialize(t.json, value).has_value(), true);
+				assert_equal(std::signbit(value), true);
+				if (!t.integral)
+					return;
+				/* and -0 is a valid integer */
+				int i = 1;
+				parse(t.json, i);
+				assert_equal(i, 0);
+				i = 1;
+				assert_equal(corecpp::json::try_deserialize(t.json, i).has_value(), true);
+				assert_equal(i, 0);
+				std::vector<std::int64_t> values;
+				std::istringstream iss { "[" + t.json + "]" };
+				corecpp::json::deserializer { iss }.deserialize(values);
+				assert_equal(values, std::vector<std::int64_t> { 0 });
+			});
+	}
+
 	test_case_result test_str() const
 	{
 		test_cases<type_test<std::string>> cases {
@@ -177,10 +389,102 @@ public:
 			{ "another string", "\"another string\"" },
 			{ "\"another\" string", "\"\\\"another\\\" string\"" },
 			{ "12345", "\"12345\"" },
+			{ std::string(40, 'a') + "\"" + std::string(20, 'b'), "\"" + std::string(40, 'a') + "\\\"" + std::string(20, 'b') + "\"" },
+			{ "\xc3\xa9t\xc3\xa9 \xf0\x9f\x98\x80", "\"\xc3\xa9t\xc3\xa9 \xf0\x9f\x98\x80\"" },
+			{ "tab\tand\nnew line", "\"tab\\u0009and\\u000Anew line\"" },
 		};
 
 		return run_tests(cases);
 	}
+	test_case_result test_utf8_validation() const
+	{
+		struct validation_test {
+			std::string str;
+			bool valid;
+		};
+		test_cases<validation_test> cases {
+			{ "ascii only", true },
+			{ "\xc3\xa9t\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80 \xf4\x8f\xbf\xbf", true },
+			{ "truncated \xc3", false },
+			{ "overlong \xc0\xaf", false },
+			{ "overlong \xe0\x80\xaf", false },
+			{ "surrogate \xed\xa0\x80", false },
+			{ "too large \xf4\x90\x80\x80", false },
+			{ "stray continuation \x80 after a long enough ascii run", false },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::string json;
+			corecpp::json::basic_serializer<corecpp::string_sink> serializer { corecpp::string_sink { json } };
+			serializer.validate_utf8(true);
+			if (t.valid)
+			{
+				serializer.serialize(t.str);
+				assert_equal(json, "\"" + t.str + "\"");
+			}
+			else
+				assert_throws<std::range_error>([&] { serializer.serialize(t.str); });
+		});
+	}
+	test_case_result test_utf8() const
+	{
+		struct utf8_test {
+			std::string json;
+			complex value;
+			std::string str;
+			bool valid = true;
+		};
+		test_cases<utf8_test> cases {
+			{ "{\"real_part\":1,\"imaginary_part\":2}", { 1, 2 }, "" },
+			{ "{\"real\\u005fpart\":1,\"imaginary_part\":2}", { 1, 2 }, "" },
+			{ "\"\\u00e9t\\u00e9\"", { 0, 0 }, "\xc3\xa9t\xc3\xa9" },
+			{ "\"\xc3\xa9t\xc3\xa9\"", { 0, 0 }, "\xc3\xa9t\xc3\xa9" },
+			{ "\"\\ud83d\\ude00\"", { 0, 0 }, "\xf0\x9f\x98\x80" },
+			{ "\"\\ud83dab\"", { 0, 0 }, "", false },
+			{ "\"\\ud83dabcdefg\"", { 0, 0 }, "", false },
+			{ "\"\\ud83d\"", { 0, 0 }, "", false },
+			{ "\"\\ud83d\\u0041\"", { 0, 0 }, "", false },
+			{ "\"\\ude00\"", { 0, 0 }, "", false },
+		};
+
+		return run(cases, [&](const auto& t){
+			if (!t.valid)
+			{
+				std::string value;
+				assert_throws<corecpp::lexical_error>([&] { corecpp::json::buffer_deserializer { t.json }.deserialize(value); });
+				std::istringstream iss { t.json };
+				assert_throws<corecpp::lexical_error>([&] {
+					corecpp::json::deserializer { iss, corecpp::json::encoding::utf8 }.deserialize(value);
+				});
+				sax_recorder recorder;
+				corecpp::json::push_reader<sax_recorder> push { recorder };
+				assert_throws<corecpp::lexical_error>([&] {
+					for (char c : t.json)
+						push.feed(std::string(1, c));
+					push.finish();
+				});
+			}
+			else if (t.json.front() == '{')
+			{
+				complex value { 0, 0 };
+				utf8_complex utf8_value {};
+				corecpp::json::buffer_deserializer { t.json }.deserialize(value);
+				assert_equal(value, t.value);
+				std::istringstream iss { t.json };
+				corecpp::json::deserializer { iss, corecpp::json::encoding::utf8 }.deserialize(utf8_value);
+				assert_equal(static_cast<const complex&>(utf8_value), t.value);
+			}
+			else
+			{
+				std::string value, utf8_value;
+				corecpp::json::buffer_deserializer { t.json }.deserialize(value);
+				assert_equal(value, t.str);
+				std::istringstream iss { t.json };
+				corecpp::json::deserializer { iss, corecpp::json::encoding::utf8 }.deserialize(utf8_value);
+				assert_equal(utf8_value, t.str);
+			}
+		});
+	}
 	test_case_result test_enum() const
 	{
 
@@ -251,7 +555,7 @@ public:
 		test_cases<type_test<variant_type>> cases {
 			{ { }, "{\"-1\":null}" },
 			{ { 1 }, "{\"0\":1}" },
-			{ { -1.1 }, "{\"1\":-1.100000}" },
+			{ { -1.1 }, "{\"1\":-1.1}" },
 			{ std::string { "test" }, "{\"2\":\"test\"}" },
 			{ std::string { "" }, "{\"2\":\"\"}" },
 		};
@@ -269,27 +573,1346 @@ public:
 
 		using tuple_type = std::tuple<int, double, std::string>;
 		test_cases<type_test<tuple_type>> tuple_cases {
-			{ { 0, 0, "" }, "{\"0\":0,\"1\":0.000000,\"2\":\"\"}" },
-			{ { 1, 1.0, "hello" }, "{\"0\":1,\"1\":1.000000,\"2\":\"hello\"}" },
+			{ { 0, 0, "" }, "{\"0\":0,\"1\":0,\"2\":\"\"}" },
+			{ { 1, 1.0, "hello" }, "{\"0\":1,\"1\":1,\"2\":\"hello\"}" },
 		};
 
 		return run_tests(pair_cases) + run_tests(tuple_cases);
 	}
 
-public:
-	tests_type tests() const override
+	test_case_result test_sinks() const
 	{
-		return {
-			{ "booleans", [&] () { return test_bool(); } },
-			{ "int", [&] () { return test_int(); } },
-			{ "numeric", [&] () { return test_numeric(); } },
-			{ "string", [&] () { return test_str(); } },
-			{ "enumerations", [&] () { return test_enum(); } },
-			{ "structured_types", [&] () { return test_structured_types(); } },
-			{ "complex_types", [&] () { return test_complex_types(); } },
-			{ "array_types", [&] () { return test_array_types(); } },
-			{ "variant", [&] () { return test_variant(); } },
-			{ "tuple", [&] () { return test_tuple(); } },
+		test_cases<type_test<std::vector<int>>> cases {
+			{ { }, "[]" },
+			{ { 1, 2, 3, 999, 999 }, "[1,2,3,999,999]" },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::string str;
+			corecpp::json::basic_serializer<corecpp::string_sink> string_serializer { str };
+			string_serializer.serialize(t.native);
+			assert_equal(str, t.str);
+
+			std::vector<char> vec;
+			corecpp::json::basic_serializer<corecpp::vector_sink> vector_serializer { vec };
+			vector_serializer.serialize(t.native);
+			assert_equal(std::string(vec.begin(), vec.end()), t.str);
+
+			char buffer[32];
+			corecpp::json::basic_serializer<corecpp::buffer_sink> buffer_serializer { { buffer, sizeof(buffer) } };
+			buffer_serializer.serialize(t.native);
+			assert_equal(std::string { buffer_serializer.sink().view() }, t.str);
+			corecpp::json::basic_serializer<corecpp::buffer_sink> small_serializer { { buffer, 2 } };
+			assert_throws<std::length_error>([&] { small_serializer.serialize(std::vector<int> { 1, 2 }); });
+
+			std::unique_ptr<std::FILE, decltype(&std::fclose)> file { std::tmpfile(), &std::fclose };
+			{
+				corecpp::json::basic_serializer<corecpp::fd_sink> fd_serializer { corecpp::fd_sink { fileno(file.get()), 4 } };
+				fd_serializer.serialize(t.native);
+			}
+			std::rewind(file.get());
+			std::string content(t.str.size() + 1, '\0');
+			content.resize(std::fread(content.data(), 1, content.size(), file.get()));
+			assert_equal(content, t.str);
+		});
+	}
+
+	test_case_result test_fd_sink_misuse() const
+	{
+		struct fd_sink_test {
+			std::size_t capacity;
+			std::function<void(corecpp::fd_sink&)> use;
+		};
+		test_cases<fd_sink_test> cases {
+			{ 0, [](corecpp::fd_sink&) {} },
+			{ 4, [](corecpp::fd_sink& sink) { sink.put('a'); } },
+			{ 4, [](corecpp::fd_sink& sink) { sink.write("abc", 3); } },
+			{ 4, [](corecpp::fd_sink& sink) { sink.write("abcdefgh", 8); } },
+			{ 4, [](corecpp::fd_sink& sink) { sink.flush(); } },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::unique_ptr<std::FILE, decltype(&std::fclose)> file { std::tmpfile(), &std::fclose };
+			if (!t.capacity)
+			{
+				assert_throws<std::invalid_argument>([&] { corecpp::fd_sink { fileno(file.get()), t.capacity }; });
+				return;
+			}
+			corecpp::fd_sink sink { fileno(file.get()), t.capacity };
+			corecpp::fd_sink other { std::move(sink) };
+			assert_throws<std::logic_error>([&] { t.use(sink); });
+			t.use(other);
+		});
+	}
+
+	test_case_result test_sax() const
+	{
+		struct sax_test {
+			std::string json;
+			std::string events;
+			bool complete;
+		};
+		test_cases<sax_test> cases {
+			{ "12", "i(12)", true },
+			{ "[]", "[]", true },
+			{ "{ }", "{}", true },
+			{ "[1, -2, 18446744073709551615, 1.5, \"str\", true, false]", "[i(1)i(-2)u(18446744073709551615)d(1.500000)s(str)tf]", true },
+			{ "{\"a\":{\"b\":[]},\"skipped\":{\"c\":[1,{}]},\"d\":\"e\\u00e9\"}", "{a:{b:[]}skipped:d:s(e\xc3\xa9)}", true },
+			{ "{\"skipped\":1}", "{skipped:}", true },
+			{ "[[[[[[[[[[[[[[[[[[1]]]]]]]]]]]]]]]]]]", "[[[[[[[[[[[[[[[[[]]]]]]]]]]]]]]]]", true },
+			{ "[1, null, 2]", "[i(1)n", false },
+			{ "[\"a\\\"\\ud83d\\ude00b\", 123456, -1.5e3, true]", "[s(a\"\xf0\x9f\x98\x80" "b)i(123456)d(-1500.000000)t]", true },
+		};
+
+		return run(cases, [&](const auto& t){
+			sax_recorder recorder;
+			corecpp::json::buffer_reader reader { t.json };
+			assert_equal(reader.parse(recorder), t.complete);
+			assert_equal(recorder.events, t.events);
+
+			sax_recorder stream_recorder;
+			std::istringstream iss { t.json };
+			corecpp::json::reader stream_reader { iss };
+			assert_equal(stream_reader.parse(stream_recorder), t.complete);
+			assert_equal(stream_recorder.events, t.events);
+
+			/* every chunk size, so that chunks end everywhere in the tokens */
+			for (std::size_t size = 1; size <= t.json.size(); ++size)
+			{
+				sax_recorder push_recorder;
+				corecpp::json::push_reader<sax_recorder> push { push_recorder };
+				bool complete = true;
+				for (std::size_t pos = 0; complete && pos < t.json.size(); pos += size)
+					complete = push.feed(std::string { t.json.substr(pos, size) });
+				complete = complete && push.finish();
+				assert_equal(complete, t.complete);
+				assert_equal(push_recorder.events, t.events);
+			}
+			if (!t.complete || (t.json.back() != '}' && t.json.back() != ']'))
+				return;
+			sax_recorder truncated_recorder;
+			corecpp::json::push_reader<sax_recorder> truncated { truncated_recorder };
+			truncated.feed(t.json.substr(0, t.json.size() - 1));
+			assert_equal(truncated.at_boundary(), false);
+			assert_throws<corecpp::syntax_error>([&] { truncated.finish(); });
+		});
+	}
+
+	test_case_result test_sax_skip_errors() const
+	{
+		test_cases<std::string> cases {
+			"{\"skipped\":{]}",
+			"{\"skipped\":[}}",
+			"{\"skipped\":[{\"a\":1]}}",
+			"{\"skipped\":[[1]}",
+		};
+
+		return run(cases, [&](const std::string& json){
+			sax_recorder recorder;
+			corecpp::json::buffer_reader reader { json };
+			assert_throws<corecpp::syntax_error>([&] { reader.parse(recorder); });
+
+			sax_recorder stream_recorder;
+			std::istringstream iss { json };
+			corecpp::json::reader stream_reader { iss };
+			assert_throws<corecpp::syntax_error>([&] { stream_reader.parse(stream_recorder); });
+		});
+	}
+
+	test_case_result test_push_errors() const
+	{
+		struct push_error_test {
+			std::vector<std::string> chunks;
+			bool lexical;
+		};
+		test_cases<push_error_test> cases {
+			{ { "[\"a\\", "x\"]" }, true },
+			{ { "[tr", "x]" }, false },
+			{ { "[\"a", "\x01", "b\"]" }, true },
+			{ { "{\"skipped\":", ":1}" }, false },
+			{ { "{\"skipped\":", "]" }, false },
+		};
+
+		return run(cases, [&](const auto& t){
+			sax_recorder recorder;
+			corecpp::json::push_reader<sax_recorder> push { recorder };
+			auto parse = [&] {
+				for (const auto& chunk : t.chunks)
+					push.feed(chunk);
+				push.finish();
+			};
+			if (t.lexical)
+				assert_throws<corecpp::lexical_error>(parse);
+			else
+				assert_throws<corecpp::syntax_error>(parse);
+		});
+	}
+
+	test_case_result test_document() const
+	{
+		struct document_test {
+			std::string json;
+			std::string dump;
+		};
+		test_cases<document_test> cases {
+			{ "12", "i(12)" },
+			{ "[]", "[]" },
+			{ "{ }", "{}" },
+			{ "[1, -2, 18446744073709551615, 1.5, \"str\", true, false, null]", "[i(1)i(-2)u(18446744073709551615)d(1.500000)s(str)tfn]" },
+			{ "{\"a\":{\"b\":[[], {}]},\"c\":\"e\\u00e9\"}", "{a:{b:[[]{}]}c:s(e\xc3\xa9)}" },
+		};
+
+		return run(cases, [&](const auto& t){
+			using corecpp::json::element;
+			using corecpp::json::tape_type;
+			std::function<void(element, std::string&)> dump = [&dump](element e, std::string& out) {
+				switch (e.type())
+				{
+					case tape_type::null: out += 'n'; break;
+					case tape_type::boolean: out += e.as_bool() ? 't' : 'f'; break;
+					case tape_type::integral: out += "i(" + std::to_string(e.as_integral()) + ")"; break;
+					case tape_type::unsigned_integral: out += "u(" + std::to_string(e.as_unsigned()) + ")"; break;
+					case tape_type::numeric: out += "d(" + std::to_string(e.as_double()) + ")"; break;
+					case tape_type::string: out += "s(" + std::string { e.as_string() } + ")"; break;
+					case tape_type::array:
+						out += '[';
+						e.for_each([&](element item) { dump(item, out); });
+						out += ']';
+						break;
+					case tape_type::object:
+						out += '{';
+						e.for_each([&](std::string_view key, element item) { out.append(key).append(":"); dump(item, out); });
+						out += '}';
+						break;
+				}
+			};
+			corecpp::json::document doc;
+			doc.parse(std::string_view { t.json });
+			std::string result;
+			dump(doc.root(), result);
+			assert_equal(result, t.dump);
+
+			std::istringstream iss { t.json };
+			doc.parse(iss);
+			result.clear();
+			dump(doc.root(), result);
+			assert_equal(result, t.dump);
+		});
+	}
+
+	test_case_result test_document_access() const
+	{
+		test_cases<std::string> cases {
+			"{\"name\":\"doc\",\"values\":[1,[2,3],{\"x\":4},5],\"big\":18446744073709551615}",
+		};
+
+		return run(cases, [&](const auto& json){
+			corecpp::json::document doc;
+			doc.parse(std::string_view { json });
+			auto root = doc.root();
+			assert_equal(root.size(), std::size_t { 3 });
+			assert_equal(root.at("name").as_string(), std::string_view { "doc" });
+			assert_equal(root.find("missing").has_value(), false);
+			assert_throws<std::out_of_range>([&] { root.at("missing"); });
+			auto values = root.at("values");
+			assert_equal(values.size(), std::size_t { 4 });
+			assert_equal(values[1][1].as_integral(), std::int64_t { 3 });
+			assert_equal(values[2].at("x").as_double(), 4.0);
+			assert_equal(values[3].as_unsigned(), std::uint64_t { 5 });
+			assert_throws<std::out_of_range>([&] { values[4]; });
+			assert_throws<std::overflow_error>([&] { root.at("big").as_integral(); });
+			assert_throws<corecpp::syntax_error>([&] { doc.parse(std::string_view { "[1 2]" }); });
+			assert_throws<std::runtime_error>([&] { doc.parse(std::string_view { "{\"a\":[1,2" }); });
+		});
+	}
+
+	test_case_result test_dom() const
+	{
+		struct dom_test {
+			std::string json;
+			std::wstring wide;
+			std::string utf8;
+		};
+		test_cases<dom_test> cases {
+			{ "{\"k\\u00e9\":\"\\u00e9t\\u00e9\"}", L"\u00e9t\u00e9", "\xc3\xa9t\xc3\xa9" },
+			{ "{\"a\":{}, \"k\xc3\xa9\":[\"\xc3\xa9t\xc3\xa9\", [1, 2], {\"b\":null}, []]}", L"\u00e9t\u00e9", "\xc3\xa9t\xc3\xa9" },
+		};
+
+		return run(cases, [&](const auto& t){
+			using namespace corecpp::json;
+			auto parse = [&](auto& tokenizer, encoding enc) -> node {
+				parser p { enc };
+				p.start<value_rule>();
+				p.push(tokenizer);
+				return p.end();
+			};
+			auto value = [](const node& root) -> const value_node& {
+				const auto& member = root.get<object_node>().at(L"k\u00e9");
+				return member.index() == value_node::index_of<array_node>::value ? member.get<array_node>().values.front() : member;
+			};
+			buffer_tokenizer wide_tokenizer { t.json };
+			node wide = parse(wide_tokenizer, encoding::wide);
+			assert_equal(value(wide).template get<string_node>().value, t.wide);
+			buffer_tokenizer utf8_tokenizer { t.json };
+			node utf8 = parse(utf8_tokenizer, encoding::utf8);
+			assert_equal(value(utf8).template get<utf8_string_node>().value, t.utf8);
+			std::stringbuf buffer { t.json };
+			tokenizer stream_tokenizer { buffer };
+			node stream = parse(stream_tokenizer, encoding::utf8);
+			assert_equal(value(stream).template get<utf8_string_node>().value, t.utf8);
+		});
+	}
+
+	test_case_result test_object_index() const
+	{
+		test_cases<std::size_t> cases { 3, 16, 1000 };
+
+		return run(cases, [&](std::size_t size){
+			using namespace corecpp::json;
+			object_node object;
+			for (std::size_t i = 0; i < size; ++i)
+				object.emplace("key" + std::to_string(i), integral_node { static_cast<std::int64_t>(i) });
+			/* replaces the value in place */
+			object.emplace(std::string { "key1" }, integral_node { -1 });
+			/* appended directly, picked up by the next lookup */
+			object.members.push_back(pair_node { string_node { L"last" }, value_node { null_node {} } });
+			assert_equal(object.members.size(), size + 1);
+			assert_equal(object.members[size / 2].name.value, L"key" + std::to_wstring(size / 2));
+			for (std::size_t i = 2; i < size; ++i)
+				assert_equal(object.at("key" + std::to_string(i)).get<integral_node>().value, static_cast<std::int64_t>(i));
+			assert_equal(object.at("key1").get<integral_node>().value, std::int64_t { -1 });
+			assert_equal(object.at("last").index(), static_cast<int>(value_node::index_of<null_node>::value));
+			assert_throws<std::overflow_error>([&] { object.at("missing"); });
+			/* a renamed member is no longer found under its former name, by const lookups too */
+			object.members[2].name.value = L"renamed";
+			const object_node& const_object = object;
+			assert_throws<std::overflow_error>([&] { const_object.at("key2"); });
+			assert_throws<std::overflow_error>([&] { object.at("key2"); });
+			assert_equal(object.at("renamed").get<integral_node>().value, std::int64_t { 2 });
+			assert_equal(const_object.at("renamed").get<integral_node>().value, std::int64_t { 2 });
+		});
+	}
+
+	test_case_result test_on_demand() const
+	{
+		struct on_demand_test {
+			std::string json;
+			std::vector<structured> values;
+		};
+		test_cases<on_demand_test> cases {
+			{ "[]", {} },
+			{ "[{\"i\":1,\"b\":true,\"str\":\"a\"}]", { { 1, true, "a" } } },
+			{ "[ { \"skipped\" : { \"x\" : [ \"}]\\\"\\\\\", {} ] }, \"str\" : \"\\\"quoted\\\"\", \"i\" : -3 } ,"
+				"{\"padding to cross a 64 chars block\":\"[{,:\\\\\",\"b\":false,\"i\":2,\"str\":\"b\\u00e9\"}]",
+				{ { -3, false, "\"quoted\"" }, { 2, false, "b\xc3\xa9" } } },
+		};
+
+		return run(cases, [&](const auto& t){
+			corecpp::json::structural_index index { t.json };
+			std::vector<structured> values;
+			index.root().deserialize(values);
+			assert_equal(values, t.values);
+			assert_equal(index.root().size(), t.values.size());
+			if (!t.values.empty())
+				assert_equal(index.root()[t.values.size() - 1].at("str").as_string(), t.values.back().s);
+		});
+	}
+
+	test_case_result test_cursor() const
+	{
+		test_cases<std::string> cases {
+			"{\"name\":\"doc\",\"values\":[1,[2,3],{\"x\":4},5],\"big\":18446744073709551615,\"n\":null,\"t\":true}",
+		};
+
+		return run(cases, [&](const auto& json){
+			using corecpp::json::tape_type;
+			corecpp::json::structural_index index { json };
+			auto root = index.root();
+			assert_equal(root.size(), std::size_t { 5 });
+			assert_equal(root.at("name").as_string(), std::string { "doc" });
+			assert_equal(root.find("missing").has_value(), false);
+			auto values = root.at("values");
+			assert_equal(values.type() == tape_type::array, true);
+			assert_equal(values[1][1].as_integral(), std::int64_t { 3 });
+			assert_equal(values[2].at("x").as_double(), 4.0);
+			assert_equal(values[3].as_unsigned(), std::uint64_t { 5 });
+			assert_equal(root.at("big").type() == tape_type::unsigned_integral, true);
+			assert_equal(root.at("n").is_null(), true);
+			assert_equal(root.at("t").as_bool(), true);
+			std::string keys;
+			root.for_each([&keys](std::string_view key, const corecpp::json::cursor&) { keys.append(key); });
+			assert_equal(keys, std::string { "namevaluesbignt" });
+			assert_throws<std::out_of_range>([&] { values[4]; });
+			assert_throws<std::overflow_error>([&] { root.at("big").as_integral(); });
+			assert_throws<corecpp::syntax_error>([&] { corecpp::json::structural_index { "[\"unterminated]" }; });
+		});
+	}
+
+	test_case_result test_cursor_containers() const
+	{
+		using corecpp::json::tape_type;
+		struct container_test {
+			std::string json;
+			std::size_t size;
+			tape_type first;
+		};
+		test_cases<container_test> cases {
+			{ "[]", 0, tape_type::null },
+			{ "[ ]", 0, tape_type::null },
+			{ "{ }", 0, tape_type::null },
+			{ "[1]", 1, tape_type::integral },
+			{ "[null]", 1, tape_type::null },
+			{ "[ true ]", 1, tape_type::boolean },
+			{ "{\"a\":1}", 1, tape_type::integral },
+			{ "[[1]]", 1, tape_type::array },
+		};
+
+		return run(cases, [&](const auto& t){
+			corecpp::json::structural_index index { t.json };
+			auto root = index.root();
+			assert_equal(root.size(), t.size);
+			if (!t.size)
+				return;
+			auto first = root.type() == tape_type::array ? root[0] : root.at("a");
+			assert_equal(first.type() == t.first, true);
+			if (t.first == tape_type::array)
+				assert_equal(first.size(), std::size_t { 1 });
+		});
+	}
+
+	test_case_result test_property_table() const
+	{
+		struct table_test {
+			std::string name;
+			std::wstring wname;
+			std::size_t position;
+		};
+		test_cases<table_test> cases {
+			{ "i", L"i", 0 },
+			{ "b", L"b", 1 },
+			{ "str", L"str", 2 },
+			{ "s", L"s", corecpp::details::property_table::npos },
+			{ "", L"", corecpp::details::property_table::npos },
+			{ "str\xc3\xa9", L"str\u00e9", corecpp::details::property_table::npos },
+		};
+
+		return run(cases, [&](const auto& t){
+			const auto& table = corecpp::details::get_property_table<structured>(structured::properties());
+			assert_equal(table.find(t.name), t.position);
+			assert_equal(table.find(std::wstring_view { t.wname }), t.position);
+		}) + run(test_cases<std::wstring> { L"\u00e9t\u00e9", L"\u20ac", L"\U0001F600" }, [&](const auto& name){
+			/* wide keys are hashed and compared as their utf-8 encoding */
+			std::string utf8 = std::wstring_convert<std::codecvt_utf8<wchar_t>, wchar_t>{}.to_bytes(name);
+			corecpp::details::property_table table { std::make_tuple(corecpp::make_property(utf8.c_str(), &structured::i)) };
+			assert_equal(table.find(std::wstring_view { name }), std::size_t { 0 });
+			assert_equal(table.find(std::wstring_view { name }.substr(1)), corecpp::details::property_table::npos);
+		});
+	}
+
+	test_case_result test_parallel_array() const
+	{
+		struct parallel_test {
+			std::size_t size;
+			std::size_t chunk_size;
+			bool pretty;
+		};
+		test_cases<parallel_test> cases {
+			{ 0, 1, false },
+			{ 10, 10, false },
+			{ 1000, 7, false },
+			{ 1000, 64, true },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::vector<std::vector<structured>> values(2);
+			for (std::size_t i = 0; i < t.size; ++i)
+				values.back().push_back({ static_cast<int>(i), i % 2 == 0, "str" + std::to_string(i) });
+			std::string serial, parallel;
+			corecpp::json::basic_serializer<corecpp::string_sink> { corecpp::string_sink { serial }, t.pretty }.serialize(values);
+			corecpp::json::basic_serializer<corecpp::string_sink> serializer { corecpp::string_sink { parallel }, t.pretty };
+			serializer.set_parallelism(4, t.chunk_size);
+			serializer.serialize(values);
+			assert_equal(parallel, serial);
+			/* the workers are kept for the next arrays */
+			parallel.clear();
+			serializer.serialize(values);
+			assert_equal(parallel, serial);
+
+			/* elements with their own serialize method are written by the calling thread */
+			std::vector<complex> complexes(t.size, complex { 1, 2 });
+			serial.clear();
+			parallel.clear();
+			corecpp::json::basic_serializer<corecpp::string_sink> { corecpp::string_sink { serial }, t.pretty }.serialize(complexes);
+			serializer.serialize(complexes);
+			assert_equal(parallel, serial);
+		});
+	}
+
+	test_case_result test_json_lines() const
+	{
+		struct lines_test {
+			std::string lines;
+			std::vector<structured> values;
+			std::size_t errors;
+		};
+		test_cases<lines_test> cases {
+			{ "", {}, 0 },
+			{ "{\"i\":1,\"b\":true,\"str\":\"a\"}\n\n  \r\n{\"i\":2,\"b\":false,\"str\":\"b\"}", { { 1, true, "a" }, { 2, false, "b" } }, 0 },
+			{ "{\"i\":1,\"b\":true,\"str\":\"a\"}\n{\"i\":2,\"b\n{\"i\":3} 4\n{\"i\":4,\"b\":true,\"str\":\"d\"}\n", { { 1, true, "a" }, { 4, true, "d" } }, 2 },
+			/* numbers out of range and invalid escape sequences are malformed records too */
+			{ "{\"i\":1,\"b\":true,\"str\":\"a\"}\n{\"i\":99999999999}\n{\"str\":\"\\q\"}\n{\"i\":4}\n", { { 1, true, "a" }, { 4, false, "" } }, 2 },
+		};
+
+		return run(cases, [&](const auto& t){
+			if (!t.errors)
+			{
+				std::string written;
+				corecpp::json::basic_lines_writer<corecpp::string_sink> writer { corecpp::string_sink { written } };
+				for (const auto& value : t.values)
+					writer.write(value);
+				std::istringstream iss { written };
+				assert_equal(std::count(written.begin(), written.end(), '\n'), static_cast<std::ptrdiff_t>(t.values.size()));
+				corecpp::json::lines_reader<structured> reader { iss };
+				assert_equal(std::vector<structured>(reader.begin(), reader.end()), t.values);
+			}
+
+			std::istringstream iss { t.lines };
+			corecpp::json::lines_reader<structured> reader { iss, corecpp::json::record_errors::skip };
+			assert_equal(std::vector<structured>(reader.begin(), reader.end()), t.values);
+			assert_equal(reader.errors(), t.errors);
+
+			if (t.errors)
+			{
+				std::istringstream raising_iss { t.lines };
+				corecpp::json::lines_reader<structured> raising_reader { raising_iss };
+				structured value;
+				assert_equal(raising_reader.read(value), true);
+				assert_throws<corecpp::syntax_error>([&] { raising_reader.read(value); });
+				assert_equal(raising_reader.line_number(), std::size_t { 2 });
+			}
+		});
+	}
+
+	test_case_result test_parallel_lines() const
+	{
+		struct parallel_lines_test {
+			std::size_t split_size;
+			bool ordered;
+			bool malformed;
+		};
+		test_cases<parallel_lines_test> cases {
+			{ 1, true, false },
+			{ 100, true, false },
+			{ 1000, false, false },
+			{ 100, true, true },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::vector<structured> values;
+			std::string lines;
+			corecpp::json::basic_lines_writer<corecpp::string_sink> writer { corecpp::string_sink { lines } };
+			for (int i = 0; i < 500; ++i)
+			{
+				values.push_back({ i, i % 3 == 0, "record " + std::to_string(i) });
+				writer.write(values.back());
+				if (t.malformed && i % 100 == 50)
+					lines += "{\"i\":\n";
+			}
+
+			corecpp::json::parallel_lines_options options;
+			options.threads = 3;
+			options.split_size = t.split_size;
+			options.ordered = t.ordered;
+			options.errors = corecpp::json::record_errors::skip;
+			std::vector<structured> result;
+			auto errors = corecpp::json::read_lines_parallel<structured>(lines,
+				[&result](std::vector<structured>& batch) { result.insert(result.end(), batch.begin(), batch.end()); }, options);
+			if (!t.ordered)
+				std::sort(result.begin(), result.end(), [](const auto& a, const auto& b) { return a.i < b.i; });
+			assert_equal(result, values);
+			assert_equal(errors, std::size_t { t.malformed ? 5u : 0u });
+
+			options.errors = corecpp::json::record_errors::raise;
+			if (t.malformed)
+				assert_throws<corecpp::syntax_error>([&] {
+					corecpp::json::read_lines_parallel<structured>(lines, [](std::vector<structured>&) {}, options);
+				});
+		});
+	}
+
+	test_case_result test_streamed_array() const
+	{
+		struct streamed_array_test {
+			std::string json;
+			std::vector<structured> values;
+		};
+		test_cases<streamed_array_test> cases {
+			{ "[]", {} },
+			{ " [ {\"i\":1,\"b\":true,\"str\":\"a\"} ] ", { { 1, true, "a" } } },
+			{ "[{\"i\":1,\"b\":true,\"str\":\"a\"},{\"str\":\"b\"},{\"i\":3,\"b\":true}]", { { 1, true, "a" }, { 0, false, "b" }, { 3, true, "" } } },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::istringstream iss { t.json };
+			corecpp::json::deserializer d { iss, corecpp::json::encoding::utf8 };
+			auto elements = corecpp::json::read_elements<structured>(d);
+			assert_equal(std::vector<structured>(elements.begin(), elements.end()), t.values);
+
+			std::vector<structured> values;
+			corecpp::json::buffer_deserializer bd { t.json };
+			auto count = bd.for_each_element<structured>([&values](const structured& value) { values.push_back(value); });
+			assert_equal(values, t.values);
+			assert_equal(count, t.values.size());
+		});
+	}
+
+	test_case_result test_streamed_array_elements() const
+	{
+		struct streamed_elements_test {
+			std::string json;
+			std::vector<std::vector<int>> values;
+			bool valid;
+		};
+		test_cases<streamed_elements_test> cases {
+			{ "[[1,2,3,4],[],[5]]", { { 1, 2, 3, 4 }, {}, { 5 } }, true },
+			{ "[[1],[2,3}", {}, false },
+			{ "[[1],[2]}", {}, false },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::vector<std::vector<int>> values;
+			std::size_t capacity = 0;
+			corecpp::json::buffer_deserializer d { t.json };
+			auto read = [&] {
+				d.for_each_element<std::vector<int>>([&](const std::vector<int>& value) {
+					values.push_back(value);
+					capacity = value.capacity();
+				});
+			};
+			if (!t.valid)
+			{
+				assert_throws<corecpp::syntax_error>(read);
+				return;
+			}
+			read();
+			assert_equal(values, t.values);
+			/* the element is reset in place: the last one keeps the storage of the first one */
+			assert_equal(capacity >= 4, true);
+		});
+	}
+
+	test_case_result test_in_place() const
+	{
+		struct in_place_test {
+			std::string first;
+			std::string second;
+			std::vector<structured> values;
+			bool same_storage;
+		};
+		test_cases<in_place_test> cases {
+			{ "[{\"i\":1,\"b\":true,\"str\":\"a rather long string, not stored inline\"},{\"i\":2}]",
+			  "[{\"i\":3,\"b\":false,\"str\":\"short\"}]", { { 3, false, "short" } }, true },
+			{ "[{\"i\":1}]", "[{\"i\":1},{\"i\":2,\"str\":\"b\"},{\"i\":3}]", { { 1, false, "" }, { 2, false, "b" }, { 3, false, "" } }, false },
+			{ "[{\"i\":1}]", "[]", {}, false },
+			/* the properties missing from the second document are reset */
+			{ "[{\"i\":1,\"b\":true,\"str\":\"a rather long string, not stored inline\"}]", "[{\"i\":2}]", { { 2, false, "" } }, true },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::vector<structured> values;
+			corecpp::json::buffer_deserializer d { t.first };
+			d.deserialize_into(values);
+			const auto* data = values.data();
+			const auto* str = values.front().s.data();
+			d.reset(t.second);
+			d.deserialize_into(values);
+			assert_equal(values, t.values);
+			if (t.same_storage)
+			{
+				assert_equal(values.data() == data, true);
+				assert_equal(values.front().s.data() == str, true);
+			}
+
+			/* the default mode appends */
+			std::vector<int> ints { 1, 2 };
+			d.reset("[3]");
+			d.deserialize(ints);
+			assert_equal(ints, std::vector<int> { 1, 2, 3 });
+			d.reset("[3]");
+			d.deserialize_into(ints);
+			assert_equal(ints, std::vector<int> { 3 });
+
+			std::string wide_value = "a rather long string, not stored inline";
+			str = wide_value.data();
+			std::istringstream iss { "\"\u00e9t\u00e9\"" };
+			corecpp::json::deserializer wd { iss };
+			wd.deserialize_into(wide_value);
+			assert_equal(wide_value, std::string { "\xC3\xA9t\xC3\xA9" });
+			assert_equal(wide_value.data() == str, true);
+		});
+	}
+
+	test_case_result test_checked() const
+	{
+		using corecpp::json::parse_errc;
+		struct checked_test {
+			std::string json;
+			std::optional<parse_errc> error;
+			std::size_t offset;
+			std::vector<structured> values;
+		};
+		test_cases<checked_test> cases {
+			{ "[]", {}, 0, {} },
+			{ "[{\"i\":1,\"b\":true,\"str\":\"a\\\"b\"},{\"unknown\":[{\"x\":[1,{}]},\"y\"],\"i\":2}]", {}, 0, { { 1, true, "a\"b" }, { 2, false, "" } } },
+			{ "[{\"i\":1,\"b\":true", parse_errc::truncated, 16, {} },
+			{ "[{\"i\":1,\"b\":tru}]", parse_errc::unexpected_character, 12, {} },
+			{ "[{\"i\":\"1\"}]", parse_errc::unexpected_token, 9, {} },
+			{ "[{\"i\":1 \"b\":true}]", parse_errc::unexpected_token, 11, {} },
+			{ "[{\"i\":12345678901}]", parse_errc::out_of_range, 17, {} },
+			{ "[{\"str\":\"\\x\"}]", parse_errc::invalid_escape, 9, {} },
+			{ "[{\"unknown\":[1,2}]}]", parse_errc::unexpected_token, 17, {} },
+			{ "[] x", parse_errc::unexpected_character, 3, {} },
+			{ "[] []", parse_errc::unexpected_token, 4, {} },
+			{ "[]\n\t", {}, 0, {} },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::vector<structured> values;
+			auto result = corecpp::json::try_deserialize(t.json, values);
+			assert_equal(result.has_value(), !t.error);
+			if (t.error)
+			{
+				assert_equal(result.error().code, *t.error);
+				assert_equal(result.error().offset, t.offset);
+				assert_equal(result.error().message().empty(), false);
+			}
+			else
+				assert_equal(values, t.values);
+		});
+	}
+
+	test_case_result test_documents() const
+	{
+		struct documents_test {
+			std::string json;
+			std::vector<structured> values;
+			bool truncated;
+		};
+		test_cases<documents_test> cases {
+			{ "", {}, false },
+			{ " \n ", {}, false },
+			{ "{\"i\":1,\"b\":true,\"str\":\"a\"}{\"i\":2}\n\n{\"str\":\"c\"}  \n", { { 1, true, "a" }, { 2, false, "" }, { 0, false, "c" } }, false },
+			{ "{\"i\":1,\"b\":true,\"str\":\"a\"}\n{\"i\":2,", { { 1, true, "a" } }, true },
+			{ "{\"i\":1,\"b\":true,\"str\":\"a\"}\n{\"str\":\"unterminated", { { 1, true, "a" } }, true },
+			{ "{\"i\":-12345,\"b\":false,\"str\":\"\\u00e9\\ud83d\\ude00 escaped \\\"long\\\" string\"} {\"i\":7}", { { -12345, false, "\xc3\xa9\xf0\x9f\x98\x80 escaped \"long\" string" }, { 7, false, "" } }, false },
+		};
+
+		return run(cases, [&](const auto& t){
+			std::istringstream iss { t.json };
+			corecpp::json::deserializer d { iss, corecpp::json::deferred, corecpp::json::encoding::utf8 };
+			corecpp::json::buffer_deserializer bd { t.json, corecpp::json::deferred };
+			chunked_streambuf chunks { t.json };
+			std::istream chunked { &chunks };
+			corecpp::json::deserializer cd { chunked, corecpp::json::deferred };
+			for (const auto& expected : t.values)
+			{
+				structured value {}, buffer_value {}, chunked_value {};
+				assert_equal(d.read_document(value), true);
+				assert_equal(value, expected);
+				assert_equal(bd.read_document(buffer_value), true);
+				assert_equal(buffer_value, expected);
+				assert_equal(cd.read_document(chunked_value), true);
+				assert_equal(chunked_value, expected);
+			}
+			structured value {};
+			if (t.truncated)
+			{
+				assert_throws<corecpp::syntax_error>([&] { d.read_document(value); });
+				assert_throws<corecpp::syntax_error>([&] { bd.read_document(value); });
+				assert_throws<corecpp::syntax_error>([&] { cd.read_document(value); });
+			}
+			else
+			{
+				assert_equal(d.read_document(value), false);
+				assert_equal(bd.read_document(value), false);
+				assert_equal(cd.read_document(value), false);
+			}
+		});
+	}
+
+	test_case_result test_tokenizer() const
+	{
+		using corecpp::json::token_status;
+		struct tokenizer_test {
+			std::string json;
+			std::vector<token_status> statuses;
+		};
+		test_cases<tokenizer_test> cases {
+			{ "", { token_status::end } },
+			{ " [1, true] ", { token_status::ready, token_status::ready, token_status::ready, token_status::ready, token_status::ready, token_status::end } },
+			{ "{\"key\":tr", { token_status::ready, token_status::ready, token_status::ready, token_status::need_more, token_status::need_more } },
+			{ "[\"unterminated", { token_status::ready, token_status::need_more } },
+			{ "[\"escape\\", { token_status::ready, token_status::need_more } },
+			{ " \t\r\n  \t\r\n  \t\r\n  \t\r\n  \t\r\n  \t\r\n  \t\r\n  \t\r\n  \t\r\n  null", { token_status::ready, token_status::end } },
+			{ "[\"a long string without any escape, but unterminated", { token_status::ready, token_status::need_more } },
+		};
+
+		return run(cases, [&](const auto& t){
+			corecpp::json::token tk;
+			std::vector<token_status> statuses;
+			corecpp::json::buffer_tokenizer tokenizer { t.json };
+			for (std::size_t i = 0; i < t.statuses.size(); ++i)
+				statuses.emplace_back(tokenizer.next(tk));
+			assert_equal(statuses, t.statuses);
+
+			statuses.clear();
+			std::stringbuf buffer { t.json };
+			corecpp::json::tokenizer stream_tokenizer { buffer };
+			for (std::size_t i = 0; i < t.statuses.size(); ++i)
+				statuses.emplace_back(stream_tokenizer.next(tk));
+			assert_equal(statuses, t.statuses);
+
+			statuses.clear();
+			unbuffered_streambuf unbuffered { t.json };
+			corecpp::json::tokenizer unbuffered_tokenizer { unbuffered };
+			for (std::size_t i = 0; i < t.statuses.size(); ++i)
+				statuses.emplace_back(unbuffered_tokenizer.next(tk));
+			assert_equal(statuses, t.statuses);
+		});
+	}
+
+public:
+	tests_type tests() const override
+	{
+		return {
+			{ "booleans", [&] () { return test_bool(); } },
+			{ "int", [&] () { return test_int(); } },
+			{ "numeric", [&] () { return test_numeric(); } },
+			{ "number_parsing", [&] () { return test_number_parsing(); } },
+			{ "string", [&] () { return test_str(); } },
+			{ "utf8", [&] () { return test_utf8(); } },
+			{ "utf8_validation", [&] () { return test_utf8_validation(); } },
+			{ "enumerations", [&] () { return test_enum(); } },
+			{ "structured_types", [&] () { return test_structured_types(); } },
+			{ "complex_types", [&] () { return test_complex_types(); } },
+			{ "array_types", [&] () { return test_array_types(); } },
+			{ "variant", [&] () { return test_variant(); } },
+			{ "tuple", [&] () { return test_tuple(); } },
+			{ "fd_sink_misuse", [&] () { return test_fd_sink_misuse(); } },
+			{ "sax", [&] () { return test_sax(); } },
+			{ "sax_skip_errors", [&] () { return test_sax_skip_errors(); } },
+			{ "push_errors", [&] () { return test_push_errors(); } },
+			{ "document", [&] () { return test_document(); } },
+			{ "document_access", [&] () { return test_document_access(); } },
+			{ "dom", [&] () { return test_dom(); } },
+			{ "object_index", [&] () { return test_object_index(); } },
+			{ "on_demand", [&] () { return test_on_demand(); } },
+			{ "cursor", [&] () { return test_cursor(); } },
+			{ "cursor_containers", [&] () { return test_cursor_containers(); } },
+			{ "property_table", [&] () { return test_property_table(); } },
+			{ "sinks", [&] () { return test_sinks(); } },
+			{ "parallel_array", [&] () { return test_parallel_array(); } },
+			{ "json_lines", [&] () { return test_json_lines(); } },
+			{ "parallel_lines", [&] () { return test_parallel_lines(); } },
+			{ "streamed_array", [&] () { return test_streamed_array(); } },
+			{ "streamed_array_elements", [&] () { return test_streamed_array_elements(); } },
+			{ "in_place", [&] () { return test_in_place(); } },
+			{ "checked", [&] () { return test_checked(); } },
+			{ "documents", [&] () { return test_documents(); } },
+			{ "tokenizer", [&] () { return test_tokenizer(); } },
+		};
+	}
+};
+
+class test_msgpack_serialization final : public test_fixture
+{
+	template<typename T>
+	struct type_test {
+		using value_type = T;
+		T native;
+		std::string bytes;
+	};
+
+	template<typename T>
+	test_case_result run_tests(const T& cases) const
+	{
+		return run(cases, [&](const auto& t){
+			typename T::test_type::value_type value;
+
+			std::ostringstream oss;
+			corecpp::msgpack::serializer serializer { oss };
+			serializer.serialize(t.native);
+			assert_equal(oss.str(), t.bytes);
+
+			corecpp::msgpack::deserializer deserializer { t.bytes };
+			deserializer.deserialize(value);
+			assert_equal(value, t.native);
+			assert_equal(deserializer.at_end(), true);
+		});
+	}
+
+public:
+	test_msgpack_serialization()
+	{}
+
+	test_case_result test_int() const
+	{
+		test_cases<type_test<std::int64_t>> cases {
+			{ 0, std::string { "\x00", 1 } },
+			{ 127, "\x7f" },
+			{ 128, "\xcc\x80" },
+			{ 65535, "\xcd\xff\xff" },
+			{ 65536, std::string { "\xce\x00\x01\x00\x00", 5 } },
+			{ -1, "\xff" },
+			{ -32, "\xe0" },
+			{ -33, "\xd0\xdf" },
+			{ -129, "\xd1\xff\x7f" },
+			{ std::numeric_limits<std::int64_t>::lowest(), std::string { "\xd3\x80\x00\x00\x00\x00\x00\x00\x00", 9 } },
+		};
+
+		return run_tests(cases);
+	}
+
+	test_case_result test_str() const
+	{
+		test_cases<type_test<std::string>> cases {
+			{ "", "\xa0" },
+			{ "a", "\xa1" "a" },
+			{ std::string(31, 'x'), "\xbf" + std::string(31, 'x') },
+			{ std::string(32, 'x'), "\xd9\x20" + std::string(32, 'x') },
+			{ std::string(256, 'x'), std::string { "\xda\x01\x00", 3 } + std::string(256, 'x') },
+		};
+
+		return run_tests(cases);
+	}
+
+	test_case_result test_structured_types() const
+	{
+		test_cases<type_test<structured>> cases {
+			{ { 0, false, "" }, std::string { "\x83\xa1i\x00\xa1" "b\xc2\xa3str\xa0", 12 } },
+			{ { -1, true, "a string" }, "\x83\xa1i\xff\xa1" "b\xc3\xa3str\xa8" "a string" },
+		};
+
+		return run_tests(cases);
+	}
+
+	test_case_result test_complex_types() const
+	{
+		test_cases<type_test<complex>> cases {
+			{ { 1, -1 }, "\x82\xa9real_part\x01\xaeimaginary_part\xff" },
+			{ { 999, 0 }, std::string { "\x82\xa9real_part\xcd\x03\xe7\xaeimaginary_part\x00", 30 } },
+		};
+
+		return run_tests(cases);
+	}
+
+	test_case_result test_containers() const
+	{
+		test_cases<type_test<std::vector<int>>> arrays {
+			{ { }, "\x90" },
+			{ { 1, -1, 999 }, "\x93\x01\xff\xcd\x03\xe7" },
+		};
+		test_cases<type_test<std::map<std::string, std::vector<double>>>> maps {
+			{ { }, "\x80" },
+			{ { { "a", { 0.5 } } }, std::string { "\x81\xa1" "a\x91\xcb\x3f\xe0\x00\x00\x00\x00\x00\x00", 13 } },
+		};
+
+		return run_tests(arrays) + run_tests(maps);
+	}
+
+	test_case_result test_errors() const
+	{
+		test_cases<std::string> cases {
+			"",
+			"\xcd\x01",
+			"\xa3" "ab",
+			"\x83\xa1i\x01",
+		};
+
+		return run(cases, [&](const auto& t){
+			structured value;
+			assert_throws<corecpp::syntax_error>([&] { corecpp::msgpack::deserializer { t }.deserialize(value); });
+			std::int8_t small;
+			assert_throws<std::overflow_error>([&] { corecpp::msgpack::deserializer { "\xcc\x80" }.deserialize(small); });
+			/* unknown properties are skipped, whatever their nesting */
+			corecpp::msgpack::deserializer { "\x82\xa1x\x92\x81\xa1y\xc0\xa2zz\xa1i\x05" }.deserialize(value);
+			assert_equal(value.i, 5);
+		});
+	}
+
+	tests_type tests() const override
+	{
+		return {
+			{ "int", [&] () { return test_int(); } },
+			{ "string", [&] () { return test_str(); } },
+			{ "structured_types", [&] () { return test_structured_types(); } },
+			{ "complex_types", [&] () { return test_complex_types(); } },
+			{ "containers", [&] () { return test_containers(); } },
+			{ "errors", [&] () { return test_errors(); } },
+		};
+	}
+};
+
+class test_cbor_serialization final : public test_fixture
+{
+	template<typename T>
+	struct type_test {
+		using value_type = T;
+		T native;
+		std::string bytes;
+	};
+
+	template<typename T>
+	test_case_result run_tests(const T& cases) const
+	{
+		return run(cases, [&](const auto& t){
+			typename T::test_type::value_type value;
+
+			std::ostringstream oss;
+			corecpp::cbor::serializer serializer { oss };
+			serializer.serialize(t.native);
+			assert_equal(oss.str(), t.bytes);
+
+			corecpp::cbor::deserializer deserializer { t.bytes };
+			deserializer.deserialize(value);
+			assert_equal(value, t.native);
+			assert_equal(deserializer.at_end(), true);
+		});
+	}
+
+	/* decoding only, for the encodings written by other implementations */
+	template<typename T>
+	test_case_result run_decoding_tests(const T& cases) const
+	{
+		return run(cases, [&](const auto& t){
+			typename T::test_type::value_type value;
+			corecpp::cbor::deserializer deserializer { t.bytes };
+			deserializer.deserialize(value);
+			assert_equal(value, t.native);
+			assert_equal(deserializer.at_end(), true);
+		});
+	}
+
+public:
+	test_cbor_serialization()
+	{}
+
+	test_case_result test_int() const
+	{
+		test_cases<type_test<std::int64_t>> cases {
+			{ 0, std::string { "\x00", 1 } },
+			{ 23, "\x17" },
+			{ 24, "\x18\x18" },
+			{ 256, std::string { "\x19\x01\x00", 3 } },
+			{ 1000000, std::string { "\x1a\x00\x0f\x42\x40", 5 } },
+			{ -1, "\x20" },
+			{ -25, "\x38\x18" },
+			{ std::numeric_limits<std::int64_t>::lowest(), "\x3b\x7f\xff\xff\xff\xff\xff\xff\xff" },
+		};
+
+		return run_tests(cases);
+	}
+
+	test_case_result test_numeric() const
+	{
+		test_cases<type_test<double>> cases {
+			{ 0.5, std::string { "\xfa\x3f\x00\x00\x00", 5 } },
+			{ 0.1, "\xfb\x3f\xb9\x99\x99\x99\x99\x99\x9a" },
+			{ 1.0e300, std::string { "\xfb\x7e\x37\xe4\x3c\x88\x00\x75\x9c", 9 } },
+		};
+		test_cases<type_test<double>> half_floats {
+			{ 1.0, std::string { "\xf9\x3c\x00", 3 } },
+			{ 65504.0, "\xf9\x7b\xff" },
+			{ -4.0, std::string { "\xf9\xc4\x00", 3 } },
+		};
+
+		return run_tests(cases) + run_decoding_tests(half_floats);
+	}
+
+	test_case_result test_str() const
+	{
+		test_cases<type_test<std::string>> cases {
+			{ "", "\x60" },
+			{ "a", "\x61" "a" },
+			{ std::string(24, 'x'), "\x78\x18" + std::string(24, 'x') },
+		};
+		test_cases<type_test<std::string>> indefinite {
+			{ "streaming", "\x7f\x65strea\x64ming\xff" },
+		};
+		test_cases<type_test<std::vector<std::byte>>> bytes {
+			{ { }, "\x40" },
+			{ { std::byte { 1 }, std::byte { 0xff } }, "\x42\x01\xff" },
+		};
+
+		return run_tests(cases) + run_decoding_tests(indefinite) + run_tests(bytes);
+	}
+
+	test_case_result test_structured_types() const
+	{
+		test_cases<type_test<structured>> cases {
+			{ { 0, false, "" }, std::string { "\xa3\x61i\x00\x61" "b\xf4\x63str\x60", 12 } },
+			{ { -1, true, "a string" }, "\xa3\x61i\x20\x61" "b\xf5\x63str\x68" "a string" },
+		};
+		/* custom serialize methods and optional values are written with an indefinite length */
+		test_cases<type_test<complex>> complexes {
+			{ { 1, -1 }, "\xbf\x69real_part\x01\x6eimaginary_part\x20\xff" },
+		};
+		test_cases<type_test<std::optional<int>>> optionals {
+			{ std::nullopt, "\xbf\xff" },
+			{ 5, "\xbf\x65value\x05\xff" },
+		};
+
+		return run_tests(cases) + run_tests(complexes) + run_tests(optionals);
+	}
+
+	test_case_result test_containers() const
+	{
+		test_cases<type_test<std::vector<int>>> arrays {
+			{ { }, "\x80" },
+			{ { 1, -1, 1000 }, "\x83\x01\x20\x19\x03\xe8" },
+		};
+		test_cases<type_test<std::vector<int>>> indefinite {
+			{ { 1, 2, 3 }, "\x9f\x01\x02\x03\xff" },
+		};
+		test_cases<type_test<std::map<std::string, std::vector<double>>>> maps {
+			{ { }, "\xa0" },
+			{ { { "a", { 0.5 } } }, std::string { "\xa1\x61" "a\x81\xfa\x3f\x00\x00\x00", 9 } },
+		};
+
+		return run_tests(arrays) + run_decoding_tests(indefinite) + run_tests(maps);
+	}
+
+	test_case_result test_time_point() const
+	{
+		using seconds_point = std::chrono::time_point<std::chrono::system_clock, std::chrono::seconds>;
+		test_cases<type_test<seconds_point>> seconds {
+			{ seconds_point { std::chrono::seconds { 1363896240 } }, "\xc1\x1a\x51\x4b\x67\xb0" },
+			/* more than 292 years away from the epoch: out of the range of int64_t nanoseconds */
+			{ seconds_point { std::chrono::seconds { 32503680000 } }, std::string { "\xc1\x1b\x00\x00\x00\x07\x91\x5e\xcc\x00", 10 } },
+			{ seconds_point { std::chrono::seconds { -32503680000 } }, std::string { "\xc1\x3b\x00\x00\x00\x07\x91\x5e\xcb\xff", 10 } },
+		};
+		test_cases<type_test<std::chrono::system_clock::time_point>> nanoseconds {
+			{ std::chrono::system_clock::time_point { std::chrono::seconds { 1363896240 } + std::chrono::nanoseconds { 5 } },
+				"\xd9\x03\xe9\xa2\x01\x1a\x51\x4b\x67\xb0\x28\x05" },
+		};
+		test_cases<type_test<std::chrono::system_clock::time_point>> floats {
+			{ std::chrono::system_clock::time_point { std::chrono::milliseconds { 1363896240500 } },
+				std::string { "\xc1\xfb\x41\xd4\x52\xd9\xec\x20\x00\x00", 10 } },
+		};
+
+		/* times which do not fit in nanoseconds */
+		test_cases<std::string> overflows {
+			std::string { "\xd9\x03\xe9\xa2\x01\x00\x22\x1b\x7f\xff\xff\xff\xff\xff\xff\xff", 16 },
+			std::string { "\xd9\x03\xe9\xa2\x01\x00\x25\x3b\x00\x20\xc4\x9b\xa5\xe3\x53\xf8", 16 },
+			/* seconds which do not fit in nanoseconds */
+			std::string { "\xc1\x1b\x00\x00\x00\x07\x91\x5e\xcc\x00", 10 },
+			/* floating point seconds out of the range of int64_t */
+			std::string { "\xc1\xfb\x43\xe1\x58\xe4\x60\x91\x3d\x00", 10 },
+		};
+
+		return run_tests(seconds) + run_tests(nanoseconds) + run_decoding_tests(floats)
+			+ run(overflows, [&](const std::string& bytes){
+				std::chrono::system_clock::time_point value;
+				assert_throws<std::overflow_error>([&] { corecpp::cbor::deserializer { bytes }.deserialize(value); });
+			});
+	}
+
+	test_case_result test_errors() const
+	{
+		test_cases<std::string> cases {
+			"",
+			"\x19\x01",
+			"\x63" "ab",
+			"\xa3\x61i\x01",
+			"\xbf\x61i\x01",
+		};
+
+		return run(cases, [&](const auto& t){
+			structured value;
+			assert_throws<corecpp::syntax_error>([&] { corecpp::cbor::deserializer { t }.deserialize(value); });
+			std::uint8_t small;
+			assert_throws<std::overflow_error>([&] { corecpp::cbor::deserializer { "\x20" }.deserialize(small); });
+			/* unknown properties are skipped, whatever their nesting, and the unknown tags are ignored */
+			corecpp::cbor::deserializer { "\xa2\x61x\x9f\xa1\x61y\xf6\x7f\x61z\xff\xff\x61i\xc6\x05" }.deserialize(value);
+			assert_equal(value.i, 5);
+		});
+	}
+
+	tests_type tests() const override
+	{
+		return {
+			{ "int", [&] () { return test_int(); } },
+			{ "numeric", [&] () { return test_numeric(); } },
+			{ "string", [&] () { return test_str(); } },
+			{ "structured_types", [&] () { return test_structured_types(); } },
+			{ "containers", [&] () { return test_containers(); } },
+			{ "time_point", [&] () { return test_time_point(); } },
+			{ "errors", [&] () { return test_errors(); } },
+		};
+	}
+};
+
+class test_compact_serialization final : public test_fixture
+{
+	template<typename T>
+	struct type_test {
+		using value_type = T;
+		T native;
+		std::string bytes;
+	};
+
+	template<typename T>
+	test_case_result run_tests(const T& cases) const
+	{
+		return run(cases, [&](const auto& t){
+			using value_type = typename T::test_type::value_type;
+			value_type value, message_value;
+
+			std::ostringstream oss;
+			corecpp::compact::serializer serializer { oss };
+			serializer.serialize(t.native);
+			assert_equal(oss.str(), t.bytes);
+
+			corecpp::compact::deserializer deserializer { t.bytes };
+			deserializer.deserialize(value);
+			assert_equal(value, t.native);
+			assert_equal(deserializer.at_end(), true);
+
+			std::string message;
+			corecpp::compact::basic_serializer<corecpp::string_sink> message_serializer { corecpp::string_sink { message } };
+			message_serializer.serialize_message(t.native);
+			assert_equal(message.size(), t.bytes.size() + sizeof(std::uint64_t));
+			corecpp::compact::deserializer message_deserializer { message };
+			message_deserializer.deserialize_message(message_value);
+			assert_equal(message_value, t.native);
+		});
+	}
+
+public:
+	test_compact_serialization()
+	{}
+
+	test_case_result test_int() const
+	{
+		test_cases<type_test<std::int64_t>> cases {
+			{ 0, std::string { "\x00", 1 } },
+			{ -1, "\x01" },
+			{ 1, "\x02" },
+			{ -64, "\x7f" },
+			{ 64, "\x80\x01" },
+			{ 300, "\xd8\x04" },
+			{ std::numeric_limits<std::int64_t>::lowest(), "\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01" },
+		};
+		test_cases<type_test<std::uint64_t>> unsigned_cases {
+			{ 127, "\x7f" },
+			{ 128, "\x80\x01" },
+			{ std::numeric_limits<std::uint64_t>::max(), "\xff\xff\xff\xff\xff\xff\xff\xff\xff\x01" },
+		};
+
+		return run_tests(cases) + run_tests(unsigned_cases);
+	}
+
+	test_case_result test_str() const
+	{
+		test_cases<type_test<std::string>> cases {
+			{ "", std::string { "\x00", 1 } },
+			{ "abc", "\x03" "abc" },
+			{ std::string(128, 'x'), "\x80\x01" + std::string(128, 'x') },
+		};
+
+		return run_tests(cases);
+	}
+
+	test_case_result test_structured_types() const
+	{
+		/* the properties are written in the order of properties(), without their names */
+		test_cases<type_test<structured>> cases {
+			{ { 1, true, "ab" }, "\x02\x01\x02" "ab" },
+			{ { -1, false, "" }, std::string { "\x01\x00\x00", 3 } },
+		};
+		test_cases<type_test<complex>> complexes {
+			{ { 1, -1 }, std::string { "\x09real_part\x02\x0eimaginary_part\x01\x00", 28 } },
+		};
+		test_cases<type_test<std::optional<int>>> optionals {
+			{ std::nullopt, std::string { "\x00", 1 } },
+			{ 5, "\x01\x0a" },
+		};
+
+		return run_tests(cases) + run_tests(complexes) + run_tests(optionals);
+	}
+
+	test_case_result test_containers() const
+	{
+		test_cases<type_test<std::vector<int>>> arrays {
+			{ { }, std::string { "\x00", 1 } },
+			{ { 1, -1, 1000 }, "\x03\x02\x01\xd0\x0f" },
+		};
+		test_cases<type_test<std::map<std::string, std::vector<double>>>> maps {
+			{ { }, std::string { "\x00", 1 } },
+			{ { { "a", { 0.5 } } }, std::string { "\x01\x01" "a\x01\x00\x00\x00\x00\x00\x00\xe0\x3f", 12 } },
+		};
+
+		return run_tests(arrays) + run_tests(maps);
+	}
+
+	test_case_result test_fingerprint() const
+	{
+		using corecpp::compact::fingerprint;
+		struct fingerprint_test {
+			std::uint64_t first;
+			std::uint64_t second;
+			bool same;
+		};
+		test_cases<fingerprint_test> cases {
+			{ fingerprint<structured>(), fingerprint<complex>(), false },
+			{ fingerprint<std::vector<int>>(), fingerprint<std::vector<unsigned int>>(), false },
+			{ fingerprint<structured>(), fingerprint<const structured>(), true },
+			{ fingerprint<tree>(), fingerprint<std::vector<tree>>(), false },
+		};
+
+		return run(cases, [&](const auto& t){
+			if (t.same)
+				assert_equal(t.first, t.second);
+			else
+				assert_not_equal(t.first, t.second);
+		});
+	}
+
+	test_case_result test_errors() const
+	{
+		test_cases<std::string> cases {
+			"",
+			"\x02\x01",
+			"\x02\x01\x05" "ab",
+			"\x02\x02\x00",
+		};
+		std::string message;
+		corecpp::compact::basic_serializer<corecpp::string_sink> serializer { corecpp::string_sink { message } };
+		serializer.serialize_message(structured { 1, true, "ab" });
+
+		return run(cases, [&](const auto& t){
+			structured value;
+			assert_throws<corecpp::syntax_error>([&] { corecpp::compact::deserializer { t }.deserialize(value); });
+		})
+			+ run(test_cases<std::string> { message }, [&](const auto& t){
+				complex other;
+				assert_throws<corecpp::semantic_error>([&] { corecpp::compact::deserializer { t }.deserialize_message(other); });
+			})
+			+ run(test_cases<std::string> { "\x80\x02" }, [&](const auto& t){
+				std::int8_t small;
+				assert_throws<std::overflow_error>([&] { corecpp::compact::deserializer { t }.deserialize(small); });
+			});
+	}
+
+	tests_type tests() const override
+	{
+		return {
+			{ "int", [&] () { return test_int(); } },
+			{ "string", [&] () { return test_str(); } },
+			{ "structured_types", [&] () { return test_structured_types(); } },
+			{ "containers", [&] () { return test_containers(); } },
+			{ "fingerprint", [&] () { return test_fingerprint(); } },
+			{ "errors", [&] () { return test_errors(); } },
 		};
 	}
 };
@@ -299,6 +1922,9 @@ int main(int argc, char** argv)
 	test_unit unit { "Serialisation" };
 	/* corecpp::diagnostic::manager::default_channel().set_level(corecpp::diagnostic::diagnostic_level::debug); */
 	unit.add_fixture<test_json_serialization>("JSON");
+	unit.add_fixture<test_msgpack_serialization>("MessagePack");
+	unit.add_fixture<test_cbor_serialization>("CBOR");
+	unit.add_fixture<test_compact_serialization>("Compact");
 
 	return unit.run(argc, argv);
 };